@@ -25,6 +25,19 @@ PYBIND11_MODULE(slideiopybind, m) {
     m.def("set_log_level", &pySetLogLevel,
         py::arg("log_level"),
         "Sets log level for the library.");
+    m.def("set_tile_cache_size", &pySetTileCacheSize,
+        py::arg("max_bytes"),
+        "Sets memory budget (bytes) of the process-wide cache of decoded tiles. 0 disables the cache.");
+    m.def("clear_tile_cache", &pyClearTileCache,
+        "Removes all tiles from the decoded tile cache.");
+    m.def("get_tile_cache_stats", &pyGetTileCacheStats,
+        "Returns size, budget, tile count and hit/miss counters of the decoded tile cache.");
+    m.def("set_ndpi_index_enabled", &pySetNDPIIndexEnabled,
+        py::arg("enable"),
+        "Enables index files of NDPI slides: directories scanned at opening of a slide are reused when it is opened again.");
+    m.def("set_ndpi_index_directory", &pySetNDPIIndexDirectory,
+        py::arg("directory"),
+        "Sets directory for NDPI index files. Empty string puts index files next to the slides.");
     m.def("get_driver_ids", &pyGetDriverIDs,
         "Returns list of driver ids");
     m.def("compare_images", &pyCompareImages,
@@ -90,7 +103,103 @@ PYBIND11_MODULE(slideiopybind, m) {
                 numpy array with pixel values
             )del"
         )
+        .def("read_blocks", &PyScene::readBlocks,
+            py::arg("rects"),
+            py::arg("size") = std::tuple<int, int>(0, 0),
+            py::arg("channel_indices") = std::vector<int>(),
+            R"del(
+            Reads a batch of rectangular blocks of the scene resized to the same size.
+
+            Args:
+                rects: list of block rectangles, defined as tuples (x, y, width, height).
+                size: size of every block after rescaling. (0,0) - size of the first block.
+                channel_indices: array of channel indices to be retrieved. [] - all channels.
+
+            Returns:
+                numpy array of shape (number of blocks, height, width, channels). Tiles shared by several blocks are decoded once.
+            )del"
+        )
+        .def("read_level_block", &PyScene::readLevelBlock,
+            py::arg("zoom_level"),
+            py::arg("rect"),
+            py::arg("channel_indices") = std::vector<int>(),
+            py::arg("slice") = 0,
+            py::arg("frame") = 0,
+            R"del(
+            Reads rectangular block of a zoom level in native resolution of the level (without rescaling).
+
+            Args:
+                zoom_level: index of the zoom level.
+                rect: block rectangle in the level coordinates, defined as a tuple (x, y, width, height).
+                channel_indices: array of channel indices to be retrieved. [] - all channels.
+                slice: index of z slice.
+                frame: index of time frame.
+
+            Returns:
+                numpy array with pixel values
+            )del"
+        )
+        .def("read_tile", &PyScene::readTile,
+            py::arg("zoom_level"),
+            py::arg("tile_x"),
+            py::arg("tile_y"),
+            py::arg("channel_indices") = std::vector<int>(),
+            py::arg("slice") = 0,
+            py::arg("frame") = 0,
+            R"del(
+            Reads a tile of a zoom level in native resolution of the level (without rescaling).
+
+            Args:
+                zoom_level: index of the zoom level.
+                tile_x, tile_y: column and row of the tile in the level tile grid (see tile_size of the zoom level info).
+                channel_indices: array of channel indices to be retrieved. [] - all channels.
+                slice: index of z slice.
+                frame: index of time frame.
+
+            Returns:
+                numpy array with pixel values
+            )del"
+        )
+        .def("read_level_blocks", &PyScene::readLevelBlocks,
+            py::arg("zoom_level"),
+            py::arg("block_size") = std::tuple<int, int>(0, 0),
+            py::arg("channel_indices") = std::vector<int>(),
+            py::arg("depth") = 4,
+            py::arg("threads") = 2,
+            R"del(
+            Iterates over blocks of a zoom level in row-major order. Blocks are read ahead in background threads.
+
+            Args:
+                zoom_level: index of the zoom level.
+                block_size: size of the blocks as a tuple (width, height). (0,0) - tile size of the level (the whole level for not tiled levels).
+                channel_indices: array of channel indices to be retrieved. [] - all channels.
+                depth: maximum number of blocks read ahead.
+                threads: number of reading threads.
+
+            Returns:
+                iterator of tuples (rect, data), where rect - block rectangle (x, y, width, height) in the level coordinates, data - numpy array with pixel values.
+            )del"
+        )
+        .def("read_raw_tile", &PyScene::readRawTile,
+            py::arg("zoom_level"),
+            py::arg("tile_index"),
+            R"del(
+            Reads encoded data of a tile of a zoom level without decoding.
+
+            Args:
+                zoom_level: index of the zoom level.
+                tile_index: index of the tile in the row-major grid of the level tiles.
+
+            Returns:
+                tuple (data, compression), where data - bytes of the encoded tile, compression - compression of the data.
+                JPEG tiles are returned as standalone JPEG streams.
+            )del"
+        )
         .def("__repr__", &PyScene::toString);
+    py::class_<PyLevelBlockIterator, std::shared_ptr<PyLevelBlockIterator>>(m, "LevelBlockIterator")
+        .def("__iter__", [](std::shared_ptr<PyLevelBlockIterator> self) { return self; })
+        .def("__next__", &PyLevelBlockIterator::next)
+        .def("__len__", &PyLevelBlockIterator::getBlockCount);
     py::enum_<slideio::Compression>(m, "Compression")
         .value("Unknown", slideio::Compression::Unknown)
         .value("Uncompressed", slideio::Compression::Uncompressed)
@@ -9,6 +9,7 @@
 #include <opencv2/core/mat.hpp>
 
 #include "slideio/imagetools/cvtools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 
 namespace py = pybind11;
 
@@ -92,4 +93,36 @@ double pyCompareImages(py::array& left, py::array& right)
 void pySetLogLevel(const std::string& level)
 {
     slideio::ImageDriverManager::setLogLevel(level);
-}
\ No newline at end of file
+}
+
+void pySetTileCacheSize(size_t maxBytes)
+{
+    slideio::TileCache::instance().setMaxSize(maxBytes);
+}
+
+void pyClearTileCache()
+{
+    slideio::TileCache::instance().clear();
+}
+
+void pySetNDPIIndexEnabled(bool enable)
+{
+    slideio::setNDPIIndexEnabled(enable);
+}
+
+void pySetNDPIIndexDirectory(const std::string& directory)
+{
+    slideio::setNDPIIndexDirectory(directory);
+}
+
+std::map<std::string, uint64_t> pyGetTileCacheStats()
+{
+    const slideio::TileCache& cache = slideio::TileCache::instance();
+    return {
+        {"max_size", cache.getMaxSize()},
+        {"size", cache.getSize()},
+        {"tiles", cache.getTileCount()},
+        {"hits", cache.getHits()},
+        {"misses", cache.getMisses()}
+    };
+}
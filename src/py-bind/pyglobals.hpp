@@ -3,8 +3,14 @@
 // of this distribution and at http://slideio.com/license.html.
 #pragma once
 #include "pyslide.hpp"
+#include <map>
 
 std::shared_ptr<PySlide> pyOpenSlide(const std::string& path, const std::string& driver);
 std::vector<std::string> pyGetDriverIDs();
 double pyCompareImages(pybind11::array& left, pybind11::array& right);
 void pySetLogLevel(const std::string& level);
+void pySetTileCacheSize(size_t maxBytes);
+void pyClearTileCache();
+std::map<std::string, uint64_t> pyGetTileCacheStats();
+void pySetNDPIIndexEnabled(bool enable);
+void pySetNDPIIndexDirectory(const std::string& directory);
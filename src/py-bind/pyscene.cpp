@@ -6,6 +6,8 @@
 #include <boost/format.hpp>
 #include "pyslide.hpp"
 #include "slideio/base/exceptions.hpp"
+#include "slideio/core/tools/blockprefetcher.hpp"
+#include <opencv2/core/mat.hpp>
 
 namespace py = pybind11;
 
@@ -162,6 +164,40 @@ pybind11::array PyScene::readBlock(std::tuple<int, int, int, int> rect,
     return numpy_array;
 }
 
+pybind11::array PyScene::readBlocks(std::vector<std::tuple<int, int, int, int>> rects,
+    std::tuple<int, int> size, std::vector<int> channelIndices) const
+{
+    if(rects.empty())
+    {
+        throw std::runtime_error("Empty list of block rectangles");
+    }
+    const int refChannel = channelIndices.empty()?0:channelIndices[0];
+    const int numChannels = channelIndices.empty()?getNumChannels():static_cast<int>(channelIndices.size());
+    const py::dtype dtype = getChannelDataType(refChannel);
+
+    std::vector<std::tuple<int, int, int, int>> blockRects;
+    blockRects.reserve(rects.size());
+    for(const auto& rect : rects)
+    {
+        blockRects.push_back(adjustSourceRect(rect));
+    }
+    // all blocks are resized to the same size: the first block defines it if the size is not set
+    const PySize blockSize = adjustTargetSize(blockRects.front(), size);
+    const size_t memSize = static_cast<size_t>(m_scene->getBlockSize(blockSize, refChannel, numChannels, 1, 1))
+        * blockRects.size();
+
+    py::array::ShapeContainer shape;
+    shape->push_back(static_cast<py::ssize_t>(blockRects.size()));
+    shape->push_back(blockSize.height());
+    shape->push_back(blockSize.width());
+    if(numChannels>1)
+        shape->push_back(numChannels);
+
+    py::array numpy_array(dtype, shape);
+    m_scene->readBlocks(blockRects, blockSize, channelIndices, numpy_array.mutable_data(), memSize);
+    return numpy_array;
+}
+
 PyRect PyScene::adjustSourceRect(const PyRect& rect) const
 {
     PyRect srcRect(rect);
@@ -244,6 +280,104 @@ const slideio::LevelInfo& PyScene::getZoomLevelInfo(int zoomLevel) const {
     return *info;
 }
 
+py::tuple PyScene::readRawTile(int zoomLevel, int tileIndex)
+{
+    std::vector<uint8_t> data;
+    const slideio::Compression compression = m_scene->readRawTile(zoomLevel, tileIndex, data);
+    py::bytes bytes(reinterpret_cast<const char*>(data.data()), data.size());
+    return py::make_tuple(bytes, compression);
+}
+
+pybind11::array PyScene::readLevelBlock(int zoomLevel, std::tuple<int, int, int, int> rect,
+    std::vector<int> channelIndices, int slice, int frame) const
+{
+    const PyRect blockRect(rect);
+    const int refChannel = channelIndices.empty()?0:channelIndices[0];
+    const int numChannels = channelIndices.empty()?getNumChannels():static_cast<int>(channelIndices.size());
+    const py::dtype dtype = getChannelDataType(refChannel);
+    const PySize blockSize(std::make_tuple(blockRect.width(), blockRect.height()));
+    const int memSize = m_scene->getBlockSize(blockSize, refChannel, numChannels, 1, 1);
+
+    py::array::ShapeContainer shape;
+    shape->push_back(blockRect.height());
+    shape->push_back(blockRect.width());
+    if(numChannels>1)
+        shape->push_back(numChannels);
+
+    py::array numpy_array(dtype, shape);
+    m_scene->readLevelBlockChannels(zoomLevel, blockRect, channelIndices, slice, frame,
+        numpy_array.mutable_data(), memSize);
+    return numpy_array;
+}
+
+pybind11::array PyScene::readTile(int zoomLevel, int tileX, int tileY,
+    std::vector<int> channelIndices, int slice, int frame) const
+{
+    const std::tuple<int, int, int, int> tileRect = m_scene->getLevelTileRect(zoomLevel, tileX, tileY);
+    return readLevelBlock(zoomLevel, tileRect, channelIndices, slice, frame);
+}
+
+std::shared_ptr<PyLevelBlockIterator> PyScene::readLevelBlocks(int zoomLevel, std::tuple<int, int> blockSize,
+    std::vector<int> channelIndices, int depth, int threads) const
+{
+    const int refChannel = channelIndices.empty() ? 0 : channelIndices[0];
+    const py::dtype dtype = getChannelDataType(refChannel);
+    return std::make_shared<PyLevelBlockIterator>(m_scene, m_slide, zoomLevel, blockSize,
+        std::move(channelIndices), dtype, depth, threads);
+}
+
+PyLevelBlockIterator::PyLevelBlockIterator(std::shared_ptr<slideio::Scene> scene, std::shared_ptr<slideio::Slide> slide,
+    int zoomLevel, std::tuple<int, int> blockSize, std::vector<int> channelIndices, py::dtype dtype,
+    int depth, int threads) :
+    m_scene(std::move(scene)), m_slide(std::move(slide)), m_dtype(std::move(dtype))
+{
+    std::shared_ptr<slideio::CVScene> cvScene = m_scene->getCVScene();
+    const cv::Size size(std::get<0>(blockSize), std::get<1>(blockSize));
+    std::vector<slideio::BlockRequest> blocks = slideio::BlockPrefetcher::makeLevelScanOrder(*cvScene,
+        zoomLevel, size, channelIndices);
+    m_prefetcher.reset(new slideio::BlockPrefetcher(cvScene, std::move(blocks), depth, threads));
+}
+
+PyLevelBlockIterator::~PyLevelBlockIterator()
+{
+    // the workers read the scene without the interpreter lock
+    py::gil_scoped_release release;
+    m_prefetcher.reset();
+}
+
+size_t PyLevelBlockIterator::getBlockCount() const
+{
+    return m_prefetcher->getBlockCount();
+}
+
+py::tuple PyLevelBlockIterator::next()
+{
+    slideio::BlockRequest block;
+    cv::Mat raster;
+    bool found = false;
+    {
+        py::gil_scoped_release release;
+        found = m_prefetcher->next(block, raster);
+    }
+    if (!found) {
+        throw py::stop_iteration();
+    }
+    const int numChannels = raster.channels();
+    if (static_cast<size_t>(m_dtype.itemsize()) * numChannels != raster.elemSize()) {
+        RAISE_RUNTIME_ERROR << "Unexpected data type of a level block: " << raster.type();
+    }
+    py::array::ShapeContainer shape;
+    shape->push_back(raster.rows);
+    shape->push_back(raster.cols);
+    if (numChannels > 1)
+        shape->push_back(numChannels);
+    py::array numpy_array(m_dtype, shape);
+    cv::Mat target(raster.rows, raster.cols, raster.type(), numpy_array.mutable_data());
+    raster.copyTo(target);
+    const cv::Rect& rect = block.rect;
+    return py::make_tuple(std::make_tuple(rect.x, rect.y, rect.width, rect.height), numpy_array);
+}
+
 std::shared_ptr<slideio::Scene> extractScene(std::shared_ptr<PyScene> pyScene)
 {
     return pyScene->m_scene;
@@ -10,8 +10,11 @@
 namespace slideio
 {
     class Slide;
+    class BlockPrefetcher;
 }
 
+class PyLevelBlockIterator;
+
 class PyScene
 {
     friend std::shared_ptr<slideio::Scene> extractScene(std::shared_ptr<PyScene> pyScene);
@@ -35,6 +38,8 @@ public:
     pybind11::array readBlock(std::tuple<int,int,int,int> rect,
         std::tuple<int,int> size, std::vector<int> channelIndices,
         std::tuple<int,int> sliceRange, std::tuple<int,int> tframeRange) const;
+    pybind11::array readBlocks(std::vector<std::tuple<int,int,int,int>> rects,
+        std::tuple<int,int> size, std::vector<int> channelIndices) const;
     std::list<std::string> getAuxImageNames() const;
     int getNumAuxImages() const;
     std::shared_ptr<PyScene> getAuxImage(const std::string& imageName);
@@ -42,6 +47,13 @@ public:
     std::string toString() const;
     int getNumZoomLevels() const;
     const slideio::LevelInfo& getZoomLevelInfo(int zoomLevel) const;
+    pybind11::tuple readRawTile(int zoomLevel, int tileIndex);
+    pybind11::array readLevelBlock(int zoomLevel, std::tuple<int,int,int,int> rect,
+        std::vector<int> channelIndices, int slice, int frame) const;
+    pybind11::array readTile(int zoomLevel, int tileX, int tileY,
+        std::vector<int> channelIndices, int slice, int frame) const;
+    std::shared_ptr<PyLevelBlockIterator> readLevelBlocks(int zoomLevel, std::tuple<int,int> blockSize,
+        std::vector<int> channelIndices, int depth, int threads) const;
 private:
     PyRect adjustSourceRect(const PyRect& rect) const;
     PySize adjustTargetSize(const PyRect& rect, const PySize& size) const;
@@ -51,4 +63,21 @@ private:
     std::shared_ptr<slideio::Slide> m_slide;
 };
 
+// iterates over blocks of a zoom level in row-major order reading them ahead in background threads
+class PyLevelBlockIterator
+{
+public:
+    PyLevelBlockIterator(std::shared_ptr<slideio::Scene> scene, std::shared_ptr<slideio::Slide> slide,
+        int zoomLevel, std::tuple<int,int> blockSize, std::vector<int> channelIndices, pybind11::dtype dtype,
+        int depth, int threads);
+    ~PyLevelBlockIterator();
+    size_t getBlockCount() const;
+    pybind11::tuple next();
+private:
+    std::shared_ptr<slideio::Scene> m_scene;
+    std::shared_ptr<slideio::Slide> m_slide;
+    std::unique_ptr<slideio::BlockPrefetcher> m_prefetcher;
+    pybind11::dtype m_dtype;
+};
+
 std::shared_ptr<slideio::Scene> extractScene(std::shared_ptr<PyScene> pyScene);
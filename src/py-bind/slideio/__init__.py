@@ -1,7 +1,9 @@
 __all__ = ['get_driver_ids', 'open_slide', 'Compression', 'Slide', 'Scene','compare_images', 'set_log_level','convert_scene', 
+           'set_tile_cache_size', 'clear_tile_cache', 'get_tile_cache_stats', 'set_ndpi_index_enabled', 'set_ndpi_index_directory',
            'SVSJpegParameters','SVSJp2KParameters', 'ColorTransformation', 'transform_scene', 'ColorSpace',
            'GaussianBlurFilter', 'MedianBlurFilter', 'ScharrFilter', 'SobelFilter', 'DataType', 'LaplacianFilter', 'BilateralFilter', 'CannyFilter']
-from .py_slideio import get_driver_ids, open_slide, Scene, Slide, compare_images, set_log_level, convert_scene, transform_scene
+from .py_slideio import get_driver_ids, open_slide, Scene, Slide, compare_images, set_log_level, convert_scene, transform_scene, \
+    set_tile_cache_size, clear_tile_cache, get_tile_cache_stats, set_ndpi_index_enabled, set_ndpi_index_directory
 from slideiopybind import Compression as Compression
 from slideiopybind import SVSJpegParameters as SVSJpegParameters
 from slideiopybind import SVSJp2KParameters as SVSJp2KParameters
@@ -122,6 +122,11 @@ class Scene(object):
         '''Get information about a level in the internal image pyramid.'''
         return self.scene.get_zoom_level_info(index)
 
+    def read_raw_tile(self, zoom_level, tile_index):
+        '''Read encoded data of a tile of a zoom level without decoding.
+        Returns tuple (data, compression). Tiles are indexed in row-major order of the level tile grid.'''
+        return self.scene.read_raw_tile(zoom_level, tile_index)
+
     def get_aux_image_names(self):
         '''Get list of auxiliary image names'''
         return self.scene.get_aux_image_names()
@@ -156,6 +161,66 @@ class Scene(object):
         '''
         return self.scene.read_block(rect, size, channel_indices, slices, frames)
 
+    def read_blocks(self, rects, size=(0,0), channel_indices=[]):
+        '''Reads a batch of rectangular blocks of the scene resized to the same size.
+
+        Args:
+            rects: list of block rectangles, defined as tuples (x, y, width, height).
+            size: size of every block after rescaling. (0,0) - size of the first block.
+            channel_indices: array of channel indices to be retrieved. [] - all channels.
+
+        Returns:
+            numpy array of shape (number of blocks, height, width, channels) with pixel values.
+            Tiles shared by several blocks are decoded once.
+        '''
+        return self.scene.read_blocks(rects, size, channel_indices)
+
+    def read_level_block(self, zoom_level, rect, channel_indices=[], slice=0, frame=0):
+        '''Reads rectangular block of a zoom level in native resolution of the level (without rescaling).
+
+        Args:
+            zoom_level: index of the zoom level.
+            rect: block rectangle in the level coordinates, defined as a tuple (x, y, width, height).
+            channel_indices: array of channel indices to be retrieved. [] - all channels.
+            slice: index of z slice.
+            frame: index of time frame.
+
+        Returns:
+            numpy array with pixel values
+        '''
+        return self.scene.read_level_block(zoom_level, rect, channel_indices, slice, frame)
+
+    def read_tile(self, zoom_level, tile_x, tile_y, channel_indices=[], slice=0, frame=0):
+        '''Reads a tile of a zoom level in native resolution of the level (without rescaling).
+
+        Args:
+            zoom_level: index of the zoom level.
+            tile_x, tile_y: column and row of the tile in the level tile grid.
+            channel_indices: array of channel indices to be retrieved. [] - all channels.
+            slice: index of z slice.
+            frame: index of time frame.
+
+        Returns:
+            numpy array with pixel values
+        '''
+        return self.scene.read_tile(zoom_level, tile_x, tile_y, channel_indices, slice, frame)
+
+    def read_level_blocks(self, zoom_level, block_size=(0,0), channel_indices=[], depth=4, threads=2):
+        '''Iterates over blocks of a zoom level in row-major order. Blocks are read ahead in background threads.
+
+        Args:
+            zoom_level: index of the zoom level.
+            block_size: size of the blocks as a tuple (width, height). (0,0) - tile size of the level.
+            channel_indices: array of channel indices to be retrieved. [] - all channels.
+            depth: maximum number of blocks read ahead.
+            threads: number of reading threads.
+
+        Returns:
+            iterator of tuples (rect, data), where rect - block rectangle (x, y, width, height)
+            in the level coordinates, data - numpy array with pixel values.
+        '''
+        return self.scene.read_level_blocks(zoom_level, block_size, channel_indices, depth, threads)
+
     def get_channel_data_type(self, channel):
         '''Returns data type for a scene channel by index
         Args:
@@ -300,6 +365,31 @@ def set_log_level(log_level:str):
     '''Sets log level'''
     sld.set_log_level(log_level)
 
+def set_tile_cache_size(max_bytes:int):
+    '''Sets memory budget of the process-wide cache of decoded tiles
+
+    Args:
+        max_bytes: maximum size of cached tiles in bytes. 0 disables the cache.
+    '''
+    sld.set_tile_cache_size(max_bytes)
+
+def clear_tile_cache():
+    '''Removes all tiles from the decoded tile cache'''
+    sld.clear_tile_cache()
+
+def get_tile_cache_stats():
+    '''Returns a dictionary with size, max_size, tiles, hits and misses of the decoded tile cache'''
+    return sld.get_tile_cache_stats()
+
+def set_ndpi_index_enabled(enable:bool):
+    '''Enables index files of NDPI slides. Directories scanned at opening of a slide are saved
+    to an index file and reused when the slide is opened again.'''
+    sld.set_ndpi_index_enabled(enable)
+
+def set_ndpi_index_directory(directory:str):
+    '''Sets directory for NDPI index files. Empty string puts index files next to the slides.'''
+    sld.set_ndpi_index_directory(directory)
+
 def transform_scene(scene, params):
     '''Transform scene raster
     
@@ -0,0 +1,118 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace slideio
+{
+    /**@brief Thread-safe pool of resources that cannot be shared between threads
+     * (file streams, library handles with a current position or directory).
+     *
+     * acquire() hands out an idle resource or creates a new one with the factory.
+     * The resource returns to the pool when the lease is destroyed. A resource left
+     * in an undefined state (e.g. after a read error) should be dropped by Lease::discard.
+     * The pool must outlive all its leases.
+     */
+    template <typename T>
+    class ResourcePool
+    {
+    public:
+        typedef std::function<std::unique_ptr<T>()> Factory;
+
+        class Lease
+        {
+        public:
+            Lease() = default;
+            Lease(ResourcePool* pool, std::unique_ptr<T> resource) : m_pool(pool), m_resource(std::move(resource)) {
+            }
+            Lease(Lease&& other) noexcept : m_pool(other.m_pool), m_resource(std::move(other.m_resource)) {
+                other.m_pool = nullptr;
+            }
+            Lease& operator=(Lease&& other) noexcept {
+                if (this != &other) {
+                    release();
+                    m_pool = other.m_pool;
+                    m_resource = std::move(other.m_resource);
+                    other.m_pool = nullptr;
+                }
+                return *this;
+            }
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease() {
+                release();
+            }
+            T* get() const {
+                return m_resource.get();
+            }
+            T* operator->() const {
+                return m_resource.get();
+            }
+            T& operator*() const {
+                return *m_resource;
+            }
+            explicit operator bool() const {
+                return static_cast<bool>(m_resource);
+            }
+            void discard() {
+                m_resource.reset();
+            }
+        private:
+            void release() {
+                if (m_pool && m_resource) {
+                    m_pool->put(std::move(m_resource));
+                }
+                m_pool = nullptr;
+            }
+        private:
+            ResourcePool* m_pool = nullptr;
+            std::unique_ptr<T> m_resource;
+        };
+
+    public:
+        explicit ResourcePool(Factory factory, size_t maxIdle = 16) : m_factory(std::move(factory)), m_maxIdle(maxIdle) {
+        }
+        ResourcePool(const ResourcePool&) = delete;
+        ResourcePool& operator=(const ResourcePool&) = delete;
+
+        Lease acquire() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_idle.empty()) {
+                    std::unique_ptr<T> resource = std::move(m_idle.back());
+                    m_idle.pop_back();
+                    return Lease(this, std::move(resource));
+                }
+            }
+            // the factory may be slow (opens files): do not hold the lock
+            return Lease(this, m_factory());
+        }
+
+        void put(std::unique_ptr<T> resource) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (resource && m_idle.size() < m_maxIdle) {
+                m_idle.push_back(std::move(resource));
+            }
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_idle.clear();
+        }
+
+        size_t getIdleCount() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_idle.size();
+        }
+
+    private:
+        Factory m_factory;
+        size_t m_maxIdle;
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<T>> m_idle;
+    };
+}
@@ -0,0 +1,138 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/base/scratchbuffer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace slideio;
+
+namespace
+{
+    struct ArenaBuffer
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t capacity = 0;
+    };
+
+    // idle buffers per thread; a thread rarely holds more than a few buffers at a time
+    const size_t MAX_ARENA_BUFFERS = 4;
+    std::atomic<size_t> maxArenaBufferSize(64 * 1024 * 1024);
+    // idle memory of all threads
+    std::atomic<size_t> maxArenaMemory(512 * 1024 * 1024);
+    std::atomic<size_t> arenaMemory(0);
+
+    struct Arena
+    {
+        std::vector<ArenaBuffer> buffers;
+        ~Arena()
+        {
+            for (const ArenaBuffer& buffer : buffers) {
+                arenaMemory.fetch_sub(buffer.capacity, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<ArenaBuffer>& threadArena()
+    {
+        thread_local Arena arena;
+        return arena.buffers;
+    }
+}
+
+ScratchBuffer::ScratchBuffer(size_t size)
+{
+    std::vector<ArenaBuffer>& arena = threadArena();
+    if (!arena.empty()) {
+        // prefer the smallest idle buffer that fits, otherwise the biggest one
+        auto best = arena.end();
+        for (auto it = arena.begin(); it != arena.end(); ++it) {
+            if (best == arena.end()) {
+                best = it;
+            }
+            else if (it->capacity >= size) {
+                if (best->capacity < size || it->capacity < best->capacity) {
+                    best = it;
+                }
+            }
+            else if (best->capacity < size && it->capacity > best->capacity) {
+                best = it;
+            }
+        }
+        m_data = std::move(best->data);
+        m_capacity = best->capacity;
+        arenaMemory.fetch_sub(m_capacity, std::memory_order_relaxed);
+        arena.erase(best);
+    }
+    resize(size);
+}
+
+ScratchBuffer::~ScratchBuffer()
+{
+    if (!m_data || m_capacity > maxArenaBufferSize.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::vector<ArenaBuffer>& arena = threadArena();
+    if (arena.size() >= MAX_ARENA_BUFFERS) {
+        // drop the smallest idle buffer: big ones are the expensive ones to allocate
+        auto smallest = std::min_element(arena.begin(), arena.end(),
+            [](const ArenaBuffer& left, const ArenaBuffer& right) {
+                return left.capacity < right.capacity;
+            });
+        if (smallest->capacity >= m_capacity) {
+            return;
+        }
+        arenaMemory.fetch_sub(smallest->capacity, std::memory_order_relaxed);
+        arena.erase(smallest);
+    }
+    if (arenaMemory.fetch_add(m_capacity, std::memory_order_relaxed) + m_capacity
+        > maxArenaMemory.load(std::memory_order_relaxed)) {
+        arenaMemory.fetch_sub(m_capacity, std::memory_order_relaxed);
+        return;
+    }
+    ArenaBuffer buffer;
+    buffer.data = std::move(m_data);
+    buffer.capacity = m_capacity;
+    arena.push_back(std::move(buffer));
+}
+
+void ScratchBuffer::resize(size_t size)
+{
+    if (size > m_capacity) {
+        // the content is not preserved on growth: buffers are filled by the caller
+        m_data.reset(new uint8_t[size]);
+        m_capacity = size;
+    }
+    m_size = size;
+}
+
+void ScratchBuffer::setMaxArenaBufferSize(size_t bytes)
+{
+    maxArenaBufferSize.store(bytes, std::memory_order_relaxed);
+}
+
+size_t ScratchBuffer::getMaxArenaBufferSize()
+{
+    return maxArenaBufferSize.load(std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setMaxArenaMemory(size_t bytes)
+{
+    maxArenaMemory.store(bytes, std::memory_order_relaxed);
+}
+
+size_t ScratchBuffer::getMaxArenaMemory()
+{
+    return maxArenaMemory.load(std::memory_order_relaxed);
+}
+
+size_t ScratchBuffer::getArenaMemory()
+{
+    return arenaMemory.load(std::memory_order_relaxed);
+}
+
+size_t ScratchBuffer::getArenaBufferCount()
+{
+    return threadArena().size();
+}
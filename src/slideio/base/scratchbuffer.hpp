@@ -0,0 +1,63 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/base/slideio_base_def.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    /**@brief Temporary byte buffer borrowed from a per-thread arena.
+     *
+     * Decoders need large short-lived buffers (compressed tiles, intermediate rasters)
+     * for every tile. The buffer is taken from a free list of the calling thread and
+     * returned to it on destruction, so repeated reads reuse the same memory without
+     * heap allocations and without locking. Nested buffers of one thread are independent.
+     * The content of a new buffer is undefined. The buffer must be destroyed
+     * by the thread that created it.
+     */
+    class SLIDEIO_BASE_EXPORTS ScratchBuffer
+    {
+    public:
+        explicit ScratchBuffer(size_t size = 0);
+        ~ScratchBuffer();
+        ScratchBuffer(const ScratchBuffer&) = delete;
+        ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+        // keeps the content if the new size does not exceed the capacity
+        void resize(size_t size);
+        uint8_t* data() const {
+            return m_data.get();
+        }
+        size_t size() const {
+            return m_size;
+        }
+        size_t capacity() const {
+            return m_capacity;
+        }
+        // buffers bigger than the limit are freed instead of returning to the arena
+        static void setMaxArenaBufferSize(size_t bytes);
+        static size_t getMaxArenaBufferSize();
+        // idle buffers of all threads together are limited by the budget
+        static void setMaxArenaMemory(size_t bytes);
+        static size_t getMaxArenaMemory();
+        // memory of idle buffers of all threads
+        static size_t getArenaMemory();
+        // number of idle buffers kept by the calling thread
+        static size_t getArenaBufferCount();
+    private:
+        std::unique_ptr<uint8_t[]> m_data;
+        size_t m_size = 0;
+        size_t m_capacity = 0;
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
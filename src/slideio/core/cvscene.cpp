@@ -3,6 +3,7 @@
 // of this distribution and at http://slideio.com/license.html.
 #include "slideio/core/cvscene.hpp"
 #include "slideio/imagetools/cvtools.hpp"
+#include "slideio/core/tools/tools.hpp"
 
 #include <numeric>
 
@@ -187,6 +188,72 @@ const LevelInfo* CVScene::getZoomLevelInfo(int level) const {
     return &m_levels[level];
 }
 
+Compression CVScene::readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data) {
+    RAISE_RUNTIME_ERROR << "Raw tile reading is not supported by the driver. File: " << getFilePath();
+}
+
+cv::Rect CVScene::getLevelTileRect(int zoomLevel, int tileX, int tileY) const {
+    const LevelInfo* level = getZoomLevelInfo(zoomLevel);
+    const cv::Size levelSize = level->getSize();
+    cv::Size tileSize = level->getTileSize();
+    if (tileSize.width <= 0 || tileSize.height <= 0) {
+        tileSize = levelSize;
+    }
+    const int tilesX = (levelSize.width - 1) / tileSize.width + 1;
+    const int tilesY = (levelSize.height - 1) / tileSize.height + 1;
+    if (tileX < 0 || tileX >= tilesX || tileY < 0 || tileY >= tilesY) {
+        RAISE_RUNTIME_ERROR << "Invalid tile (" << tileX << "," << tileY << ") of zoom level " << zoomLevel
+            << ". Expected grid: " << tilesX << "x" << tilesY;
+    }
+    const cv::Rect tileRect(tileX * tileSize.width, tileY * tileSize.height, tileSize.width, tileSize.height);
+    return tileRect & cv::Rect(cv::Point(0, 0), levelSize);
+}
+
+void CVScene::readLevelBlock(int zoomLevel, const cv::Rect& levelRect, cv::OutputArray output) {
+    RefCounterGuard guard(this);
+    const std::vector<int> channelIndices;
+    readLevelBlockChannels(zoomLevel, levelRect, channelIndices, 0, 0, output);
+}
+
+void CVScene::readLevelBlockChannels(int zoomLevel, const cv::Rect& levelRect, const std::vector<int>& channelIndices,
+    int zSliceIndex, int tFrameIndex, cv::OutputArray output) {
+    RefCounterGuard guard(this);
+    const LevelInfo* level = getZoomLevelInfo(zoomLevel);
+    const cv::Rect levelBounds(cv::Point(0, 0), level->getSize());
+    if (levelRect.empty() || (levelRect & levelBounds) != levelRect) {
+        RAISE_RUNTIME_ERROR << "Invalid block (" << levelRect.x << "," << levelRect.y << ","
+            << levelRect.width << "," << levelRect.height << ") of zoom level " << zoomLevel
+            << ". Level size: " << levelBounds.width << "x" << levelBounds.height;
+    }
+    if (zSliceIndex < 0 || zSliceIndex >= getNumZSlices()) {
+        RAISE_RUNTIME_ERROR << "Invalid z-slice index: " << zSliceIndex
+            << " Expected range: [0," << getNumZSlices() << ")";
+    }
+    if (tFrameIndex < 0 || tFrameIndex >= getNumTFrames()) {
+        RAISE_RUNTIME_ERROR << "Invalid time frame index: " << tFrameIndex
+            << " Expected range: [0," << getNumTFrames() << ")";
+    }
+    readLevelBlockChannelsEx(zoomLevel, levelRect, channelIndices, zSliceIndex, tFrameIndex, output);
+}
+
+void CVScene::readLevelTile(int zoomLevel, int tileX, int tileY, const std::vector<int>& channelIndices,
+    int zSliceIndex, int tFrameIndex, cv::OutputArray output) {
+    RefCounterGuard guard(this);
+    const cv::Rect tileRect = getLevelTileRect(zoomLevel, tileX, tileY);
+    readLevelBlockChannels(zoomLevel, tileRect, channelIndices, zSliceIndex, tFrameIndex, output);
+}
+
+void CVScene::readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect,
+    const std::vector<int>& channelIndices, int zSliceIndex, int tFrameIndex, cv::OutputArray output) {
+    const LevelInfo* level = getZoomLevelInfo(zoomLevel);
+    const cv::Size sceneSize = getRect().size();
+    const double scaleX = static_cast<double>(sceneSize.width) / static_cast<double>(level->getSize().width);
+    const double scaleY = static_cast<double>(sceneSize.height) / static_cast<double>(level->getSize().height);
+    cv::Rect blockRect;
+    Tools::scaleRect(levelRect, scaleX, scaleY, blockRect);
+    blockRect &= cv::Rect(cv::Point(0, 0), sceneSize);
+    readResampledBlockChannelsEx(blockRect, levelRect.size(), channelIndices, zSliceIndex, tFrameIndex, output);
+}
 
 std::vector<int> CVScene::getValidChannelIndices(const std::vector<int>& channelIndices)
 {
@@ -219,6 +286,78 @@ void CVScene::initializeSceneBlock(const cv::Size& blockSize, const std::vector<
     }
 }
 
+void CVScene::readBlockRequest(const BlockRequest& block, cv::OutputArray output)
+{
+    RefCounterGuard guard(this);
+    if (block.zoomLevel >= 0) {
+        readLevelBlockChannels(block.zoomLevel, block.rect, block.channelIndices, block.zSliceIndex,
+            block.tFrameIndex, output);
+    }
+    else {
+        readResampledBlockChannelsEx(block.rect, block.size, block.channelIndices, block.zSliceIndex,
+            block.tFrameIndex, output);
+    }
+}
+
+bool CVScene::getBlockDataRanges(const BlockRequest&, std::vector<FileRange>&)
+{
+    return false;
+}
+
+void CVScene::readBlocks(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+    const std::vector<int>& channelIndicesIn, cv::OutputArray output)
+{
+    RefCounterGuard guard(this);
+    if (blockSize.width <= 0 || blockSize.height <= 0) {
+        RAISE_RUNTIME_ERROR << "Invalid block size " << blockSize.width << "x" << blockSize.height
+            << " for reading of a block batch. File: " << getFilePath();
+    }
+    const cv::Rect sceneBounds(cv::Point(0, 0), getRect().size());
+    for (const cv::Rect& blockRect : blockRects) {
+        if (blockRect.empty() || (blockRect & sceneBounds) != blockRect) {
+            RAISE_RUNTIME_ERROR << "Invalid block (" << blockRect.x << "," << blockRect.y << "," << blockRect.width
+                << "," << blockRect.height << ") in a block batch. Scene size: " << sceneBounds.width << "x"
+                << sceneBounds.height << ". File: " << getFilePath();
+        }
+    }
+    const std::vector<int> channelIndices = getValidChannelIndices(channelIndicesIn);
+    const int channelCount = static_cast<int>(channelIndices.size());
+    const int cvType = CVTools::toOpencvType(getChannelDataType(channelIndices.front()));
+    const int blockCount = static_cast<int>(blockRects.size());
+    const int dims[] = { blockCount, blockSize.height, blockSize.width };
+    output.create(3, dims, CV_MAKE_TYPE(cvType, channelCount));
+    if (blockCount == 0) {
+        return;
+    }
+    cv::Mat& batch = output.getMatRef();
+    // 2D views of the planes of the batch
+    std::vector<cv::Mat> blockRasters(blockCount);
+    for (int block = 0; block < blockCount; ++block) {
+        blockRasters[block] = cv::Mat(blockSize, batch.type(), batch.ptr(block));
+    }
+    readResampledBlocksChannels(blockRects, blockSize, channelIndicesIn, blockRasters);
+    for (int block = 0; block < blockCount; ++block) {
+        const cv::Mat& blockRaster = blockRasters[block];
+        if (blockRaster.data != batch.ptr(block)) {
+            // the reader allocated its own raster
+            if (blockRaster.size() != blockSize || blockRaster.type() != batch.type()) {
+                RAISE_RUNTIME_ERROR << "Unexpected raster of block " << block << " received by reading of file "
+                    << getFilePath();
+            }
+            cv::Mat plane(blockSize, batch.type(), batch.ptr(block));
+            blockRaster.copyTo(plane);
+        }
+    }
+}
+
+void CVScene::readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+    const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters)
+{
+    for (size_t block = 0; block < blockRects.size(); ++block) {
+        readResampledBlockChannels(blockRects[block], blockSize, channelIndices, blockRasters[block]);
+    }
+}
+
 std::string CVScene::toString() const {
     std::ostringstream os;
     os << "File Path: " << getFilePath() << "\n";
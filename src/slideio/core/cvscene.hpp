@@ -13,6 +13,7 @@
 #include <list>
 #include "refcounter.hpp"
 #include <map>
+#include <mutex>
 
 #include "levelinfo.hpp"
 
@@ -32,6 +33,15 @@ namespace slideio
      * The class supports 2D, 3D and 4D multi-channel images and provides methods for extraction
      * of arbitrary image regions, optionally with resizing.
      * Methods for working with raster data deliver image blocks as opencv Mat objects.
+     *
+     * Thread safety: raster reading methods of a scene may be called concurrently from several threads.
+     * Drivers do not keep per-call state (current directory, file position) in shared members:
+     * file handles are either pooled/positional or guarded by a driver mutex, in the latter case
+     * concurrent reads of the scene are serialized.
+     *
+     * Output rasters: if the output of a reading method is already allocated with the required
+     * size and type (e.g. a cv::Mat over a caller buffer), the pixels are written into it without
+     * reallocation. Tile based drivers decode tiles directly into such rasters where possible.
      */
     class SLIDEIO_CORE_EXPORTS CVScene : public RefCounter
     {
@@ -194,8 +204,99 @@ namespace slideio
             const std::vector<int>& componentIndices, int zSliceIndex, int tFrameIndex, cv::OutputArray output);
         virtual int getNumZoomLevels() const;
         virtual const LevelInfo* getZoomLevelInfo(int level) const;
+        /**@brief reads encoded data of a tile of a zoom level without decoding.
+         *
+         * Tiles of a level are indexed in row-major order of the level tile grid (see LevelInfo::getTileSize).
+         * Jpeg tiles stored as abbreviated streams are completed with the shared tables of the level,
+         * so the data is always a standalone stream of the returned compression.
+         * The default implementation throws an exception: the driver does not support raw tile access.
+         * @param zoomLevel : index of the zoom level;
+         * @param tileIndex : index of the tile in the level;
+         * @param data : output buffer for the encoded tile.
+         * @return compression of the tile data.
+         */
+        virtual Compression readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data);
+        /**@brief returns rectangle of a tile of a zoom level in the level coordinates.
+         *
+         * Tiles of the last row and column are clipped by the level size.
+         * A level without tiles (tile size is not defined) is considered as a single tile.
+         * @param zoomLevel : index of the zoom level;
+         * @param tileX : column of the tile in the level tile grid;
+         * @param tileY : row of the tile in the level tile grid.
+         */
+        cv::Rect getLevelTileRect(int zoomLevel, int tileX, int tileY) const;
+        /**@brief reads raster rectangle of a zoom level in native resolution of the level.
+         *
+         * @param zoomLevel : index of the zoom level;
+         * @param levelRect : rectangle of the block in the level coordinates (see LevelInfo::getSize);
+         * @param output : reference to cv::OutputArray object. Size of the output is equal to the rectangle size.
+         */
+        void readLevelBlock(int zoomLevel, const cv::Rect& levelRect, cv::OutputArray output);
+        /**@brief reads selected channels of raster rectangle of a zoom level in native resolution of the level.
+         *
+         * Unlike the readResampled* methods, no zoom level selection and no resizing is performed.
+         * @param zoomLevel : index of the zoom level;
+         * @param levelRect : rectangle of the block in the level coordinates (see LevelInfo::getSize);
+         * @param channelIndices : vector of indices of channels to be extracted. Empty vector for all channels;
+         * @param zSliceIndex : index of z-slice;
+         * @param tFrameIndex : index of time frame;
+         * @param output : reference to cv::OutputArray object. Size of the output is equal to the rectangle size.
+         */
+        void readLevelBlockChannels(int zoomLevel, const cv::Rect& levelRect, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, cv::OutputArray output);
+        /**@brief reads a tile of a zoom level in native resolution of the level.
+         *
+         * The tile rectangle is defined by getLevelTileRect.
+         * @param zoomLevel : index of the zoom level;
+         * @param tileX : column of the tile in the level tile grid;
+         * @param tileY : row of the tile in the level tile grid;
+         * @param channelIndices : vector of indices of channels to be extracted. Empty vector for all channels;
+         * @param zSliceIndex : index of z-slice;
+         * @param tFrameIndex : index of time frame;
+         * @param output : reference to cv::OutputArray object.
+         */
+        void readLevelTile(int zoomLevel, int tileX, int tileY, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, cv::OutputArray output);
+        /**@brief reads a block described by a request.
+         *
+         * Dispatches the request to readLevelBlockChannels for level blocks and to
+         * readResampledBlockChannelsEx for scene blocks.
+         */
+        void readBlockRequest(const BlockRequest& block, cv::OutputArray output);
+        /**@brief collects ranges of the file holding encoded data of a block.
+         *
+         * Used for read-ahead hints to the operating system. The ranges may overlap and are not sorted.
+         * The default implementation returns false: the driver does not report data locations.
+         */
+        virtual bool getBlockDataRanges(const BlockRequest& block, std::vector<FileRange>& ranges);
+        /**@brief reads a batch of rectangles of a plane image resized to the same size.
+         *
+         * @param blockRects : rectangles of the blocks in the scene coordinates;
+         * @param blockSize : size of every block after resizing;
+         * @param channelIndices : vector of indices of channels to be extracted. Empty vector selects all channels;
+         * @param output : reference to cv::OutputArray object. The method creates a continuous 3-dimensional
+         * cv::Mat object (number of blocks x height x width) with the selected channels as matrix channels.
+         * Tiles shared by several blocks are decoded once by drivers composing blocks from tiles.
+         */
+        void readBlocks(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+            const std::vector<int>& channelIndices, cv::OutputArray output);
         std::string toString() const;
     protected:
+        /**@brief reads a batch of validated rectangles into preallocated block rasters.
+         *
+         * The default implementation reads the blocks one by one with readResampledBlockChannels.
+         * Drivers composing blocks from tiles override it to share decoded tiles across the batch.
+         */
+        virtual void readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+            const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters);
+        /**@brief reads a validated rectangle of a zoom level without resizing.
+         *
+         * The default implementation maps the rectangle to the scene coordinates and reads it with
+         * readResampledBlockChannelsEx. Drivers that compose levels from tiles override it to read
+         * the level directly.
+         */
+        virtual void readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect,
+            const std::vector<int>& channelIndices, int zSliceIndex, int tFrameIndex, cv::OutputArray output);
         std::vector<int> getValidChannelIndices(const std::vector<int>& channelIndices);
         void initializeSceneBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices,
                                   cv::OutputArray output) const;
@@ -203,6 +304,8 @@ namespace slideio
     protected:
         std::list<std::string> m_auxNames;
         std::vector<LevelInfo> m_levels;
+        // serializes reads of drivers whose file handles cannot be used concurrently
+        std::recursive_mutex m_readMutex;
     };
 }
 
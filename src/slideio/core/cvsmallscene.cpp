@@ -2,6 +2,7 @@
 // It is subject to the license terms in the LICENSE file found in the top-level directory
 // of this distribution and at http://slideio.com/license.html.
 #include "cvsmallscene.hpp"
+#include "slideio/core/tools/tools.hpp"
 #include <opencv2/imgproc.hpp>
 
 using namespace slideio;
@@ -16,13 +17,7 @@ void CVSmallScene::readResampledBlockChannels(const cv::Rect& blockRect, const c
     cv::Mat imageBlock = image(intersection);
     cv::Mat block;
     if(!channelIndices.empty()) {
-        std::vector<cv::Mat> channels;
-        for(auto channelIndex:channelIndices) {
-            cv::Mat channel;
-            cv::extractChannel(imageBlock, channel, channelIndex);
-            channels.push_back(channel);
-        }
-        cv::merge(channels.data(), channels.size(), block);
+        Tools::extractChannels(imageBlock, channelIndices, block);
     } else {
         block = imageBlock;
     }
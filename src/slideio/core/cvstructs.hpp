@@ -3,8 +3,34 @@
 // of this distribution and at http://slideio.com/license.html.
 #pragma  once
 #include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
 
 namespace slideio
 {
     typedef cv::Point2d Resolution;
-}
\ No newline at end of file
+
+    /**@brief describes a block of a scene to be read.
+     *
+     * A block with a negative zoom level is a rectangle of the scene resized to the block size
+     * (see CVScene::readResampledBlockChannelsEx). A block with a zoom level is a rectangle of the
+     * level in the level coordinates read in native resolution (see CVScene::readLevelBlockChannels),
+     * the size is ignored.
+     */
+    struct BlockRequest
+    {
+        cv::Rect rect;
+        cv::Size size;
+        std::vector<int> channelIndices;
+        int zSliceIndex = 0;
+        int tFrameIndex = 0;
+        int zoomLevel = -1;
+    };
+
+    /**@brief range of bytes of a file */
+    struct FileRange
+    {
+        int64_t offset = 0;
+        int64_t size = 0;
+    };
+}
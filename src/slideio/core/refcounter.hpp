@@ -3,26 +3,41 @@
 // of this distribution and at http://slideio.com/license.html.
 #pragma once
 #include "slideio/core/slideio_core_def.hpp"
+#include <atomic>
+#include <mutex>
 namespace slideio
 {
     class SLIDEIO_CORE_EXPORTS RefCounter
     {
     public:
+        RefCounter() = default;
+        // a copy does not inherit active references of the source object
+        RefCounter(const RefCounter&) {}
+        RefCounter& operator=(const RefCounter&) { return *this; }
+        virtual ~RefCounter() = default;
+        // Counter may be changed concurrently by several reading threads.
+        // Transitions from and to zero are serialized so that initializeCounter
+        // and cleanCounter never overlap.
         void increaseCounter() {
-            if (!m_counter)
+            std::lock_guard<std::mutex> lock(m_transitionMutex);
+            if (m_counter == 0)
                 initializeCounter();
             ++m_counter;
         }
         void decreaseCounter() {
-            --m_counter;
-            if (!m_counter)
+            std::lock_guard<std::mutex> lock(m_transitionMutex);
+            if (--m_counter == 0)
                 cleanCounter();
         }
+        int getCounter() const {
+            return m_counter;
+        }
     protected:
         virtual void initializeCounter(){};
         virtual void cleanCounter(){};
     private:
-        int m_counter = 0;
+        std::atomic<int> m_counter{0};
+        std::mutex m_transitionMutex;
     };
 
     class SLIDEIO_CORE_EXPORTS RefCounterGuard
@@ -0,0 +1,174 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/core/tools/blockprefetcher.hpp"
+#include "slideio/core/cvscene.hpp"
+#include "slideio/base/exceptions.hpp"
+#include <algorithm>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace slideio;
+
+BlockPrefetcher::BlockPrefetcher(std::shared_ptr<CVScene> scene, std::vector<BlockRequest> scanOrder,
+    int depth, int numThreads) : m_scene(std::move(scene)), m_blocks(std::move(scanOrder))
+{
+    if (!m_scene) {
+        RAISE_RUNTIME_ERROR << "BlockPrefetcher: invalid scene";
+    }
+    m_depth = static_cast<size_t>(std::max(1, depth));
+#if defined(__linux__)
+    m_file = ::open(m_scene->getFilePath().c_str(), O_RDONLY);
+#endif
+    // the first window is hinted at once, the workers hint a block when the window reaches it
+    for (size_t index = 0; index < std::min(m_depth, m_blocks.size()); ++index) {
+        adviseBlock(index);
+    }
+    const int threadCount = std::max(1, std::min(numThreads, static_cast<int>(m_depth)));
+    try {
+        for (int thread = 0; thread < threadCount; ++thread) {
+            m_workers.emplace_back(&BlockPrefetcher::run, this);
+        }
+    }
+    catch (...) {
+        // the destructor does not run for a failed constructor: joinable threads would terminate
+        stop();
+#if defined(__linux__)
+        if (m_file >= 0) {
+            ::close(m_file);
+            m_file = -1;
+        }
+#endif
+        throw;
+    }
+}
+
+BlockPrefetcher::~BlockPrefetcher()
+{
+    stop();
+#if defined(__linux__)
+    if (m_file >= 0) {
+        ::close(m_file);
+    }
+#endif
+}
+
+void BlockPrefetcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+    m_workCondition.notify_all();
+    m_readyCondition.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+void BlockPrefetcher::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_workCondition.wait(lock, [this]() {
+            return m_stopped || (m_nextToRead < m_blocks.size() && m_nextToRead < m_nextConsumed + m_depth);
+        });
+        if (m_stopped) {
+            return;
+        }
+        const size_t index = m_nextToRead++;
+        lock.unlock();
+        adviseBlock(index + m_depth);
+        Slot slot;
+        try {
+            m_scene->readBlockRequest(m_blocks[index], slot.raster);
+        }
+        catch (...) {
+            slot.error = std::current_exception();
+        }
+        lock.lock();
+        m_ready[index] = std::move(slot);
+        m_readyCondition.notify_all();
+    }
+}
+
+bool BlockPrefetcher::next(BlockRequest& block, cv::OutputArray output)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_nextConsumed >= m_blocks.size()) {
+        return false;
+    }
+    m_readyCondition.wait(lock, [this]() {
+        return m_stopped || m_ready.count(m_nextConsumed) > 0;
+    });
+    auto it = m_ready.find(m_nextConsumed);
+    if (it == m_ready.end()) {
+        RAISE_RUNTIME_ERROR << "BlockPrefetcher: reading is stopped";
+    }
+    Slot slot = std::move(it->second);
+    m_ready.erase(it);
+    const size_t index = m_nextConsumed++;
+    lock.unlock();
+    m_workCondition.notify_all();
+    if (slot.error) {
+        std::rethrow_exception(slot.error);
+    }
+    block = m_blocks[index];
+    output.assign(slot.raster);
+    return true;
+}
+
+void BlockPrefetcher::adviseBlock(size_t index)
+{
+#if defined(__linux__) && defined(POSIX_FADV_WILLNEED)
+    if (m_file < 0 || index >= m_blocks.size()) {
+        return;
+    }
+    std::vector<FileRange> ranges;
+    try {
+        if (!m_scene->getBlockDataRanges(m_blocks[index], ranges)) {
+            return;
+        }
+    }
+    catch (...) {
+        // hints are optional: the block reports its errors when it is read
+        return;
+    }
+    for (const FileRange& range : ranges) {
+        ::posix_fadvise(m_file, static_cast<off_t>(range.offset), static_cast<off_t>(range.size),
+            POSIX_FADV_WILLNEED);
+    }
+#endif
+}
+
+std::vector<BlockRequest> BlockPrefetcher::makeLevelScanOrder(const CVScene& scene, int zoomLevel,
+    const cv::Size& blockSize, const std::vector<int>& channelIndices)
+{
+    const LevelInfo* level = scene.getZoomLevelInfo(zoomLevel);
+    const cv::Size levelSize = level->getSize();
+    cv::Size size = blockSize;
+    if (size.width <= 0 || size.height <= 0) {
+        size = level->getTileSize();
+    }
+    if (size.width <= 0 || size.height <= 0) {
+        size = levelSize;
+    }
+    std::vector<BlockRequest> blocks;
+    for (int y = 0; y < levelSize.height; y += size.height) {
+        for (int x = 0; x < levelSize.width; x += size.width) {
+            BlockRequest block;
+            block.rect = cv::Rect(x, y, std::min(size.width, levelSize.width - x),
+                std::min(size.height, levelSize.height - y));
+            block.size = block.rect.size();
+            block.channelIndices = channelIndices;
+            block.zoomLevel = zoomLevel;
+            blocks.push_back(block);
+        }
+    }
+    return blocks;
+}
@@ -0,0 +1,78 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/core/slideio_core_def.hpp"
+#include "slideio/core/cvstructs.hpp"
+#include <opencv2/core.hpp>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    class CVScene;
+
+    /**@brief Read-ahead of blocks of a scene scanned in a known order.
+     *
+     * Worker threads decode up to "depth" blocks ahead of the consumer. Before a block enters
+     * the window, the file ranges of its encoded data (if the driver reports them, see
+     * CVScene::getBlockDataRanges) are passed to the operating system as read-ahead hints.
+     * Blocks are returned by next() in the scan order. Errors of block reading are rethrown
+     * by next() for the failed block. With several threads the scene must support
+     * concurrent reads; drivers that serialize reading still overlap decoding with the consumer.
+     */
+    class SLIDEIO_CORE_EXPORTS BlockPrefetcher
+    {
+    public:
+        BlockPrefetcher(std::shared_ptr<CVScene> scene, std::vector<BlockRequest> scanOrder,
+            int depth = 4, int numThreads = 2);
+        ~BlockPrefetcher();
+        BlockPrefetcher(const BlockPrefetcher&) = delete;
+        BlockPrefetcher& operator=(const BlockPrefetcher&) = delete;
+        // waits for the next block of the scan order. Returns false after the last block.
+        bool next(BlockRequest& block, cv::OutputArray output);
+        size_t getBlockCount() const {
+            return m_blocks.size();
+        }
+        // row-major order of blocks covering a zoom level. Empty block size selects
+        // the level tile size (or the whole level for not tiled levels).
+        static std::vector<BlockRequest> makeLevelScanOrder(const CVScene& scene, int zoomLevel,
+            const cv::Size& blockSize = cv::Size(), const std::vector<int>& channelIndices = {});
+    private:
+        struct Slot
+        {
+            cv::Mat raster;
+            std::exception_ptr error;
+        };
+        void run();
+        void adviseBlock(size_t index);
+        void stop();
+    private:
+        std::shared_ptr<CVScene> m_scene;
+        std::vector<BlockRequest> m_blocks;
+        size_t m_depth;
+        size_t m_nextToRead = 0;
+        size_t m_nextConsumed = 0;
+        bool m_stopped = false;
+        std::map<size_t, Slot> m_ready;
+        std::mutex m_mutex;
+        std::condition_variable m_workCondition;
+        std::condition_variable m_readyCondition;
+        std::vector<std::thread> m_workers;
+        int m_file = -1;
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
@@ -20,6 +20,7 @@ void CacheManager::addTile(int level, cv::Point2i pos, const cv::Mat& tile)
 	cv::Mat tileCopy;
 	tile.copyTo(tileCopy);
     m_cache.push_back(tileCopy);
+    m_memorySize += tileCopy.total() * tileCopy.elemSize();
     int tileIndex = static_cast<int>(m_cache.size() - 1);
     if(m_levels.find(level) == m_levels.end()) {
         m_levels[level] = std::make_shared<Level>(Level(level));
@@ -68,3 +69,12 @@ const cv::Rect CacheManager::getTileRect(int levelId, int tileIndex) const
 	return level.getTileRect(tileIndex);
 }
 
+void CacheManager::getTilesInRect(int levelId, const cv::Rect& rect, std::vector<int>& tileIndices) const
+{
+	tileIndices.clear();
+	auto it = m_levels.find(levelId);
+	if(it == m_levels.end()) {
+	    return;
+	}
+	it->second->findTiles(rect, tileIndices);
+}
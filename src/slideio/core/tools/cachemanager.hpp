@@ -10,6 +10,7 @@
 #include <opencv2/core.hpp>
 
 #include "tilecomposer.hpp"
+#include "tileindex.hpp"
 #include "tools.hpp"
 
 #if defined(_MSC_VER)
@@ -33,6 +34,7 @@ namespace slideio
 
             void addTile(const cv::Rect& rect, int cacheIndex)
             {
+                m_tileIndex.addTile(static_cast<int>(tiles.size()), rect);
                 tiles.emplace_back(rect, cacheIndex);
             }
 
@@ -51,9 +53,15 @@ namespace slideio
                 return tiles[index].second;
             }
 
+            void findTiles(const cv::Rect& rect, std::vector<int>& tileIndices) const
+            {
+                m_tileIndex.findTiles(rect, tileIndices);
+            }
+
         private:
             int m_id;
             std::vector<std::pair<cv::Rect, int>> tiles;
+            TileIndex m_tileIndex;
         };
 
         CacheManager();
@@ -62,9 +70,13 @@ namespace slideio
         int getTileCount(int level) const;
         cv::Mat getTile(int levelId, int index) const;
         const cv::Rect getTileRect(int levelId, int tileIndex) const;
+        void getTilesInRect(int levelId, const cv::Rect& rect, std::vector<int>& tileIndices) const;
+        // total size of cached tiles in bytes
+        size_t getMemorySize() const { return m_memorySize; }
 
     private:
         std::vector<cv::Mat> m_cache;
+        size_t m_memorySize = 0;
         std::map<int, std::shared_ptr<Level>> m_levels;
     };
 
@@ -81,6 +93,12 @@ namespace slideio
             tileRect = m_cacheManager->getTileRect(m_levelId, tileIndex);
             return true;
         }
+        void getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData) override {
+            m_cacheManager->getTilesInRect(m_levelId, rect, tileIndices);
+        }
+        bool supportsConcurrentReads(void* userData) override {
+            return true;
+        }
         bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
                       void* userData) override {
             cv::Mat tile = m_cacheManager->getTile(m_levelId, tileIndex);
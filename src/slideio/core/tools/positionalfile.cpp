@@ -0,0 +1,106 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/core/tools/positionalfile.hpp"
+#include "slideio/base/exceptions.hpp"
+#if defined(WIN32)
+#include "slideio/core/tools/tools.hpp"
+#include <algorithm>
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace slideio;
+
+#if defined(WIN32)
+
+PositionalFile::PositionalFile(const std::string& filePath) : m_filePath(filePath)
+{
+    const std::wstring wfilePath = Tools::toWstring(filePath);
+    HANDLE handle = CreateFileW(wfilePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        RAISE_RUNTIME_ERROR << "PositionalFile: cannot open file " << filePath << ". Error: " << GetLastError();
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        RAISE_RUNTIME_ERROR << "PositionalFile: cannot get size of file " << filePath;
+    }
+    m_handle = handle;
+    m_size = static_cast<uint64_t>(size.QuadPart);
+}
+
+PositionalFile::~PositionalFile()
+{
+    if (m_handle) {
+        CloseHandle(static_cast<HANDLE>(m_handle));
+    }
+}
+
+void PositionalFile::read(uint64_t offset, size_t size, void* buffer) const
+{
+    uint8_t* data = static_cast<uint8_t*>(buffer);
+    while (size > 0) {
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 0x40000000));
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD bytesRead = 0;
+        if (!ReadFile(static_cast<HANDLE>(m_handle), data, chunk, &bytesRead, &overlapped) || bytesRead == 0) {
+            RAISE_RUNTIME_ERROR << "PositionalFile: cannot read " << size << " bytes at offset " << offset
+                << " of file " << m_filePath;
+        }
+        data += bytesRead;
+        offset += bytesRead;
+        size -= bytesRead;
+    }
+}
+
+#else
+
+PositionalFile::PositionalFile(const std::string& filePath) : m_filePath(filePath)
+{
+    m_fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        RAISE_RUNTIME_ERROR << "PositionalFile: cannot open file " << filePath << ". Error: " << strerror(errno);
+    }
+    struct stat info = {};
+    if (fstat(m_fd, &info) != 0) {
+        ::close(m_fd);
+        RAISE_RUNTIME_ERROR << "PositionalFile: cannot get size of file " << filePath;
+    }
+    m_size = static_cast<uint64_t>(info.st_size);
+}
+
+PositionalFile::~PositionalFile()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+void PositionalFile::read(uint64_t offset, size_t size, void* buffer) const
+{
+    uint8_t* data = static_cast<uint8_t*>(buffer);
+    while (size > 0) {
+        const ssize_t bytesRead = ::pread(m_fd, data, size, static_cast<off_t>(offset));
+        if (bytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead <= 0) {
+            RAISE_RUNTIME_ERROR << "PositionalFile: cannot read " << size << " bytes at offset " << offset
+                << " of file " << m_filePath;
+        }
+        data += bytesRead;
+        offset += static_cast<uint64_t>(bytesRead);
+        size -= static_cast<size_t>(bytesRead);
+    }
+}
+
+#endif
@@ -0,0 +1,51 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/core/slideio_core_def.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    /**@brief Read-only file with positioned reads.
+     *
+     * The file is opened once. Every read takes its file offset as a parameter
+     * (pread on posix systems, ReadFile with an offset on windows) and does not depend
+     * on a shared file position: the object may be used from several threads without locking.
+     */
+    class SLIDEIO_CORE_EXPORTS PositionalFile
+    {
+    public:
+        explicit PositionalFile(const std::string& filePath);
+        ~PositionalFile();
+        PositionalFile(const PositionalFile&) = delete;
+        PositionalFile& operator=(const PositionalFile&) = delete;
+        const std::string& getFilePath() const {
+            return m_filePath;
+        }
+        uint64_t getSize() const {
+            return m_size;
+        }
+        // reads "size" bytes at "offset". Throws if less data is available.
+        void read(uint64_t offset, size_t size, void* buffer) const;
+    private:
+        std::string m_filePath;
+        uint64_t m_size = 0;
+#if defined(WIN32)
+        void* m_handle = nullptr;
+#else
+        int m_fd = -1;
+#endif
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
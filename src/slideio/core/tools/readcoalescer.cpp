@@ -0,0 +1,69 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/core/tools/readcoalescer.hpp"
+#include <algorithm>
+
+using namespace slideio;
+
+ReadCoalescer::ReadCoalescer(int64_t maxGap, int64_t maxReadSize) :
+    m_maxGap(std::max<int64_t>(0, maxGap)), m_maxReadSize(maxReadSize)
+{
+}
+
+void ReadCoalescer::coalesce(const std::vector<FileRange>& rangesIn, int64_t maxGap, int64_t maxReadSize,
+    std::vector<FileRange>& reads)
+{
+    reads.clear();
+    std::vector<FileRange> ranges;
+    ranges.reserve(rangesIn.size());
+    for (const FileRange& range : rangesIn) {
+        if (range.offset >= 0 && range.size > 0) {
+            ranges.push_back(range);
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(), [](const FileRange& left, const FileRange& right) {
+        return left.offset < right.offset;
+    });
+    for (const FileRange& range : ranges) {
+        if (!reads.empty()) {
+            FileRange& last = reads.back();
+            const int64_t lastEnd = last.offset + last.size;
+            const int64_t end = std::max(lastEnd, range.offset + range.size);
+            if (range.offset <= lastEnd + maxGap && (end - last.offset <= maxReadSize || range.offset < lastEnd)) {
+                // overlapping ranges are always merged: a range must lie inside of one read
+                last.size = end - last.offset;
+                continue;
+            }
+        }
+        reads.push_back(range);
+    }
+}
+
+void ReadCoalescer::load(const std::vector<FileRange>& ranges, const ReadFunction& read)
+{
+    coalesce(ranges, m_maxGap, m_maxReadSize, m_reads);
+    m_buffers.clear();
+    m_buffers.resize(m_reads.size());
+    for (size_t index = 0; index < m_reads.size(); ++index) {
+        m_buffers[index].resize(static_cast<size_t>(m_reads[index].size));
+        read(m_reads[index].offset, m_reads[index].size, m_buffers[index].data());
+    }
+}
+
+const uint8_t* ReadCoalescer::find(int64_t offset, int64_t size) const
+{
+    auto it = std::upper_bound(m_reads.begin(), m_reads.end(), offset,
+        [](int64_t value, const FileRange& read) {
+            return value < read.offset;
+        });
+    if (it == m_reads.begin()) {
+        return nullptr;
+    }
+    --it;
+    if (offset + size > it->offset + it->size) {
+        return nullptr;
+    }
+    const size_t index = static_cast<size_t>(it - m_reads.begin());
+    return m_buffers[index].data() + (offset - it->offset);
+}
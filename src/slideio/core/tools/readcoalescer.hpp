@@ -0,0 +1,51 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/core/slideio_core_def.hpp"
+#include "slideio/core/cvstructs.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    /**@brief Loads many small ranges of a file with a few large reads.
+     *
+     * The ranges requested for a batch (e.g. encoded tiles of a block) are sorted by offset.
+     * Overlapping ranges and ranges separated by less than the maximum gap are merged into
+     * one read. A merged read never exceeds the maximum read size unless a single range does.
+     * Decoders then take the data of the ranges from the loaded buffers without file access.
+     * The object is immutable after load and may be used from several threads.
+     */
+    class SLIDEIO_CORE_EXPORTS ReadCoalescer
+    {
+    public:
+        // reads "size" bytes of the file at "offset" into "data"
+        typedef std::function<void(int64_t offset, int64_t size, uint8_t* data)> ReadFunction;
+        explicit ReadCoalescer(int64_t maxGap = 64 * 1024, int64_t maxReadSize = 16 * 1024 * 1024);
+        void load(const std::vector<FileRange>& ranges, const ReadFunction& read);
+        // returns data of a range inside of a loaded read or nullptr
+        const uint8_t* find(int64_t offset, int64_t size) const;
+        size_t getReadCount() const {
+            return m_reads.size();
+        }
+        static void coalesce(const std::vector<FileRange>& ranges, int64_t maxGap, int64_t maxReadSize,
+            std::vector<FileRange>& reads);
+    private:
+        int64_t m_maxGap;
+        int64_t m_maxReadSize;
+        // sorted by offset, do not overlap
+        std::vector<FileRange> m_reads;
+        std::vector<std::vector<uint8_t>> m_buffers;
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
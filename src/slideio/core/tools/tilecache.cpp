@@ -0,0 +1,146 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/core/tools/tilecache.hpp"
+#include <boost/container_hash/hash.hpp>
+
+using namespace slideio;
+
+bool TileCacheKey::operator==(const TileCacheKey& other) const
+{
+    return level == other.level
+        && tileIndex == other.tileIndex
+        && zSlice == other.zSlice
+        && tFrame == other.tFrame
+        && reduction == other.reduction
+        && scene == other.scene
+        && channelIndices == other.channelIndices
+        && filePath == other.filePath;
+}
+
+size_t TileCacheKeyHash::operator()(const TileCacheKey& key) const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, key.filePath);
+    boost::hash_combine(seed, key.scene);
+    boost::hash_combine(seed, key.level);
+    boost::hash_combine(seed, key.tileIndex);
+    boost::hash_combine(seed, key.channelIndices);
+    boost::hash_combine(seed, key.zSlice);
+    boost::hash_combine(seed, key.tFrame);
+    boost::hash_combine(seed, key.reduction);
+    return seed;
+}
+
+TileCache& TileCache::instance()
+{
+    static TileCache cache;
+    return cache;
+}
+
+size_t TileCache::tileBytes(const cv::Mat& tile)
+{
+    return tile.total() * tile.elemSize();
+}
+
+void TileCache::setMaxSize(size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxSize = maxBytes;
+    evict(m_maxSize);
+}
+
+size_t TileCache::getMaxSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxSize;
+}
+
+size_t TileCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+size_t TileCache::getTileCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_items.size();
+}
+
+bool TileCache::isEnabled() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxSize > 0;
+}
+
+bool TileCache::get(const TileCacheKey& key, cv::Mat& tile)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return false;
+    }
+    // move the tile to the head of the list
+    m_items.splice(m_items.begin(), m_items, it->second);
+    tile = it->second->second;
+    ++m_hits;
+    return true;
+}
+
+void TileCache::put(const TileCacheKey& key, const cv::Mat& tile)
+{
+    const size_t bytes = tileBytes(tile);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (tile.empty() || bytes > m_maxSize) {
+        return;
+    }
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_size -= tileBytes(it->second->second);
+        m_items.erase(it->second);
+        m_index.erase(it);
+    }
+    evict(m_maxSize - bytes);
+    m_items.emplace_front(key, tile);
+    m_index[key] = m_items.begin();
+    m_size += bytes;
+}
+
+void TileCache::evict(size_t maxBytes)
+{
+    while (m_size > maxBytes && !m_items.empty()) {
+        const Item& item = m_items.back();
+        m_size -= tileBytes(item.second);
+        m_index.erase(item.first);
+        m_items.pop_back();
+    }
+}
+
+void TileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_items.clear();
+    m_size = 0;
+}
+
+uint64_t TileCache::getHits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t TileCache::getMisses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+void TileCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+}
@@ -0,0 +1,84 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/core/slideio_core_def.hpp"
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    struct SLIDEIO_CORE_EXPORTS TileCacheKey
+    {
+        std::string filePath;
+        // distinguishes scenes stored in the same file
+        int64_t scene = 0;
+        // zoom level or image directory index
+        int level = 0;
+        int tileIndex = 0;
+        std::vector<int> channelIndices;
+        int zSlice = 0;
+        int tFrame = 0;
+        // tiles decoded at a reduced resolution (see Tiler::readReducedTile)
+        int reduction = 1;
+        bool operator==(const TileCacheKey& other) const;
+    };
+
+    struct SLIDEIO_CORE_EXPORTS TileCacheKeyHash
+    {
+        size_t operator()(const TileCacheKey& key) const;
+    };
+
+    /**@brief Process-wide memory bounded LRU cache of decoded tiles.
+     *
+     * The cache is shared by all scenes of the process and is safe for concurrent use.
+     * Cached rasters are shared with the callers and must not be modified.
+     * The cache is disabled (zero budget) until setMaxSize is called with a positive value.
+     */
+    class SLIDEIO_CORE_EXPORTS TileCache
+    {
+    public:
+        static TileCache& instance();
+        void setMaxSize(size_t maxBytes);
+        size_t getMaxSize() const;
+        size_t getSize() const;
+        size_t getTileCount() const;
+        bool isEnabled() const;
+        bool get(const TileCacheKey& key, cv::Mat& tile);
+        void put(const TileCacheKey& key, const cv::Mat& tile);
+        void clear();
+        uint64_t getHits() const;
+        uint64_t getMisses() const;
+        void resetStatistics();
+    private:
+        TileCache() = default;
+        TileCache(const TileCache&) = delete;
+        TileCache& operator=(const TileCache&) = delete;
+        static size_t tileBytes(const cv::Mat& tile);
+        void evict(size_t maxBytes);
+    private:
+        typedef std::pair<TileCacheKey, cv::Mat> Item;
+        typedef std::list<Item> Items;
+        mutable std::mutex m_mutex;
+        Items m_items;
+        std::unordered_map<TileCacheKey, Items::iterator, TileCacheKeyHash> m_index;
+        size_t m_maxSize = 0;
+        size_t m_size = 0;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
@@ -4,9 +4,260 @@
 
 #include "slideio/core/tools/tilecomposer.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/utility.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <set>
 
 
+void slideio::Tiler::getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData)
+{
+    tileIndices.clear();
+    const int tileCount = getTileCount(userData);
+    for (int tileIndex = 0; tileIndex < tileCount; tileIndex++)
+    {
+        cv::Rect tileRect;
+        getTileRect(tileIndex, tileRect, userData);
+        if ((rect & tileRect).area() > 0) {
+            tileIndices.push_back(tileIndex);
+        }
+    }
+}
+
+bool slideio::Tiler::readTileRegion(int tileIndex, const std::vector<int>& channelIndices, const cv::Rect& region,
+                                    int reduction, cv::OutputArray tileRaster, void* userData)
+{
+    cv::Mat tile;
+    const bool read = reduction > 1
+        ? readReducedTile(tileIndex, channelIndices, reduction, tile, userData)
+        : readTile(tileIndex, channelIndices, tile, userData);
+    cv::Rect tileRect;
+    if (!read || tile.empty() || !getTileRect(tileIndex, tileRect, userData) || tileRect.empty()) {
+        return false;
+    }
+    // the raster may be reduced
+    cv::Rect part;
+    slideio::Tools::scaleRect(region, static_cast<double>(tile.cols) / static_cast<double>(tileRect.width),
+        static_cast<double>(tile.rows) / static_cast<double>(tileRect.height), part);
+    part &= cv::Rect(0, 0, tile.cols, tile.rows);
+    if (part.empty()) {
+        return false;
+    }
+    tile(part).copyTo(tileRaster);
+    return true;
+}
+
+void slideio::TileComposer::getGridTilesInRect(const cv::Rect& rect, const cv::Size& imageSize,
+                                               const cv::Size& tileSize, std::vector<int>& tileIndices)
+{
+    tileIndices.clear();
+    if (tileSize.width <= 0 || tileSize.height <= 0) {
+        return;
+    }
+    // edge tiles are padded to the full tile size
+    const int tilesX = (imageSize.width - 1) / tileSize.width + 1;
+    const int tilesY = (imageSize.height - 1) / tileSize.height + 1;
+    const cv::Rect gridRect(0, 0, tilesX * tileSize.width, tilesY * tileSize.height);
+    const cv::Rect validRect = rect & gridRect;
+    if (validRect.empty()) {
+        return;
+    }
+    const int firstX = validRect.x / tileSize.width;
+    const int firstY = validRect.y / tileSize.height;
+    const int lastX = (validRect.x + validRect.width - 1) / tileSize.width;
+    const int lastY = (validRect.y + validRect.height - 1) / tileSize.height;
+    tileIndices.reserve((lastX - firstX + 1) * (lastY - firstY + 1));
+    for (int tileY = firstY; tileY <= lastY; ++tileY) {
+        for (int tileX = firstX; tileX <= lastX; ++tileX) {
+            tileIndices.push_back(tileY * tilesX + tileX);
+        }
+    }
+}
+
+bool slideio::TileComposer::getDataRanges(Tiler* tiler, const cv::Rect& blockRect,
+                                          std::vector<FileRange>& ranges, void* userData)
+{
+    std::vector<int> tileIndices;
+    tiler->getTilesInRect(blockRect, tileIndices, userData);
+    bool reported = false;
+    for (const int tileIndex : tileIndices) {
+        FileRange range;
+        if (tiler->getTileDataRange(tileIndex, range, userData)) {
+            ranges.push_back(range);
+            reported = true;
+        }
+    }
+    return reported;
+}
+
+namespace
+{
+    std::atomic<bool> parallelReadingEnabled{true};
+    // bounds the number of decoded tiles held at once by a batch of blocks
+    const size_t MAX_BATCH_TILES = 256;
+
+    // The largest reduction (1, 2, 4 or 8) of tile resolution keeping at least the resolution
+    // of the block. Reduced reads are requested only from tilers supporting them.
+    int tileReduction(slideio::Tiler* tiler, double scaleX, double scaleY, void* userData)
+    {
+        const double scale = std::max(scaleX, scaleY);
+        if (scale <= 0 || scale * 2 > 1. || !tiler->supportsReducedReads(userData)) {
+            return 1;
+        }
+        int reduction = 2;
+        while (reduction < 8 && scale * reduction * 2 <= 1.) {
+            reduction *= 2;
+        }
+        return reduction;
+    }
+
+    // Reads a tile from the tile cache or from the tiler.
+    // Returns false if the tile does not contribute to the block.
+    bool readTileRaster(slideio::Tiler* tiler, int tileIndex, const cv::Rect& tileRect,
+                        const std::vector<int>& channelIndices, int reduction, void* userData, cv::Mat& tileRaster)
+    {
+        slideio::TileCache& cache = slideio::TileCache::instance();
+        slideio::TileCacheKey key;
+        const bool cacheable = cache.isEnabled() && tiler->getTileCacheKey(userData, key);
+        if (cacheable) {
+            key.tileIndex = tileIndex;
+            key.channelIndices = channelIndices;
+            key.reduction = reduction;
+        }
+        if (!cacheable || !cache.get(key, tileRaster)) {
+            const bool read = reduction > 1
+                ? tiler->readReducedTile(tileIndex, channelIndices, reduction, tileRaster, userData)
+                : tiler->readTile(tileIndex, channelIndices, tileRaster, userData);
+            if (read) {
+                if (cacheable) {
+                    cache.put(key, tileRaster);
+                }
+            }
+            else {
+                // fill tile with background color if the tile is not available
+                tiler->initializeBlock(tileRect.size(), channelIndices, tileRaster);
+            }
+        }
+        return !tileRaster.empty();
+    }
+
+    void scaleTile(const cv::Mat& tileRaster, const cv::Rect& tileRect, bool identityScale, double scaleX,
+                   double scaleY, cv::Mat& scaledTileRaster, cv::Rect& scaledTileRect)
+    {
+        if (identityScale) {
+            scaledTileRect = tileRect;
+            scaledTileRaster = tileRaster;
+        }
+        else {
+            slideio::Tools::scaleRect(tileRect, scaleX, scaleY, scaledTileRect);
+            cv::resize(tileRaster, scaledTileRaster, scaledTileRect.size());
+        }
+    }
+
+    // Reads a tile and scales it to the block resolution.
+    // Returns false if the tile does not contribute to the block.
+    bool readScaledTile(slideio::Tiler* tiler, int tileIndex, const cv::Rect& tileRect, const cv::Rect& blockRect,
+                        const std::vector<int>& channelIndices, bool identityScale, double scaleX, double scaleY,
+                        int reduction, bool regionReads, void* userData, cv::Mat& scaledTileRaster,
+                        cv::Rect& scaledTileRect)
+    {
+        cv::Mat tileRaster;
+        const cv::Rect visibleRect = tileRect & blockRect;
+        if (regionReads && visibleRect != tileRect) {
+            // only the part of the tile inside the block is decoded
+            if (!tiler->readTileRegion(tileIndex, channelIndices, visibleRect - tileRect.tl(), reduction,
+                tileRaster, userData)) {
+                tiler->initializeBlock(visibleRect.size(), channelIndices, tileRaster);
+            }
+            if (tileRaster.empty()) {
+                return false;
+            }
+            scaleTile(tileRaster, visibleRect, identityScale, scaleX, scaleY, scaledTileRaster, scaledTileRect);
+            return true;
+        }
+        if (!readTileRaster(tiler, tileIndex, tileRect, channelIndices, reduction, userData, tileRaster)) {
+            return false;
+        }
+        scaleTile(tileRaster, tileRect, identityScale, scaleX, scaleY, scaledTileRaster, scaledTileRect);
+        return true;
+    }
+
+    void copyScaledTile(const cv::Mat& scaledTileRaster, const cv::Rect& scaledTileRect,
+                        const cv::Rect& scaledBlockRect, cv::Mat& scaledBlockRaster)
+    {
+        // compute intersection of scaled tile rectangle and scaled block rectangle
+        const cv::Rect scaledIntersectionRect = scaledBlockRect & scaledTileRect;
+        if (!scaledIntersectionRect.empty()) {
+            const cv::Rect blockPart = scaledIntersectionRect - scaledBlockRect.tl();
+            const cv::Rect tilePart = scaledIntersectionRect - scaledTileRect.tl();
+            cv::Mat blockPartRaster(scaledBlockRaster, blockPart);
+            cv::Mat tilePartRaster(scaledTileRaster, tilePart);
+            tilePartRaster.copyTo(blockPartRaster);
+        }
+    }
+
+    // Hands the valid tiles of a block to the tiler in the order of their file offsets.
+    void prefetchTiles(slideio::Tiler* tiler, const std::vector<int>& tileIndices, const std::vector<uchar>& validTiles,
+                       const std::vector<int>& channelIndices, void* userData)
+    {
+        std::vector<std::pair<int64_t, int>> orderedTiles;
+        for (size_t index = 0; index < tileIndices.size(); ++index) {
+            if (validTiles[index]) {
+                slideio::FileRange range;
+                const int tileIndex = tileIndices[index];
+                orderedTiles.emplace_back(tiler->getTileDataRange(tileIndex, range, userData) ? range.offset : tileIndex,
+                    tileIndex);
+            }
+        }
+        if (orderedTiles.size() < 2) {
+            return;
+        }
+        std::stable_sort(orderedTiles.begin(), orderedTiles.end(),
+            [](const std::pair<int64_t, int>& left, const std::pair<int64_t, int>& right) {
+                return left.first < right.first;
+            });
+        std::vector<int> tiles(orderedTiles.size());
+        std::transform(orderedTiles.begin(), orderedTiles.end(), tiles.begin(),
+            [](const std::pair<int64_t, int>& tile) { return tile.second; });
+        tiler->prefetchTiles(tiles, channelIndices, userData);
+    }
+
+    // Decodes a tile straight into its part of the block raster.
+    // The part must be a continuous memory area unless the tiler supports strided output.
+    void readTileInPlace(slideio::Tiler* tiler, int tileIndex, const cv::Rect& tileRect,
+                         const std::vector<int>& channelIndices, const cv::Rect& blockRect,
+                         void* userData, cv::Mat& blockRaster)
+    {
+        const cv::Rect blockPart = tileRect - blockRect.tl();
+        cv::Mat tileRaster(blockRaster, blockPart);
+        const uchar* target = tileRaster.data;
+        if (!tiler->readTile(tileIndex, channelIndices, tileRaster, userData)) {
+            tileRaster = cv::Mat(blockRaster, blockPart);
+            tiler->initializeBlock(tileRect.size(), channelIndices, tileRaster);
+        }
+        if (tileRaster.data != target && !tileRaster.empty()) {
+            // the tiler replaced the raster instead of filling it
+            copyScaledTile(tileRaster, tileRect, blockRect, blockRaster);
+        }
+    }
+}
+
+void slideio::TileComposer::setParallelReading(bool enable)
+{
+    parallelReadingEnabled = enable;
+}
+
+bool slideio::TileComposer::isParallelReadingEnabled()
+{
+    return parallelReadingEnabled;
+}
 
 void slideio::TileComposer::composeRect(slideio::Tiler* tiler,
                                         const std::vector<int>& channelIndices,
@@ -15,54 +266,274 @@ void slideio::TileComposer::composeRect(slideio::Tiler* tiler,
                                         cv::OutputArray output,
                                         void *userData)
 {
-    const bool tileTest = false;
-    const int tileCount = tiler->getTileCount(userData);
-    const int channelCount = static_cast<int>(channelIndices.size());
-    const cv::Point blockOrigin = blockRect.tl();
     const double scaleX = static_cast<double>(blockSize.width)/static_cast<double>(blockRect.width);
     const double scaleY = static_cast<double>(blockSize.height)/static_cast<double>(blockRect.height);
+    const bool identityScale = blockSize == blockRect.size();
+    const int reduction = identityScale ? 1 : tileReduction(tiler, scaleX, scaleY, userData);
     cv::Rect scaledBlockRect;
     slideio::Tools::scaleRect(blockRect, blockSize, scaledBlockRect);
     tiler->initializeBlock(blockSize, channelIndices, output);
     cv::Mat scaledBlockRaster = output.getMat();
-    for(int tileIndex = 0; tileIndex<tileCount; tileIndex++)
+    std::vector<int> tileIndices;
+    tiler->getTilesInRect(blockRect, tileIndices, userData);
+    const int tileCount = static_cast<int>(tileIndices.size());
+    std::vector<cv::Rect> tileRects(tileCount);
+    std::vector<uchar> validTiles(tileCount, 0);
+    for(int index = 0; index < tileCount; ++index)
     {
-        cv::Rect tileRect;
-        tiler->getTileRect(tileIndex, tileRect, userData);
-        cv::Rect intersection = blockRect & tileRect;
-        if(intersection.area()>0)
+        tiler->getTileRect(tileIndices[index], tileRects[index], userData);
+        validTiles[index] = (blockRect & tileRects[index]).area() > 0 ? 1 : 0;
+    }
+    // Without scaling a tile inside the block is decoded directly into the block if the
+    // tiler writes strided views or the tile covers whole rows of the block (continuous part).
+    // Cached tiles are shared and always get their own raster.
+    slideio::TileCacheKey cacheKey;
+    const bool cacheable = slideio::TileCache::instance().isEnabled() && tiler->getTileCacheKey(userData, cacheKey);
+    const bool regionReads = !cacheable && tiler->supportsRegionReads(userData);
+    const bool inPlace = identityScale && !cacheable && scaledBlockRaster.isContinuous();
+    const bool stridedOutput = inPlace && tiler->supportsStridedOutput(userData);
+    auto isInPlaceTile = [&](int index) {
+        const cv::Rect& tileRect = tileRects[index];
+        return inPlace && (tileRect & blockRect) == tileRect
+            && (stridedOutput || tileRect.width == blockRect.width || tileRect.height == 1);
+    };
+    // cached tiles must not be read again: prefetching is left to tilers without cache
+    if(!cacheable) {
+        prefetchTiles(tiler, tileIndices, validTiles, channelIndices, userData);
+    }
+    const bool parallel = tileCount > 1 && isParallelReadingEnabled() && cv::getNumThreads() > 1
+        && tiler->supportsConcurrentReads(userData);
+    if(!parallel)
+    {
+        for(int index = 0; index < tileCount; ++index)
         {
-            cv::Mat tileRaster;
-            if(tileTest)
+            if(!validTiles[index]) {
+                continue;
+            }
+            if(isInPlaceTile(index))
             {
-                tileRaster.create(tileRect.size(), CV_MAKETYPE(CV_8U,1));
-                cv::rectangle(tileRaster, cv::Point(0, 0), cv::Point(tileRect.width-1, tileRect.height-1), 0, cv::LINE_4);
+                readTileInPlace(tiler, tileIndices[index], tileRects[index], channelIndices, blockRect,
+                    userData, scaledBlockRaster);
+                continue;
             }
-            else
+            cv::Mat scaledTileRaster;
+            cv::Rect scaledTileRect;
+            if(readScaledTile(tiler, tileIndices[index], tileRects[index], blockRect, channelIndices, identityScale,
+                scaleX, scaleY, reduction, regionReads, userData, scaledTileRaster, scaledTileRect))
             {
-                if(!tiler->readTile(tileIndex, channelIndices, tileRaster, userData))
+                copyScaledTile(scaledTileRaster, scaledTileRect, scaledBlockRect, scaledBlockRaster);
+            }
+        }
+        return;
+    }
+    // Tiles are decoded and scaled on the OpenCV worker pool. Copying into the block
+    // is kept in tile order: scaled neighbours may share a border pixel and mosaic
+    // tiles may overlap, so the result is the same as for sequential reading.
+    // Tiles decoded in place do not overlap other tiles and need no ordering.
+    std::vector<uchar> inPlaceTiles(tileCount, 0);
+    for(int index = 0; index < tileCount; ++index)
+    {
+        if(!validTiles[index] || !isInPlaceTile(index)) {
+            continue;
+        }
+        bool overlapped = false;
+        for(int other = 0; other < tileCount && !overlapped; ++other)
+        {
+            overlapped = other != index && validTiles[other] && (tileRects[index] & tileRects[other]).area() > 0;
+        }
+        inPlaceTiles[index] = overlapped ? 0 : 1;
+    }
+    std::vector<cv::Mat> scaledTileRasters(tileCount);
+    std::vector<cv::Rect> scaledTileRects(tileCount);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    cv::parallel_for_(cv::Range(0, tileCount), [&](const cv::Range& range) {
+        for(int index = range.start; index < range.end; ++index)
+        {
+            if(!validTiles[index]) {
+                continue;
+            }
+            try
+            {
+                if(inPlaceTiles[index])
                 {
-                    // fill tile with background color if the tile is not available
-                    tiler->initializeBlock(tileRect.size(), channelIndices, tileRaster);
+                    readTileInPlace(tiler, tileIndices[index], tileRects[index], channelIndices, blockRect,
+                        userData, scaledBlockRaster);
+                    validTiles[index] = 0;
+                }
+                else
+                {
+                    validTiles[index] = readScaledTile(tiler, tileIndices[index], tileRects[index], blockRect,
+                        channelIndices, identityScale, scaleX, scaleY, reduction, regionReads, userData,
+                        scaledTileRasters[index], scaledTileRects[index]) ? 1 : 0;
                 }
             }
-            if(!tileRaster.empty())
+            catch(...)
             {
-                cv::Rect scaledTileRect;
-                slideio::Tools::scaleRect(tileRect, scaleX, scaleY, scaledTileRect);
-                // scale tile raster
-                cv::Mat scaledTileRaster;
-                cv::resize(tileRaster, scaledTileRaster, scaledTileRect.size());
-                // compute intersection of scaled tile rectangle and scaled block rectangle
-                cv::Rect scaledIntersectionRect = scaledBlockRect & scaledTileRect;
-                if(!scaledIntersectionRect.empty()) {
-                    const cv::Rect blockPart = scaledIntersectionRect - scaledBlockRect.tl();
-                    const cv::Rect tilePart = scaledIntersectionRect - scaledTileRect.tl();
-                    cv::Mat blockPartRaster(scaledBlockRaster, blockPart);
-                    cv::Mat tilePartRaster(scaledTileRaster, tilePart);
-                    tilePartRaster.copyTo(blockPartRaster);
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    });
+    if(error) {
+        std::rethrow_exception(error);
+    }
+    for(int index = 0; index < tileCount; ++index)
+    {
+        if(validTiles[index]) {
+            copyScaledTile(scaledTileRasters[index], scaledTileRects[index], scaledBlockRect, scaledBlockRaster);
+        }
+    }
+}
+
+void slideio::TileComposer::composeRects(Tiler* tiler, const std::vector<int>& channelIndices,
+                                         const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+                                         std::vector<cv::Mat>& blockRasters, void* userData)
+{
+    const int blockCount = static_cast<int>(blockRects.size());
+    blockRasters.resize(blockCount);
+    // tiles contributing to every block in ascending order and the order of tiles in the file
+    std::vector<std::vector<int>> blockTiles(blockCount);
+    std::map<int, cv::Rect> tileRects;
+    std::map<int, int64_t> tileOrder;
+    for (int block = 0; block < blockCount; ++block) {
+        std::vector<int> tileIndices;
+        tiler->getTilesInRect(blockRects[block], tileIndices, userData);
+        for (const int tileIndex : tileIndices) {
+            auto it = tileRects.find(tileIndex);
+            if (it == tileRects.end()) {
+                cv::Rect tileRect;
+                tiler->getTileRect(tileIndex, tileRect, userData);
+                it = tileRects.emplace(tileIndex, tileRect).first;
+                FileRange range;
+                tileOrder[tileIndex] = tiler->getTileDataRange(tileIndex, range, userData) ? range.offset : tileIndex;
+            }
+            if ((blockRects[block] & it->second).area() > 0) {
+                blockTiles[block].push_back(tileIndex);
+            }
+        }
+    }
+    // blocks follow the file position of their first tile: a batch of scattered
+    // rectangles is read in one forward pass over the file
+    std::vector<int64_t> blockOrder(blockCount, std::numeric_limits<int64_t>::max());
+    for (int block = 0; block < blockCount; ++block) {
+        for (const int tileIndex : blockTiles[block]) {
+            blockOrder[block] = std::min(blockOrder[block], tileOrder[tileIndex]);
+        }
+    }
+    std::vector<int> blocks(blockCount);
+    std::iota(blocks.begin(), blocks.end(), 0);
+    std::stable_sort(blocks.begin(), blocks.end(), [&blockOrder](int left, int right) {
+        return blockOrder[left] < blockOrder[right];
+    });
+    slideio::TileCacheKey cacheKey;
+    const bool cacheable = slideio::TileCache::instance().isEnabled() && tiler->getTileCacheKey(userData, cacheKey);
+    const bool parallel = isParallelReadingEnabled() && cv::getNumThreads() > 1;
+    const bool parallelTiles = parallel && tiler->supportsConcurrentReads(userData);
+
+    auto composeGroup = [&](const std::vector<int>& groupBlocks, const std::set<int>& groupTiles) {
+        // every tile of the group is decoded once, in the file order
+        std::vector<int> tiles(groupTiles.begin(), groupTiles.end());
+        std::stable_sort(tiles.begin(), tiles.end(), [&tileOrder](int left, int right) {
+            return tileOrder[left] < tileOrder[right];
+        });
+        const int tileCount = static_cast<int>(tiles.size());
+        if (!cacheable && tileCount > 1) {
+            tiler->prefetchTiles(tiles, channelIndices, userData);
+        }
+        // shared tiles are decoded once at the resolution needed by the most detailed block
+        int reduction = 8;
+        for (const int block : groupBlocks) {
+            const cv::Rect& blockRect = blockRects[block];
+            const double scaleX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
+            const double scaleY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
+            const int blockReduction = blockSize == blockRect.size() ? 1 : tileReduction(tiler, scaleX, scaleY, userData);
+            reduction = std::min(reduction, blockReduction);
+        }
+        std::vector<cv::Mat> tileRasters(tileCount);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto readTiles = [&](const cv::Range& range) {
+            for (int index = range.start; index < range.end; ++index) {
+                try {
+                    const int tileIndex = tiles[index];
+                    readTileRaster(tiler, tileIndex, tileRects.at(tileIndex), channelIndices, reduction, userData,
+                        tileRasters[index]);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
                 }
             }
+        };
+        if (parallelTiles && tileCount > 1) {
+            cv::parallel_for_(cv::Range(0, tileCount), readTiles);
+        }
+        else {
+            readTiles(cv::Range(0, tileCount));
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        std::map<int, int> tilePositions;
+        for (int index = 0; index < tileCount; ++index) {
+            tilePositions[tiles[index]] = index;
+        }
+        for (const int block : groupBlocks) {
+            tiler->initializeBlock(blockSize, channelIndices, blockRasters[block]);
         }
+        // blocks are independent: copying and scaling of tiles runs in parallel
+        // for any tiler. Tiles of a block are copied in ascending order as in composeRect.
+        auto composeBlocks = [&](const cv::Range& range) {
+            for (int position = range.start; position < range.end; ++position) {
+                const int block = groupBlocks[position];
+                const cv::Rect& blockRect = blockRects[block];
+                const double scaleX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
+                const double scaleY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
+                const bool identityScale = blockSize == blockRect.size();
+                cv::Rect scaledBlockRect;
+                slideio::Tools::scaleRect(blockRect, blockSize, scaledBlockRect);
+                for (const int tileIndex : blockTiles[block]) {
+                    const cv::Mat& tileRaster = tileRasters[tilePositions.at(tileIndex)];
+                    if (tileRaster.empty()) {
+                        continue;
+                    }
+                    cv::Mat scaledTileRaster;
+                    cv::Rect scaledTileRect;
+                    scaleTile(tileRaster, tileRects.at(tileIndex), identityScale, scaleX, scaleY,
+                        scaledTileRaster, scaledTileRect);
+                    copyScaledTile(scaledTileRaster, scaledTileRect, scaledBlockRect, blockRasters[block]);
+                }
+            }
+        };
+        const int groupCount = static_cast<int>(groupBlocks.size());
+        if (parallel && groupCount > 1) {
+            cv::parallel_for_(cv::Range(0, groupCount), composeBlocks);
+        }
+        else {
+            composeBlocks(cv::Range(0, groupCount));
+        }
+    };
+
+    std::vector<int> groupBlocks;
+    std::set<int> groupTiles;
+    for (const int block : blocks) {
+        std::set<int> extendedTiles(groupTiles);
+        extendedTiles.insert(blockTiles[block].begin(), blockTiles[block].end());
+        if (!groupBlocks.empty() && extendedTiles.size() > MAX_BATCH_TILES) {
+            composeGroup(groupBlocks, groupTiles);
+            groupBlocks.clear();
+            extendedTiles.clear();
+            extendedTiles.insert(blockTiles[block].begin(), blockTiles[block].end());
+        }
+        groupBlocks.push_back(block);
+        groupTiles.swap(extendedTiles);
+    }
+    if (!groupBlocks.empty()) {
+        composeGroup(groupBlocks, groupTiles);
     }
 }
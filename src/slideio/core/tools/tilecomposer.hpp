@@ -5,10 +5,12 @@
 #define OPENCV_slideio_tilecomposer_HPP
 
 #include "slideio/core/slideio_core_def.hpp"
+#include "slideio/core/cvstructs.hpp"
 #include <opencv2/core.hpp>
 
 namespace slideio
 {
+    struct TileCacheKey;
     class SLIDEIO_CORE_EXPORTS Tiler
     {
     public:
@@ -17,12 +19,69 @@ namespace slideio
         virtual bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) = 0;
         virtual bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster, void* userData) = 0;
         virtual void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output) = 0;
+        // Collects indices of tiles intersecting the rectangle in ascending order.
+        // Default implementation scans all tiles; tilers with a regular grid or
+        // a spatial index should override it.
+        virtual void getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData);
+        // Returns true if readTile may be called from several threads at once
+        // for the same userData. Enables parallel tile decoding in TileComposer.
+        virtual bool supportsConcurrentReads(void* userData) { return false; }
+        // Fills the file and level part of the key identifying decoded tiles in TileCache.
+        // Tilers that return false are not cached.
+        virtual bool getTileCacheKey(void* userData, TileCacheKey& key) { return false; }
+        // Returns true if readTile fills a preallocated output raster with a row stride
+        // (a view of the block raster) instead of assuming continuous memory.
+        // Lets TileComposer decode tiles lying inside the block directly into the block.
+        virtual bool supportsStridedOutput(void* userData) { return false; }
+        // Fills the file range holding encoded data of the tile for read-ahead hints.
+        // Tilers that return false do not report data locations.
+        virtual bool getTileDataRange(int tileIndex, FileRange& range, void* userData) { return false; }
+        // Called by TileComposer with the tiles a block is about to read (in the order of their file offsets).
+        // Tilers reading tiles from a file may load their data with a few large reads
+        // (see ReadCoalescer) and keep it in userData for readTile.
+        virtual void prefetchTiles(const std::vector<int>& tileIndices, const std::vector<int>& channelIndices,
+            void* userData) {}
+        // Returns true if readReducedTile decodes tiles at a reduced resolution
+        // (e.g. jpeg DCT scaling). TileComposer then requests reduced tiles for downscaled blocks.
+        virtual bool supportsReducedReads(void* userData) { return false; }
+        // Reads the tile at 1/reduction of its resolution (reduction is 2, 4 or 8).
+        // The raster may be of any size between the reduced and the full tile size:
+        // TileComposer scales it to the block resolution. Default implementation reads the full tile.
+        virtual bool readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+            cv::OutputArray tileRaster, void* userData) {
+            return readTile(tileIndex, channelIndices, tileRaster, userData);
+        }
+        // Returns true if readTileRegion decodes a part of a tile cheaper than the whole tile
+        // (e.g. jpeg 2000 code blocks). TileComposer then decodes only the parts of not cached tiles
+        // lying inside the block.
+        virtual bool supportsRegionReads(void* userData) { return false; }
+        // Reads the region of the tile (in tile coordinates at full resolution) at 1/reduction
+        // of its resolution. Default implementation crops the tile read by readTile/readReducedTile.
+        virtual bool readTileRegion(int tileIndex, const std::vector<int>& channelIndices, const cv::Rect& region,
+            int reduction, cv::OutputArray tileRaster, void* userData);
     };
     class SLIDEIO_CORE_EXPORTS TileComposer
     {
     public:
         static void composeRect(Tiler* tiler, const std::vector<int>& channelIndices,
             const cv::Rect& blockRect, const cv::Size& blockSize, cv::OutputArray output, void* userData = nullptr);
+        // Composes a batch of blocks of the same size. Tiles shared by several blocks are
+        // decoded once, tiles are read in the order of their file offsets (see Tiler::getTileDataRange)
+        // and blocks are filled on the OpenCV thread pool. Preallocated block rasters of
+        // the right size and type are filled in place.
+        static void composeRects(Tiler* tiler, const std::vector<int>& channelIndices,
+            const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize, std::vector<cv::Mat>& blockRasters,
+            void* userData = nullptr);
+        static void getGridTilesInRect(const cv::Rect& rect, const cv::Size& imageSize, const cv::Size& tileSize,
+            std::vector<int>& tileIndices);
+        // Collects file ranges of the tiles composing the block. Returns false if the tiler
+        // does not report data locations.
+        static bool getDataRanges(Tiler* tiler, const cv::Rect& blockRect, std::vector<FileRange>& ranges,
+            void* userData = nullptr);
+        // Tiles of a block are decoded on the OpenCV thread pool (cv::setNumThreads)
+        // if the tiler supports concurrent reads. Enabled by default.
+        static void setParallelReading(bool enable);
+        static bool isParallelReadingEnabled();
     };
 }
 
@@ -0,0 +1,81 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/core/tools/tileindex.hpp"
+#include <algorithm>
+
+using namespace slideio;
+
+int TileIndex::cellIndex(int coord, int cellSize)
+{
+    // floor division: mosaic tiles may have negative coordinates
+    return coord >= 0 ? coord / cellSize : -((-coord + cellSize - 1) / cellSize);
+}
+
+void TileIndex::addTile(int tileIndex, const cv::Rect& tileRect)
+{
+    if (tileRect.empty()) {
+        return;
+    }
+    if (m_cells.empty()) {
+        m_cellSize = tileRect.size();
+    }
+    if (tileIndex >= static_cast<int>(m_rects.size())) {
+        m_rects.resize(tileIndex + 1);
+    }
+    m_rects[tileIndex] = tileRect;
+    const int firstX = cellIndex(tileRect.x, m_cellSize.width);
+    const int firstY = cellIndex(tileRect.y, m_cellSize.height);
+    const int lastX = cellIndex(tileRect.x + tileRect.width - 1, m_cellSize.width);
+    const int lastY = cellIndex(tileRect.y + tileRect.height - 1, m_cellSize.height);
+    for (int cellY = firstY; cellY <= lastY; ++cellY) {
+        for (int cellX = firstX; cellX <= lastX; ++cellX) {
+            m_cells[cellKey(cellX, cellY)].push_back(tileIndex);
+        }
+    }
+}
+
+void TileIndex::findTiles(const cv::Rect& rect, std::vector<int>& tileIndices) const
+{
+    tileIndices.clear();
+    if (rect.empty() || m_cells.empty()) {
+        return;
+    }
+    const int firstX = cellIndex(rect.x, m_cellSize.width);
+    const int firstY = cellIndex(rect.y, m_cellSize.height);
+    const int lastX = cellIndex(rect.x + rect.width - 1, m_cellSize.width);
+    const int lastY = cellIndex(rect.y + rect.height - 1, m_cellSize.height);
+    const int64_t cellCount = static_cast<int64_t>(lastX - firstX + 1) * static_cast<int64_t>(lastY - firstY + 1);
+    if (cellCount >= static_cast<int64_t>(m_rects.size())) {
+        // the request covers most of the image: plain scan is cheaper
+        const int tileCount = static_cast<int>(m_rects.size());
+        for (int tileIndex = 0; tileIndex < tileCount; ++tileIndex) {
+            if ((m_rects[tileIndex] & rect).area() > 0) {
+                tileIndices.push_back(tileIndex);
+            }
+        }
+    }
+    else {
+        for (int cellY = firstY; cellY <= lastY; ++cellY) {
+            for (int cellX = firstX; cellX <= lastX; ++cellX) {
+                auto it = m_cells.find(cellKey(cellX, cellY));
+                if (it != m_cells.end()) {
+                    tileIndices.insert(tileIndices.end(), it->second.begin(), it->second.end());
+                }
+            }
+        }
+        std::sort(tileIndices.begin(), tileIndices.end());
+        tileIndices.erase(std::unique(tileIndices.begin(), tileIndices.end()), tileIndices.end());
+        // drop tiles that share a bucket with the request but do not intersect it
+        tileIndices.erase(std::remove_if(tileIndices.begin(), tileIndices.end(),
+            [this, &rect](int tileIndex) { return (m_rects[tileIndex] & rect).area() <= 0; }),
+            tileIndices.end());
+    }
+}
+
+void TileIndex::clear()
+{
+    m_cells.clear();
+    m_rects.clear();
+    m_cellSize = cv::Size();
+}
@@ -0,0 +1,49 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/core/slideio_core_def.hpp"
+#include <opencv2/core.hpp>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    /**@brief Spatial index for irregular tile layouts (mosaics, cached stripes).
+     *
+     * Tile rectangles are distributed into buckets of a regular grid.
+     * The bucket size is taken from the first added tile. A lookup
+     * visits only the buckets covered by the query rectangle and returns
+     * intersecting tile indices in ascending order, so the result is the
+     * same as a linear scan over all tiles.
+     */
+    class SLIDEIO_CORE_EXPORTS TileIndex
+    {
+    public:
+        TileIndex() = default;
+        void addTile(int tileIndex, const cv::Rect& tileRect);
+        void findTiles(const cv::Rect& rect, std::vector<int>& tileIndices) const;
+        void clear();
+        bool empty() const {
+            return m_cells.empty();
+        }
+    private:
+        static int64_t cellKey(int cellX, int cellY) {
+            return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(cellY)) << 32) | static_cast<uint32_t>(cellX));
+        }
+        static int cellIndex(int coord, int cellSize);
+    private:
+        cv::Size m_cellSize;
+        std::unordered_map<int64_t, std::vector<int>> m_cells;
+        std::vector<cv::Rect> m_rects;
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
@@ -10,6 +10,7 @@
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include "slideio/base/exceptions.hpp"
+#include "slideio/imagetools/cvtools.hpp"
 #if defined(WIN32)
 #include <Shlwapi.h>
 #else
@@ -144,21 +145,7 @@ std::list<std::string> Tools::findFilesWithExtension(const std::string& director
 
 void Tools::extractChannels(const cv::Mat& sourceRaster, const std::vector<int>& channels, cv::OutputArray output)
 {
-    if (channels.empty()) {
-        sourceRaster.copyTo(output);
-    }
-    else {
-        const int rasterChannelCount = sourceRaster.channels();
-        const int numChannels = static_cast<int>(channels.size());
-        std::vector<cv::Mat> channelRasters(numChannels);
-        for (int channel = 0; channel < numChannels; ++channel) {
-            if(channel >= rasterChannelCount) {
-                RAISE_RUNTIME_ERROR << "Attempt to extract channel " << channel << " from " << rasterChannelCount << " channels.";
-            }
-            cv::extractChannel(sourceRaster, channelRasters[channel], channels[channel]);
-        }
-        cv::merge(channelRasters, output);
-    }
+    CVTools::extractChannels(sourceRaster, channels, output);
 }
 
 FILE* Tools::openFile(const std::string& filePath, const char* mode)
@@ -7,9 +7,13 @@
 #include "slideio/drivers/czi/czislide.hpp"
 #include "slideio/core/tools/tilecomposer.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/imagetools/imagetools.hpp"
+#include "slideio/base/scratchbuffer.hpp"
 #include <set>
 #include <functional>
+#include <exception>
+#include <mutex>
 
 using namespace slideio;
 const double DOUBLE_EPSILON = 1.e-4;
@@ -137,6 +141,58 @@ void CZIScene::readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv:
     TileComposer::composeRect(this, componentIndices, zoomLevelRect, blockSize, output, &userData);
 }
 
+void CZIScene::readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect,
+    const std::vector<int>& channelIndices, int zSliceIndex, int tFrameIndex, cv::OutputArray output)
+{
+    TilerData userData;
+    userData.zoomLevelIndex = zoomLevel;
+    userData.relativeZoom = 1.;
+    userData.zSliceIndex = zSliceIndex + m_firstSliceIndex;
+    userData.tFrameIndex = tFrameIndex + m_firstTFrameIndex;
+    TileComposer::composeRect(this, channelIndices, levelRect, levelRect.size(), output, &userData);
+}
+
+void CZIScene::readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+    const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters)
+{
+    // blocks are grouped by the zoom level they are read from
+    const std::vector<ZoomLevel>& zoomLevels = m_zoomLevels;
+    std::map<int, std::vector<int>> levelBlocks;
+    std::map<int, double> levelMaxZoom;
+    std::vector<cv::Rect> zoomLevelRects(blockRects.size());
+    for (size_t block = 0; block < blockRects.size(); ++block) {
+        const cv::Rect& blockRect = blockRects[block];
+        const double zoomX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
+        const double zoomY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
+        const double zoom = std::max(zoomX, zoomY);
+        const int levelIndex = Tools::findZoomLevel(zoom, static_cast<int>(m_zoomLevels.size()), [&zoomLevels](int index){
+            return zoomLevels[index].zoom;
+        });
+        const double levelZoom = zoomLevels[levelIndex].zoom;
+        Tools::scaleRect(blockRect, levelZoom, levelZoom, zoomLevelRects[block]);
+        levelBlocks[levelIndex].push_back(static_cast<int>(block));
+        levelMaxZoom[levelIndex] = std::max(levelMaxZoom[levelIndex], zoom);
+    }
+    for (const auto& level : levelBlocks) {
+        TilerData userData;
+        userData.zoomLevelIndex = level.first;
+        userData.relativeZoom = zoomLevels[level.first].zoom / levelMaxZoom[level.first];
+        userData.zSliceIndex = m_firstSliceIndex;
+        userData.tFrameIndex = m_firstTFrameIndex;
+        const std::vector<int>& blocks = level.second;
+        std::vector<cv::Rect> rects(blocks.size());
+        std::vector<cv::Mat> rasters(blocks.size());
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            rects[index] = zoomLevelRects[blocks[index]];
+            rasters[index] = blockRasters[blocks[index]];
+        }
+        TileComposer::composeRects(this, channelIndices, rects, blockSize, rasters, &userData);
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            blockRasters[blocks[index]] = rasters[index];
+        }
+    }
+}
+
 std::string CZIScene::getName() const
 {
     return m_name;
@@ -196,9 +252,12 @@ void CZIScene::updateTileRects()
 void CZIScene::updateTileRects(ZoomLevel& zoomLevel)
 {
     std::vector<Tile>& tiles = zoomLevel.tiles;
-    for(auto& tile: tiles) {
+    zoomLevel.tileIndex.clear();
+    for(int index = 0; index < static_cast<int>(tiles.size()); ++index) {
+        Tile& tile = tiles[index];
         tile.rect.x = lround(zoomLevel.zoom*(tile.rect.x-m_sceneRect.x));
         tile.rect.y = lround(zoomLevel.zoom*(tile.rect.y-m_sceneRect.y));
+        zoomLevel.tileIndex.addTile(index, tile.rect);
     }
 }
 
@@ -354,6 +413,57 @@ bool CZIScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userData)
     return true;
 }
 
+bool CZIScene::supportsConcurrentReads(void* userData)
+{
+    // sub-blocks are read with positioned reads of the slide file, scene data is immutable after init
+    return true;
+}
+
+void CZIScene::getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData)
+{
+    const TilerData* tilerData = static_cast<TilerData*>(userData);
+    const ZoomLevel& zoomLevel = m_zoomLevels[tilerData->zoomLevelIndex];
+    zoomLevel.tileIndex.findTiles(rect, tileIndices);
+}
+
+bool CZIScene::getTileCacheKey(void* userData, TileCacheKey& key)
+{
+    const TilerData* tilerData = static_cast<TilerData*>(userData);
+    key.filePath = m_filePath;
+    key.scene = static_cast<int64_t>(m_id);
+    key.level = tilerData->zoomLevelIndex;
+    key.zSlice = tilerData->zSliceIndex;
+    key.tFrame = tilerData->tFrameIndex;
+    return true;
+}
+
+
+void CZIScene::prefetchTiles(const std::vector<int>& tileIndices, const std::vector<int>& channelIndices,
+    void* userData)
+{
+    TilerData* tilerData = static_cast<TilerData*>(userData);
+    const std::vector<int> componentIndices = Tools::completeChannelList(channelIndices, getNumChannels());
+    const CZISubBlocks& blocks = getBlocks(tilerData);
+    std::vector<FileRange> ranges;
+    for (const int tileIndex : tileIndices) {
+        const Tile& tile = getTile(tilerData, tileIndex);
+        for (const int blockIndex : tile.blockIndices) {
+            const CZISubBlock& block = blocks[blockIndex];
+            if (blockHasData(block, componentIndices, tilerData)) {
+                FileRange range;
+                range.offset = static_cast<int64_t>(block.dataPosition());
+                range.size = static_cast<int64_t>(block.dataSize());
+                ranges.push_back(range);
+            }
+        }
+    }
+    // neighbouring sub-blocks are stored one after another: a block is read with a few large reads
+    std::shared_ptr<ReadCoalescer> reads = std::make_shared<ReadCoalescer>();
+    reads->load(ranges, [this](int64_t offset, int64_t size, uint8_t* data) {
+        m_slide->readBlock(static_cast<uint64_t>(offset), static_cast<uint64_t>(size), data);
+    });
+    tilerData->reads = reads;
+}
 
 int CZIScene::findBlockIndex(const Tile& tile, const CZISubBlocks& blocks, int channelIndex, int zSliceIndex, int tFrameIndex) const
 {
@@ -397,11 +507,11 @@ const CZISubBlocks& CZIScene::getBlocks(const TilerData* tilerData) const
 }
 
 
-bool CZIScene::blockHasData(const CZISubBlock& block, const std::vector<int>& componentIndices, const TilerData* tilerData)
+bool CZIScene::blockHasData(const CZISubBlock& block, const std::vector<int>& componentIndices, const TilerData* tilerData) const
 {
     for(int component : componentIndices)
     {
-        const int channel = m_componentToChannelIndex[component].first;
+        const int channel = m_componentToChannelIndex.at(component).first;
         if(block.isInBlock(channel,
             tilerData->zSliceIndex,
             tilerData->tFrameIndex,
@@ -418,7 +528,8 @@ bool CZIScene::blockHasData(const CZISubBlock& block, const std::vector<int>& co
     return false;
 }
 
-std::vector<uint8_t> CZIScene::decodeData(const CZISubBlock& block, const std::vector<unsigned char>& encodedData)
+const uint8_t* CZIScene::decodeData(const CZISubBlock& block, const uint8_t* encodedData, size_t encodedSize,
+    cv::Mat& decodedRaster)
 {
     if(block.compression()==CZISubBlock::Uncompressed)
     {
@@ -429,8 +540,8 @@ std::vector<uint8_t> CZIScene::decodeData(const CZISubBlock& block, const std::v
         //std::ofstream fout("c:/Temp/tile.jxr", std::ios::out | std::ios::binary);
         //fout.write((char*)encodedData.data(), encodedData.size());
         //fout.close();
-        cv::Mat raster;
-        ImageTools::decodeJxrBlock(encodedData.data(), encodedData.size(), raster);
+        cv::Mat& raster = decodedRaster;
+        ImageTools::decodeJxrBlock(encodedData, encodedSize, raster);
         const cv::Rect& blockRect = block.rect();
         if(blockRect.width!=raster.cols || blockRect.height!=raster.rows)
         {
@@ -444,10 +555,11 @@ std::vector<uint8_t> CZIScene::decodeData(const CZISubBlock& block, const std::v
                 ).str()
             );
         }
-        size_t dataSize = raster.total()*raster.elemSize();
-        std::vector<uint8_t> decodedData(dataSize);
-        std::memcpy(decodedData.data(), raster.data, dataSize);
-        return decodedData;
+        if(!raster.isContinuous())
+        {
+            raster = raster.clone();
+        }
+        return raster.data;
     }
     throw std::runtime_error(
         (boost::format("CZIImageDriver: Unsupported compression %1%") % static_cast<int>(block.compression())).str()
@@ -455,13 +567,13 @@ std::vector<uint8_t> CZIScene::decodeData(const CZISubBlock& block, const std::v
 }
 
 void CZIScene::unpackChannels(const CZISubBlock& block, const std::vector<int>& componentIndices, 
-    const std::vector<unsigned char>& blockData, const TilerData* tilerData, 
-    std::vector<cv::Mat>& componentRasters)
+    const uint8_t* blockData, const TilerData* tilerData, 
+    std::vector<cv::Mat>& componentRasters) const
 {
     for(int index=0; index<componentIndices.size(); ++index)
     {
         const int componentIndex = componentIndices[index];
-        const std::pair<int,int> componentChannelInfo = m_componentToChannelIndex[componentIndex];
+        const std::pair<int,int> componentChannelInfo = m_componentToChannelIndex.at(componentIndex);
         const int channelIndex = componentChannelInfo.first;
         const int channelComponent = componentChannelInfo.second;
         const int64_t channelOffset = block.computeDataOffset(channelIndex,
@@ -477,7 +589,7 @@ void CZIScene::unpackChannels(const CZISubBlock& block, const std::vector<int>&
         if(channelOffset<0)
             continue;
 
-        const uint8_t* channelData = blockData.data() + channelOffset;
+        const uint8_t* channelData = blockData + channelOffset;
         const SceneChannelInfo& channelInfo = m_channelInfos[channelIndex];
         const int channelSize = block.planeSize();
         const int cvPixelType = static_cast<int>(block.dataType());
@@ -532,7 +644,6 @@ bool CZIScene::readTile(int tileIndex, const std::vector<int>& orgComponentIndic
     const TilerData* tilerData = reinterpret_cast<TilerData*>(userData);
     const Tile& tile = getTile(tilerData, tileIndex);
     const CZISubBlocks& blocks = getBlocks(tilerData);
-    std::vector<uint8_t> data;
     const int numChannels = getNumChannels();
     const std::vector<int> componentIndices = Tools::completeChannelList(orgComponentIndices, numChannels);
     const int firstComponent = componentIndices[0];
@@ -541,18 +652,69 @@ bool CZIScene::readTile(int tileIndex, const std::vector<int>& orgComponentIndic
     getTileRect(tileIndex, tileRect, userData);
     tileRaster.create(tileRect.size(), CV_MAKETYPE(cvDataType, numChannels));
     std::vector<cv::Mat> channelRasters(componentIndices.size());
+    std::vector<int> dataBlocks;
     for(int index: tile.blockIndices)
     {
-        const CZISubBlock& block = blocks[index];
-        if(blockHasData(block, componentIndices, tilerData))
+        if(blockHasData(blocks[index], componentIndices, tilerData))
         {
-            uint64_t pos = block.dataPosition();
-            uint64_t size = block.dataSize();
-            m_slide->readBlock(pos, size, data);
-            std::vector<uint8_t> rasterData = decodeData(block, data);
-            unpackChannels(block, componentIndices, rasterData, tilerData, channelRasters);
+            dataBlocks.push_back(index);
         }
     }
+    const int blockCount = static_cast<int>(dataBlocks.size());
+    std::vector<ScratchBuffer> encodedData(blockCount);
+    std::vector<cv::Mat> decodedRasters(blockCount);
+    std::vector<const uint8_t*> rasterData(blockCount, nullptr);
+    auto readBlock = [&](int item) {
+        const CZISubBlock& block = blocks[dataBlocks[item]];
+        const uint64_t pos = block.dataPosition();
+        const uint64_t size = block.dataSize();
+        const uint8_t* blockData = tilerData->reads ?
+            tilerData->reads->find(static_cast<int64_t>(pos), static_cast<int64_t>(size)) : nullptr;
+        if(blockData == nullptr)
+        {
+            encodedData[item].resize(size);
+            m_slide->readBlock(pos, size, encodedData[item].data());
+            blockData = encodedData[item].data();
+        }
+        rasterData[item] = decodeData(block, blockData, size, decodedRasters[item]);
+    };
+    if(blockCount > 1 && TileComposer::isParallelReadingEnabled())
+    {
+        // sub-blocks of the tile (channels, z-slices, time frames) are read and decoded in parallel
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        cv::parallel_for_(cv::Range(0, blockCount), [&](const cv::Range& range) {
+            for(int item = range.start; item < range.end; ++item)
+            {
+                try
+                {
+                    readBlock(item);
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if(!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        });
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+    else
+    {
+        for(int item = 0; item < blockCount; ++item)
+        {
+            readBlock(item);
+        }
+    }
+    // later sub-blocks overwrite channels of the earlier ones as in sequential reading
+    for(int item = 0; item < blockCount; ++item)
+    {
+        unpackChannels(blocks[dataBlocks[item]], componentIndices, rasterData[item], tilerData, channelRasters);
+    }
     if(channelRasters.size()==1)
     {
         channelRasters[0].copyTo(tileRaster);
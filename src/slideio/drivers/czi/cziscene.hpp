@@ -6,6 +6,8 @@
 #include "slideio/drivers/czi/czi_api_def.hpp"
 #include "slideio/core/cvscene.hpp"
 #include "slideio/core/tools/tilecomposer.hpp"
+#include "slideio/core/tools/tileindex.hpp"
+#include "slideio/core/tools/readcoalescer.hpp"
 #include "slideio/drivers/czi/czisubblock.hpp"
 #include "slideio/drivers/czi/czistructs.hpp"
 #include <map>
@@ -43,6 +45,7 @@ namespace slideio
             double zoom{};
             CZISubBlocks blocks;
             Tiles tiles;
+            TileIndex tileIndex;
         };
         struct ComponentInfo
         {
@@ -64,6 +67,8 @@ namespace slideio
             int zSliceIndex;
             int tFrameIndex;
             double relativeZoom;
+            // sub-blocks of the block being composed loaded by prefetchTiles
+            std::shared_ptr<ReadCoalescer> reads;
         };
     public:
         CZIScene();
@@ -85,8 +90,13 @@ namespace slideio
         // interface Tiler implementaton
         int getTileCount(void* userData) override;
         bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
+        void getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData) override;
+        bool supportsConcurrentReads(void* userData) override;
         bool readTile(int tileIndex, const std::vector<int>& componentIndices, cv::OutputArray tileRaster,
                         void* userData) override;
+        bool getTileCacheKey(void* userData, TileCacheKey& key) override;
+        void prefetchTiles(const std::vector<int>& tileIndices, const std::vector<int>& channelIndices,
+            void* userData) override;
         void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output) override;
         Compression getCompression() const override{
             return m_compression;
@@ -97,6 +107,10 @@ namespace slideio
     protected:
         void readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv::Size& blockSize,
             const std::vector<int>& componentIndices, int zSliceIndex, int tFrameIndex, cv::OutputArray output) override;
+        void readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, cv::OutputArray output) override;
+        void readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+            const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters) override;
     private:
         void setMosaic(bool mosaic) { m_bMosaic = mosaic; }
         void setupComponents(const std::map<int, int>& channelPixelType);
@@ -111,9 +125,11 @@ namespace slideio
         int findBlockIndex(const Tile& tile, const CZISubBlocks& blocks, int channelIndex, int zSliceIndex, int tFrameIndex) const ;
         const Tile& getTile(const TilerData* tilerData, int tileIndex) const;
         const CZISubBlocks& getBlocks(const TilerData* tilerData) const;
-        bool blockHasData(const CZISubBlock& block, const std::vector<int>& componentIndices, const TilerData* tilerData);
-        static std::vector<uint8_t> decodeData(const CZISubBlock& block, const std::vector<unsigned char>& encodedData);
-        void unpackChannels(const CZISubBlock& block, const std::vector<int>& orgComponentIndices, const std::vector<unsigned char>& blockData, const TilerData* tilerData, std::vector<cv::Mat>& componentRasters);
+        bool blockHasData(const CZISubBlock& block, const std::vector<int>& componentIndices, const TilerData* tilerData) const;
+        // returns pointer to the decoded data: either the encoded data itself (uncompressed blocks)
+        // or the data of the decodedRaster
+        static const uint8_t* decodeData(const CZISubBlock& block, const uint8_t* encodedData, size_t encodedSize, cv::Mat& decodedRaster);
+        void unpackChannels(const CZISubBlock& block, const std::vector<int>& orgComponentIndices, const uint8_t* blockData, const TilerData* tilerData, std::vector<cv::Mat>& componentRasters) const;
         void computeSceneMetadata();
     public:
         // static members
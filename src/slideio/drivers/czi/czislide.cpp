@@ -28,7 +28,8 @@ static char SID_ATTACHMENT_CONTENT[] = "ZISRAWATTACH";
 
 using namespace slideio;
 
-CZISlide::CZISlide(const std::string& filePath) : m_filePath(filePath), m_resZ(0), m_resT(0), m_magnification(0)
+CZISlide::CZISlide(const std::string& filePath) : m_filePath(filePath),
+    m_resZ(0), m_resT(0), m_magnification(0)
 {
     init();
 }
@@ -60,17 +61,13 @@ std::shared_ptr<CVScene> CZISlide::getScene(int index) const
 
 void CZISlide::readBlock(uint64_t pos, uint64_t size, std::vector<unsigned char>& data)
 {
-    try
-    {
-        data.resize(size);
-        m_fileStream.seekg(pos, std::ios_base::beg);
-        m_fileStream.read((char*)data.data(), size);
-    }
-    catch(std::exception& ex) {
-        m_fileStream.clear();
-        m_fileStream.seekg(0);
-        throw ex;
-    }
+    data.resize(size);
+    readBlock(pos, size, data.data());
+}
+
+void CZISlide::readBlock(uint64_t pos, uint64_t size, uint8_t* data)
+{
+    m_file->read(pos, static_cast<size_t>(size), data);
 }
 
 std::shared_ptr<CVScene> CZISlide::getAuxImage(const std::string& sceneName) const {
@@ -139,6 +136,7 @@ void CZISlide::readAttachments()
 void CZISlide::init()
 {
     SLIDEIO_LOG(INFO) << "Slide initialization. File path: " << getFilePath();
+    m_file.reset(new PositionalFile(m_filePath));
     // read file header
     m_fileStream.exceptions(std::ios::failbit | std::ios::badbit);
     auto flags = std::ifstream::in | std::ifstream::binary;
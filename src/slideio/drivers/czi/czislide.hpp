@@ -8,6 +8,8 @@
 #include "slideio/drivers/czi/cziscene.hpp"
 #include "slideio/drivers/czi/czistructs.hpp"
 #include <fstream>
+#include <memory>
+#include "slideio/core/tools/positionalfile.hpp"
 
 
 namespace tinyxml2
@@ -40,7 +42,8 @@ namespace slideio
         double getTFrameResolution() const {return m_resT;}
         const CZIChannelInfos& getChannelInfo() const { return m_channels; }
         const std::string& getTitle() const { return m_title; }
-        void readBlock(uint64_t pos, uint64_t size, std::vector<unsigned char>& data);;
+        void readBlock(uint64_t pos, uint64_t size, std::vector<unsigned char>& data);
+        void readBlock(uint64_t pos, uint64_t size, uint8_t* data);
         std::shared_ptr<CVScene> getAuxImage(const std::string& sceneName) const override;
         void readFileHeader(FileHeader& fileHeader);
         void readSubBlocks(uint64_t pos, uint64_t originPos, std::vector<CZISubBlocks>& sceneBlocks, std::vector<uint64_t>& sceneIds);
@@ -63,6 +66,8 @@ namespace slideio
         std::vector<std::shared_ptr<CZIScene>> m_scenes;
         std::string m_filePath;
         std::ifstream m_fileStream;
+        // positioned reads of raster data from many threads; m_fileStream is used by initialization only
+        std::unique_ptr<PositionalFile> m_file;
         uint64_t m_directoryPosition{};
         uint64_t m_metadataPosition{};
         uint64_t m_attachmentDirectoryPosition;
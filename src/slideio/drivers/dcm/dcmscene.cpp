@@ -220,14 +220,7 @@ void DCMScene::extractSliceRaster(const cv::Mat& frame,
     else
     {
         std::vector<int> channelIndices = Tools::completeChannelList(componentIndices, getNumChannels());
-        std::vector<cv::Mat> channelRasters(channelIndices.size());
-        for (int index = 0; index < channelIndices.size(); ++index)
-        {
-            int channelIndex = channelIndices[index];
-            cv::extractChannel(resizedBlock, channelRasters[index],
-                               channelIndex);
-        }
-        cv::merge(channelRasters, output);
+        Tools::extractChannels(resizedBlock, channelIndices, output);
     }
 }
 
@@ -258,6 +251,7 @@ void DCMScene::readResampledBlockChannelsEx(const cv::Rect& blockRect,
     int tFrameIndex,
     cv::OutputArray output)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
     SLIDEIO_LOG(INFO) << "DCMImageDriver: Resample block:" << std::endl
         << "block: " << blockRect.x << "," << blockRect.y << ","
         << blockRect.width << "," << blockRect.height << std::endl
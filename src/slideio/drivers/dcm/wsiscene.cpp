@@ -6,6 +6,7 @@
 
 #include "slideio/base/exceptions.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/drivers/dcm/dcmscene.hpp"
 
 using namespace slideio;
@@ -121,6 +122,13 @@ bool WSIScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) {
 	return zoomFile->getTileRect(tileIndex, tileRect);
 }
 
+bool WSIScene::getTileCacheKey(void* userData, TileCacheKey& key) {
+    const TilerData* data = static_cast<TilerData*>(userData);
+    key.filePath = m_files[data->zoomLevelIndex]->getFilePath();
+    key.level = data->zoomLevelIndex;
+    return true;
+}
+
 bool WSIScene::readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
     void* userData) {
     const TilerData* data = static_cast<TilerData*>(userData);
@@ -140,6 +148,7 @@ void WSIScene::initializeBlock(const cv::Size& blockSize, const std::vector<int>
 
 void WSIScene::readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv::Size& blockSize,
     const std::vector<int>& componentIndices, int zSliceIndex, int tFrameIndex, cv::OutputArray output) {
+	std::lock_guard<std::recursive_mutex> lock(m_readMutex);
 	TilerData userData;
 	const double zoomX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
 	const double zoomY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
@@ -157,6 +166,16 @@ void WSIScene::readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv:
 	TileComposer::composeRect(this, componentIndices, zoomLevelRect, blockSize, output, &userData);
 }
 
+void WSIScene::readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect,
+    const std::vector<int>& channelIndices, int zSliceIndex, int tFrameIndex, cv::OutputArray output) {
+	std::lock_guard<std::recursive_mutex> lock(m_readMutex);
+	TilerData userData;
+	userData.zoomLevelIndex = zoomLevel;
+	userData.zSliceIndex = zSliceIndex;
+	userData.tFrameIndex = tFrameIndex;
+	TileComposer::composeRect(this, channelIndices, levelRect, levelRect.size(), output, &userData);
+}
+
 std::shared_ptr<CVScene> WSIScene::getAuxImage(const std::string& imageName) const {
 	auto it = m_auxImages.find(imageName);
 	if(it == m_auxImages.end()) {
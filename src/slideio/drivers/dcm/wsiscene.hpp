@@ -47,12 +47,16 @@ namespace slideio
         bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
         bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
             void* userData) override;
+        bool getTileCacheKey(void* userData, TileCacheKey& key) override;
         void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices,
             cv::OutputArray output) override;
         void readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv::Size& blockSize,
             const std::vector<int>& componentIndices, int zSliceIndex, int tFrameIndex,
             cv::OutputArray output) override;
         std::shared_ptr<CVScene> getAuxImage(const std::string& imageName) const override;
+    protected:
+        void readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, cv::OutputArray output) override;
 
     private:
         std::vector<std::shared_ptr<DCMFile>> m_files;
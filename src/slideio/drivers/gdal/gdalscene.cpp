@@ -131,6 +131,7 @@ cv::Rect slideio::GDALScene::getRect() const
 
 void slideio::GDALScene::readResampledBlockChannels(const cv::Rect& blockRect, const cv::Size& blockSize, const std::vector<int>& channelIndices_, cv::OutputArray output)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
     if(m_hFile==nullptr)
         throw std::runtime_error("GDALDriver: Invalid file header by raster reading operation");
     const int numChannels = GDALGetRasterCount(m_hFile);
@@ -6,7 +6,11 @@
 
 #include "slideio/core/tools/tools.hpp"
 #include "slideio/drivers/ndpi/ndpilibtiff.hpp"
+#include "slideio/drivers/ndpi/ndpiindex.hpp"
+#include "slideio/imagetools/tiffifdparser.hpp"
 
+// smaller compressed strips are decoded whole: scanning them for restart markers does not pay off
+static const uint32_t MIN_RESTART_SCAN_STRIP_SIZE = 4 * 1024 * 1024;
 
 slideio::NDPIFile::~NDPIFile()
 {
@@ -31,9 +35,14 @@ void slideio::NDPIFile::init(const std::string& filePath)
     }
     SLIDEIO_LOG(INFO) << "File " << filePath << " is successfully opened";
     m_filePath = filePath;
-    scanFile();
-    for(auto& dir : m_directories) {
-        NDPITiffTools::readDirectoryJpegHeaders(this, dir);
+    m_file.reset(new PositionalFile(filePath));
+    // a valid sidecar index replaces the scanning of directories and jpeg strips
+    if (!NDPIIndex::load(filePath, m_directories)) {
+        scanFile();
+        for(auto& dir : m_directories) {
+            NDPITiffTools::readDirectoryJpegHeaders(this, dir);
+        }
+        NDPIIndex::save(filePath, m_directories);
     }
     SLIDEIO_LOG(INFO) << "File " << filePath << " initialization is complete";
 }
@@ -42,6 +51,21 @@ void slideio::NDPIFile::scanFile()
 {
     SLIDEIO_LOG(INFO) << "NDPITiffTools::scanFile-begin";
     libtiff::TIFF* tiff = getTiffHandle();
+    try {
+        TiffIFDParser parser(m_filePath, true);
+        const int dirs = parser.getNumberOfDirectories();
+        m_directories.resize(dirs);
+        for (int dir = 0; dir < dirs; dir++) {
+            NDPITiffTools::scanTiffDir(parser, tiff, dir, m_directories[dir]);
+        }
+        SLIDEIO_LOG(INFO) << "NDPITiffTools::scanFile-end. Total number of directories: " << dirs;
+        return;
+    }
+    catch (std::exception& ex) {
+        SLIDEIO_LOG(WARNING) << "NDPITiffTools: fast scanning of file " << m_filePath
+            << " failed, falling back to libtiff: " << ex.what();
+        m_directories.clear();
+    }
     int dirs = libtiff::TIFFNumberOfDirectories(tiff);
     SLIDEIO_LOG(INFO) << "Total number of directories: " << dirs;
     m_directories.resize(dirs);
@@ -53,6 +77,74 @@ void slideio::NDPIFile::scanFile()
     SLIDEIO_LOG(INFO) << "NDPITiffTools::scanFile-end";
 }
 
+slideio::NDPIFile::TIFFHandle slideio::NDPIFile::acquireTiffHandle(const NDPITiffDirectory& dir)
+{
+    ResourcePool<NDPITIFFKeeper>* pool = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        auto& dirPool = m_handlePools[std::make_pair(dir.dirIndex, dir.offset)];
+        if (!dirPool) {
+            const std::string filePath = m_filePath;
+            NDPITiffDirectory pinnedDir;
+            pinnedDir.dirIndex = dir.dirIndex;
+            pinnedDir.offset = dir.offset;
+            dirPool.reset(new ResourcePool<NDPITIFFKeeper>([filePath, pinnedDir]() {
+                std::unique_ptr<NDPITIFFKeeper> keeper(new NDPITIFFKeeper(NDPITiffTools::openTiffFile(filePath)));
+                if (!keeper->isValid()) {
+                    RAISE_RUNTIME_ERROR << "NDPIImageDriver: Cannot open file:" << filePath;
+                }
+                NDPITiffTools::setCurrentDirectory(keeper->getHandle(), pinnedDir);
+                return keeper;
+            }));
+        }
+        pool = dirPool.get();
+    }
+    return pool->acquire();
+}
+
+std::shared_ptr<slideio::NDPIFile::RestartIntervals> slideio::NDPIFile::getRestartIntervals(
+    const NDPITiffDirectory& dir)
+{
+    std::shared_ptr<RestartIntervals> intervals;
+    {
+        std::lock_guard<std::mutex> lock(m_restartMutex);
+        auto& dirIntervals = m_restartIntervals[std::make_pair(dir.dirIndex, dir.offset)];
+        if (!dirIntervals) {
+            dirIntervals = std::make_shared<RestartIntervals>();
+        }
+        intervals = dirIntervals;
+    }
+    // strips of different directories are scanned concurrently
+    std::lock_guard<std::mutex> lock(intervals->mutex);
+    if (!intervals->scanned) {
+        try {
+            NDPITiffTools::scanRestartMarkers(*m_file, dir, intervals->mcuStarts);
+        }
+        catch (std::runtime_error& ex) {
+            SLIDEIO_LOG(WARNING) << "NDPIFile: cannot find restart intervals of directory "
+                << dir.dirIndex << ": " << ex.what();
+            intervals->mcuStarts.clear();
+        }
+        intervals->scanned = true;
+    }
+    return intervals;
+}
+
+bool slideio::NDPIFile::readJpegRestartRegion(const NDPITiffDirectory& dir, const cv::Rect& region,
+    cv::OutputArray output)
+{
+    if (!dir.mcuStarts.empty()) {
+        return NDPITiffTools::readJpegRestartRegion(*m_file, dir, region, output);
+    }
+    if (dir.tiled || dir.rowsPerStrip != dir.height || dir.slideioCompression != Compression::Jpeg
+        || dir.jpegHeader.empty() || dir.rawStripSize <= MIN_RESTART_SCAN_STRIP_SIZE) {
+        return false;
+    }
+    const std::shared_ptr<RestartIntervals> intervals = getRestartIntervals(dir);
+    // the intervals are not changed after the scan
+    return NDPITiffTools::readJpegRestartRegion(*m_file, dir, intervals->mcuStarts, region, output);
+}
+
 const slideio::NDPITiffDirectory& slideio::NDPIFile::findZoomDirectory(double zoom, int sceneWidth, int dirBegin, int dirEnd)
 {
     const auto& directories = m_directories;
@@ -9,9 +9,14 @@
 #pragma warning( push )
 #pragma warning(disable: 4251)
 #endif
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "ndpitifftools.hpp"
+#include "slideio/base/resourcepool.hpp"
+#include "slideio/core/tools/positionalfile.hpp"
 
 namespace libtiff
 {
@@ -24,6 +29,7 @@ namespace slideio
     class SLIDEIO_NDPI_EXPORTS NDPIFile
     {
     public:
+        typedef ResourcePool<NDPITIFFKeeper>::Lease TIFFHandle;
         NDPIFile(){
         }
         ~NDPIFile();
@@ -39,12 +45,36 @@ namespace slideio
             return m_tiff;
         }
         const NDPITiffDirectory& findZoomDirectory(double zoom, int sceneWidth, int dirBegin, int dirEnd);
+        // returns a handle with the directory loaded. Handles are pinned to
+        // directories and are not shared between threads.
+        TIFFHandle acquireTiffHandle(const NDPITiffDirectory& dir);
+        // file handle for positioned reads of jpeg strips. It is opened once and shared by all threads.
+        const PositionalFile& getFile() const {
+            return *m_file;
+        }
+        // decodes a region of a single strip jpeg directory by its restart intervals.
+        // Strips without the restart marker tag are scanned for the markers by the first call,
+        // the intervals are kept for the next reads. Strips small enough to be decoded whole
+        // are not scanned. Returns false if the strip cannot be split by the intervals.
+        bool readJpegRestartRegion(const NDPITiffDirectory& dir, const cv::Rect& region, cv::OutputArray output);
     private:
         void scanFile();
+        struct RestartIntervals
+        {
+            std::mutex mutex;
+            bool scanned = false;
+            std::vector<uint32_t> mcuStarts;
+        };
+        std::shared_ptr<RestartIntervals> getRestartIntervals(const NDPITiffDirectory& dir);
     private:
         std::string m_filePath;
         NDPITIFFKeeper m_tiff;
+        std::unique_ptr<PositionalFile> m_file;
         std::vector<NDPITiffDirectory> m_directories;
+        std::mutex m_poolMutex;
+        std::map<std::pair<int, int64_t>, std::unique_ptr<ResourcePool<NDPITIFFKeeper>>> m_handlePools;
+        std::mutex m_restartMutex;
+        std::map<std::pair<int, int64_t>, std::shared_ptr<RestartIntervals>> m_restartIntervals;
     };
 }
 
@@ -0,0 +1,394 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/drivers/ndpi/ndpiindex.hpp"
+#include "slideio/base/exceptions.hpp"
+#include "slideio/base/log.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <type_traits>
+
+using namespace slideio;
+namespace fs = boost::filesystem;
+
+namespace
+{
+    const char INDEX_SIGNATURE[] = "SLIDEIO-NDPI-INDEX";
+    // incremented with every change of the directory layout
+    const uint32_t INDEX_VERSION = 3;
+    const char INDEX_EXTENSION[] = ".slideio-index";
+
+    const char INDEX_ENABLED_VARIABLE[] = "SLIDEIO_NDPI_INDEX";
+    const char INDEX_DIRECTORY_VARIABLE[] = "SLIDEIO_NDPI_INDEX_DIR";
+
+    bool environmentIndexEnabled()
+    {
+        const char* value = std::getenv(INDEX_ENABLED_VARIABLE);
+        if (value == nullptr) {
+            return false;
+        }
+        std::string flag(value);
+        std::transform(flag.begin(), flag.end(), flag.begin(), [](unsigned char ch) {
+            return static_cast<char>(std::tolower(ch));
+        });
+        return flag == "1" || flag == "true" || flag == "on" || flag == "yes";
+    }
+
+    std::string environmentCacheDirectory()
+    {
+        const char* value = std::getenv(INDEX_DIRECTORY_VARIABLE);
+        return value ? std::string(value) : std::string();
+    }
+
+    std::mutex configMutex;
+    bool indexEnabled = environmentIndexEnabled();
+    std::string cacheDirectory = environmentCacheDirectory();
+
+    class IndexWriter
+    {
+    public:
+        explicit IndexWriter(std::ostream& stream) : m_stream(stream) {
+        }
+        template <typename T>
+        void value(const T& val) {
+            static_assert(std::is_trivially_copyable<T>::value, "trivially copyable type expected");
+            m_stream.write(reinterpret_cast<const char*>(&val), sizeof(val));
+        }
+        void string(const std::string& str) {
+            value(static_cast<uint64_t>(str.size()));
+            m_stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+        }
+        template <typename T>
+        void vector(const std::vector<T>& vec) {
+            value(static_cast<uint64_t>(vec.size()));
+            m_stream.write(reinterpret_cast<const char*>(vec.data()), static_cast<std::streamsize>(vec.size() * sizeof(T)));
+        }
+    private:
+        std::ostream& m_stream;
+    };
+
+    class IndexReader
+    {
+    public:
+        IndexReader(std::istream& stream, uint64_t streamSize) : m_stream(stream), m_left(streamSize) {
+        }
+        template <typename T>
+        void value(T& val) {
+            static_assert(std::is_trivially_copyable<T>::value, "trivially copyable type expected");
+            bytes(reinterpret_cast<char*>(&val), sizeof(val));
+        }
+        void string(std::string& str) {
+            str.resize(count(1));
+            bytes(&str[0], str.size());
+        }
+        template <typename T>
+        void vector(std::vector<T>& vec) {
+            vec.resize(count(sizeof(T)));
+            bytes(reinterpret_cast<char*>(vec.data()), vec.size() * sizeof(T));
+        }
+    private:
+        size_t count(size_t itemSize) {
+            uint64_t items = 0;
+            value(items);
+            // a damaged index must not allocate more than the rest of the file
+            if (items > m_left / itemSize) {
+                RAISE_RUNTIME_ERROR << "NDPIIndex: invalid item count " << items;
+            }
+            return static_cast<size_t>(items);
+        }
+        void bytes(char* data, size_t size) {
+            if (size > m_left || !m_stream.read(data, static_cast<std::streamsize>(size))) {
+                RAISE_RUNTIME_ERROR << "NDPIIndex: unexpected end of the index";
+            }
+            m_left -= size;
+        }
+        std::istream& m_stream;
+        uint64_t m_left;
+    };
+
+    // descriptions that were not read yet are stored as a position in the slide
+    void writeDescription(IndexWriter& writer, const TiffString& description)
+    {
+        const uint8_t deferred = description.isLoaded() ? 0 : 1;
+        writer.value(deferred);
+        if (deferred) {
+            writer.value(description.getPosition());
+            writer.value(description.getCount());
+        }
+        else {
+            writer.string(description.str());
+        }
+    }
+
+    void readDescription(IndexReader& reader, const std::string& slidePath, TiffString& description)
+    {
+        uint8_t deferred = 0;
+        reader.value(deferred);
+        if (deferred) {
+            uint64_t position = 0;
+            uint64_t count = 0;
+            reader.value(position);
+            reader.value(count);
+            description = TiffString(slidePath, position, count);
+        }
+        else {
+            std::string text;
+            reader.string(text);
+            description = text;
+        }
+    }
+
+    void writeDirectory(IndexWriter& writer, const NDPITiffDirectory& dir)
+    {
+        writer.value(dir.width);
+        writer.value(dir.height);
+        writer.value(dir.tiled);
+        writer.value(dir.tileWidth);
+        writer.value(dir.tileHeight);
+        writer.value(dir.channels);
+        writer.value(dir.bitsPerSample);
+        writer.value(dir.photometric);
+        writer.value(dir.YCbCrSubsampling);
+        writer.value(dir.compression);
+        writer.value(dir.slideioCompression);
+        writer.value(dir.dirIndex);
+        writer.value(dir.offset);
+        writeDescription(writer, dir.description);
+        writer.string(dir.userLabel);
+        writer.string(dir.comments);
+        writer.value(dir.res.x);
+        writer.value(dir.res.y);
+        writer.value(dir.position.x);
+        writer.value(dir.position.y);
+        writer.value(dir.interleaved);
+        writer.value(dir.rowsPerStrip);
+        writer.value(dir.dataType);
+        writer.value(dir.stripSize);
+        writer.value(dir.magnification);
+        writer.value(dir.blankLines);
+        writer.vector(dir.mcuStarts);
+        writer.value(dir.jpegHeaderOffset);
+        writer.value(dir.jpegSOFMarker);
+        writer.value(dir.jpegHeaderSize);
+        writer.vector(dir.jpegHeader);
+        writer.value(dir.rawStripSize);
+        writer.value(dir.auxImage);
+        writer.value(static_cast<uint64_t>(dir.subdirectories.size()));
+        for (const NDPITiffDirectory& subdir : dir.subdirectories) {
+            writeDirectory(writer, subdir);
+        }
+    }
+
+    void readDirectory(IndexReader& reader, const std::string& slidePath, NDPITiffDirectory& dir, int depth)
+    {
+        reader.value(dir.width);
+        reader.value(dir.height);
+        reader.value(dir.tiled);
+        reader.value(dir.tileWidth);
+        reader.value(dir.tileHeight);
+        reader.value(dir.channels);
+        reader.value(dir.bitsPerSample);
+        reader.value(dir.photometric);
+        reader.value(dir.YCbCrSubsampling);
+        reader.value(dir.compression);
+        reader.value(dir.slideioCompression);
+        reader.value(dir.dirIndex);
+        reader.value(dir.offset);
+        readDescription(reader, slidePath, dir.description);
+        reader.string(dir.userLabel);
+        reader.string(dir.comments);
+        reader.value(dir.res.x);
+        reader.value(dir.res.y);
+        reader.value(dir.position.x);
+        reader.value(dir.position.y);
+        reader.value(dir.interleaved);
+        reader.value(dir.rowsPerStrip);
+        reader.value(dir.dataType);
+        reader.value(dir.stripSize);
+        reader.value(dir.magnification);
+        reader.value(dir.blankLines);
+        reader.vector(dir.mcuStarts);
+        reader.value(dir.jpegHeaderOffset);
+        reader.value(dir.jpegSOFMarker);
+        reader.value(dir.jpegHeaderSize);
+        reader.vector(dir.jpegHeader);
+        reader.value(dir.rawStripSize);
+        reader.value(dir.auxImage);
+        uint64_t subdirectories = 0;
+        reader.value(subdirectories);
+        // ndpi sub-directories do not have own sub-directories
+        if (depth > 0 && subdirectories > 0) {
+            RAISE_RUNTIME_ERROR << "NDPIIndex: unexpected nested sub-directories";
+        }
+        if (subdirectories > 1024) {
+            RAISE_RUNTIME_ERROR << "NDPIIndex: invalid number of sub-directories " << subdirectories;
+        }
+        dir.subdirectories.resize(static_cast<size_t>(subdirectories));
+        for (NDPITiffDirectory& subdir : dir.subdirectories) {
+            readDirectory(reader, slidePath, subdir, depth + 1);
+        }
+    }
+}
+
+void NDPIIndex::setEnabled(bool enable)
+{
+    std::lock_guard<std::mutex> lock(configMutex);
+    indexEnabled = enable;
+}
+
+bool NDPIIndex::isEnabled()
+{
+    std::lock_guard<std::mutex> lock(configMutex);
+    return indexEnabled;
+}
+
+void NDPIIndex::setCacheDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(configMutex);
+    cacheDirectory = directory;
+}
+
+std::string NDPIIndex::getCacheDirectory()
+{
+    std::lock_guard<std::mutex> lock(configMutex);
+    return cacheDirectory;
+}
+
+std::string NDPIIndex::getIndexPath(const std::string& slidePath)
+{
+    const std::string directory = getCacheDirectory();
+    if (directory.empty()) {
+        return slidePath + INDEX_EXTENSION;
+    }
+    // slides of different folders may have the same name
+    const fs::path absolutePath = fs::absolute(fs::path(slidePath));
+    std::stringstream name;
+    name << absolutePath.filename().string() << "-" << std::hex << std::hash<std::string>()(absolutePath.string())
+        << INDEX_EXTENSION;
+    return (fs::path(directory) / name.str()).string();
+}
+
+NDPIIndex::Key NDPIIndex::getSlideKey(const std::string& slidePath)
+{
+    const fs::path path(slidePath);
+    Key key;
+    key.fileSize = static_cast<uint64_t>(fs::file_size(path));
+    key.modificationTime = static_cast<int64_t>(fs::last_write_time(path));
+    return key;
+}
+
+bool NDPIIndex::load(const std::string& slidePath, std::vector<NDPITiffDirectory>& directories)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    const std::string indexPath = getIndexPath(slidePath);
+    try {
+        if (!fs::exists(indexPath)) {
+            return false;
+        }
+        if (!read(indexPath, getSlideKey(slidePath), directories, slidePath)) {
+            SLIDEIO_LOG(INFO) << "NDPIIndex: index " << indexPath << " is outdated";
+            return false;
+        }
+        SLIDEIO_LOG(INFO) << "NDPIIndex: directories of " << slidePath << " are loaded from " << indexPath;
+        return true;
+    }
+    catch (std::exception& ex) {
+        SLIDEIO_LOG(WARNING) << "NDPIIndex: cannot load index " << indexPath << ": " << ex.what();
+    }
+    directories.clear();
+    return false;
+}
+
+void NDPIIndex::save(const std::string& slidePath, const std::vector<NDPITiffDirectory>& directories)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    const std::string indexPath = getIndexPath(slidePath);
+    try {
+        write(indexPath, getSlideKey(slidePath), directories);
+        SLIDEIO_LOG(INFO) << "NDPIIndex: index of " << slidePath << " is written to " << indexPath;
+    }
+    catch (std::exception& ex) {
+        SLIDEIO_LOG(WARNING) << "NDPIIndex: cannot write index " << indexPath << ": " << ex.what();
+    }
+}
+
+bool NDPIIndex::read(const std::string& indexPath, const Key& key, std::vector<NDPITiffDirectory>& directories,
+    const std::string& slidePath)
+{
+    const fs::path path(indexPath);
+    fs::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        RAISE_RUNTIME_ERROR << "NDPIIndex: cannot open index " << indexPath;
+    }
+    IndexReader reader(stream, static_cast<uint64_t>(fs::file_size(path)));
+    char signature[sizeof(INDEX_SIGNATURE)] = {};
+    reader.value(signature);
+    uint32_t version = 0;
+    reader.value(version);
+    if (std::memcmp(signature, INDEX_SIGNATURE, sizeof(signature)) != 0 || version != INDEX_VERSION) {
+        return false;
+    }
+    Key indexKey;
+    reader.value(indexKey.fileSize);
+    reader.value(indexKey.modificationTime);
+    if (indexKey.fileSize != key.fileSize || indexKey.modificationTime != key.modificationTime) {
+        return false;
+    }
+    uint64_t count = 0;
+    reader.value(count);
+    if (count > 100000) {
+        RAISE_RUNTIME_ERROR << "NDPIIndex: invalid number of directories " << count;
+    }
+    std::vector<NDPITiffDirectory> indexDirectories(static_cast<size_t>(count));
+    for (NDPITiffDirectory& dir : indexDirectories) {
+        readDirectory(reader, slidePath, dir, 0);
+    }
+    directories.swap(indexDirectories);
+    return true;
+}
+
+void NDPIIndex::write(const std::string& indexPath, const Key& key, const std::vector<NDPITiffDirectory>& directories)
+{
+    // the index is written to a temporary file and renamed: concurrent readers
+    // never see an incomplete index
+    const fs::path path(indexPath);
+    const fs::path tempPath = path.parent_path() / fs::unique_path(path.filename().string() + ".%%%%-%%%%");
+    {
+        fs::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            RAISE_RUNTIME_ERROR << "NDPIIndex: cannot create index " << tempPath.string();
+        }
+        IndexWriter writer(stream);
+        writer.value(INDEX_SIGNATURE);
+        writer.value(INDEX_VERSION);
+        writer.value(key.fileSize);
+        writer.value(key.modificationTime);
+        writer.value(static_cast<uint64_t>(directories.size()));
+        for (const NDPITiffDirectory& dir : directories) {
+            writeDirectory(writer, dir);
+        }
+        if (!stream.flush()) {
+            stream.close();
+            fs::remove(tempPath);
+            RAISE_RUNTIME_ERROR << "NDPIIndex: error by writing index " << tempPath.string();
+        }
+    }
+    boost::system::error_code error;
+    fs::rename(tempPath, path, error);
+    if (error) {
+        fs::remove(tempPath);
+        RAISE_RUNTIME_ERROR << "NDPIIndex: cannot rename " << tempPath.string() << " to " << indexPath
+            << ": " << error.message();
+    }
+}
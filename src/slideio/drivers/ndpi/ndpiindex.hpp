@@ -0,0 +1,58 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/drivers/ndpi/ndpi_api_def.hpp"
+#include "slideio/drivers/ndpi/ndpitifftools.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    /**@brief Sidecar index of scanned ndpi directories.
+     *
+     * The index stores the directories of a slide as NDPIFile builds them at open time:
+     * tags, restart marker offsets, jpeg headers and MCU tile geometry. Reopening a slide with
+     * a valid index skips the directory scan. The index is keyed by the size and modification
+     * time of the slide and is ignored when they change. Indexing is disabled by default.
+     * Index files are written next to the slides or to the cache directory if it is set.
+     * Initial settings are read from the environment variables SLIDEIO_NDPI_INDEX
+     * and SLIDEIO_NDPI_INDEX_DIR.
+     */
+    class SLIDEIO_NDPI_EXPORTS NDPIIndex
+    {
+    public:
+        struct Key
+        {
+            uint64_t fileSize = 0;
+            int64_t modificationTime = 0;
+        };
+    public:
+        static void setEnabled(bool enable);
+        static bool isEnabled();
+        // an empty directory puts index files next to the slides
+        static void setCacheDirectory(const std::string& directory);
+        static std::string getCacheDirectory();
+        static std::string getIndexPath(const std::string& slidePath);
+        static Key getSlideKey(const std::string& slidePath);
+        // loads directories of the slide from its index. Returns false if indexing is disabled
+        // or the index is missing or outdated.
+        static bool load(const std::string& slidePath, std::vector<NDPITiffDirectory>& directories);
+        // writes the index of the slide if indexing is enabled. Errors are logged and ignored.
+        static void save(const std::string& slidePath, const std::vector<NDPITiffDirectory>& directories);
+        // descriptions that were not read at scan time are read later from slidePath
+        static bool read(const std::string& indexPath, const Key& key, std::vector<NDPITiffDirectory>& directories,
+            const std::string& slidePath = std::string());
+        static void write(const std::string& indexPath, const Key& key, const std::vector<NDPITiffDirectory>& directories);
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
@@ -8,32 +8,29 @@
 
 #include "ndpifile.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/blocktiler.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/drivers/ndpi/ndpitiffmessagehandler.hpp"
 #include "slideio/imagetools/imagetools.hpp"
 
 using namespace slideio;
 
+static const size_t DEFAULT_LEVEL_CACHE_LIMIT = 64 * 1024 * 1024;
+// bigger levels are read by the region decoder
+static const size_t DEFAULT_MAX_CACHED_LEVEL_SIZE = 16 * 1024 * 1024;
+static const int LEVEL_CACHE_TILE_SIZE = 512;
+
 class NDPIUserData
 {
 public:
-    NDPIUserData(const NDPITiffDirectory* dir, const std::string& filePath) : m_dir(dir),
-                                                                              m_file(nullptr),
-                                                                              m_filePath(filePath)
+    NDPIUserData(const NDPITiffDirectory* dir, const PositionalFile& file) : m_dir(dir),
+                                                                           m_file(nullptr)
     {
+        // single strip directories are read by positioned reads of the shared file handle
         if ((!dir->tiled) && (dir->rowsPerStrip == dir->height) 
             && (dir->slideioCompression==Compression::Jpeg
             || dir->slideioCompression==Compression::Uncompressed)) {
-            m_file = Tools::openFile(filePath, "rb");
-            if (!m_file) {
-                RAISE_RUNTIME_ERROR << "NDPI Image Driver: Cannot open file " << filePath;
-            }
-        }
-    }
-
-    ~NDPIUserData()
-    {
-        if (m_file) {
-            fclose(m_file);
+            m_file = &file;
         }
     }
 
@@ -42,23 +39,19 @@ public:
         return m_dir;
     }
 
-    FILE* file() const
+    const PositionalFile* file() const
     {
         return m_file;
     }
 
-    const std::string& filePath() const
-    {
-        return m_filePath;
-    }
-
 private:
     const NDPITiffDirectory* m_dir;
-    FILE* m_file;
-    std::string m_filePath;
+    const PositionalFile* m_file;
 };
 
-NDPIScene::NDPIScene() : m_pfile(nullptr), m_startDir(-1), m_endDir(-1), m_rect(0, 0, 0, 0)
+NDPIScene::NDPIScene() : m_pfile(nullptr), m_startDir(-1), m_endDir(-1), m_rect(0, 0, 0, 0),
+                         m_levelCacheLimit(DEFAULT_LEVEL_CACHE_LIMIT), m_maxCachedLevelSize(DEFAULT_MAX_CACHED_LEVEL_SIZE),
+                         m_levelCacheSize(0)
 {
 }
 
@@ -196,31 +189,221 @@ void NDPIScene::scaleBlockToDirectory(const cv::Rect& imageBlockRect, const slid
 void NDPIScene::readResampledBlockChannels(const cv::Rect& imageBlockRect, const cv::Size& requiredBlockSize,
                                            const std::vector<int>& channelIndices, cv::OutputArray output)
 {
-
     const slideio::NDPITiffDirectory& dir = findZoomDirectory(imageBlockRect, requiredBlockSize);
-    const auto& directories = m_pfile->directories();
-
     cv::Rect dirBlockRect;
     scaleBlockToDirectory(imageBlockRect, dir, dirBlockRect);
-    NDPITiffTools::setCurrentDirectory(m_pfile->getTiffHandle(), dir);
-    NDPIUserData data(&dir, getFilePath());
+    readDirectoryBlock(dir, dirBlockRect, requiredBlockSize, channelIndices, output);
+}
+
+void NDPIScene::readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect,
+    const std::vector<int>& channelIndices, int, int, cv::OutputArray output)
+{
+    const NDPITiffDirectory& dir = m_pfile->directories()[m_startDir + zoomLevel];
+    readDirectoryBlock(dir, levelRect, levelRect.size(), channelIndices, output);
+}
+
+void NDPIScene::readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+    const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters)
+{
+    // blocks are grouped by the directory they are read from
+    std::map<const NDPITiffDirectory*, std::vector<int>> dirBlocks;
+    std::vector<cv::Rect> dirBlockRects(blockRects.size());
+    for (size_t block = 0; block < blockRects.size(); ++block) {
+        const NDPITiffDirectory& dir = findZoomDirectory(blockRects[block], blockSize);
+        scaleBlockToDirectory(blockRects[block], dir, dirBlockRects[block]);
+        dirBlocks[&dir].push_back(static_cast<int>(block));
+    }
+    for (const auto& dirBlock : dirBlocks) {
+        const NDPITiffDirectory& dir = *dirBlock.first;
+        const std::vector<int>& blocks = dirBlock.second;
+        if (dir.getType() == NDPITiffDirectory::Type::SingleStripe) {
+            // the level cache and restart intervals are handled block by block
+            for (const int block : blocks) {
+                readDirectoryBlock(dir, dirBlockRects[block], blockSize, channelIndices, blockRasters[block]);
+            }
+            continue;
+        }
+        makeSureValidDirectoryType(dir.getType());
+        NDPIUserData data(&dir, m_pfile->getFile());
+        std::vector<cv::Rect> rects(blocks.size());
+        std::vector<cv::Mat> rasters(blocks.size());
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            rects[index] = dirBlockRects[blocks[index]];
+            rasters[index] = blockRasters[blocks[index]];
+        }
+        TileComposer::composeRects(this, channelIndices, rects, blockSize, rasters, (void*)&data);
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            blockRasters[blocks[index]] = rasters[index];
+        }
+    }
+}
+
+void NDPIScene::readDirectoryBlock(const NDPITiffDirectory& dir, const cv::Rect& dirBlockRect,
+    const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output)
+{
+    NDPIUserData data(&dir, m_pfile->getFile());
     const auto dirType = dir.getType();
     if(dirType == NDPITiffDirectory::Type::Tiled 
         || dirType == NDPITiffDirectory::Type::SingleStripeMCU
         || dirType == NDPITiffDirectory::Type::Striped ) {
-               TileComposer::composeRect(this, channelIndices, dirBlockRect, requiredBlockSize, output, (void*)&data);
+               TileComposer::composeRect(this, channelIndices, dirBlockRect, blockSize, output, (void*)&data);
     } else if(dirType==NDPITiffDirectory::Type::SingleStripe){
-        cv::Mat raster;
-        NDPITiffTools::readStripedDir(m_pfile->getTiffHandle(), dir, raster);
-        cv::Mat block(raster, dirBlockRect);
-        cv::Mat blockResized;
-        cv::resize(block, blockResized, requiredBlockSize);
-        Tools::extractChannels(blockResized, channelIndices, output);
+        std::shared_ptr<CacheManager> levelCache = getLevelCache(dir);
+        if (levelCache) {
+            CacheManagerTiler tiler(levelCache, { LEVEL_CACHE_TILE_SIZE, LEVEL_CACHE_TILE_SIZE }, dir.dirIndex);
+            TileComposer::composeRect(&tiler, channelIndices, dirBlockRect, blockSize, output);
+            return;
+        }
+        // jpeg strips with restart markers are decoded only in the block intervals
+        cv::Mat block;
+        if (!data.file() || !m_pfile->readJpegRestartRegion(dir, dirBlockRect, block)) {
+            cv::Mat raster;
+            auto hFile = m_pfile->acquireTiffHandle(dir);
+            NDPITiffTools::readStripedDir(hFile->getHandle(), dir, raster);
+            block = cv::Mat(raster, dirBlockRect);
+        }
+        if(block.size() == blockSize) {
+            Tools::extractChannels(block, channelIndices, output);
+        }
+        else {
+            cv::Mat blockResized;
+            cv::resize(block, blockResized, blockSize);
+            Tools::extractChannels(blockResized, channelIndices, output);
+        }
     } else {
         RAISE_RUNTIME_ERROR << "NDPIScene::readResampledBlockChannels: Unexpected directory type: " << dir.getType();
     }
 }
 
+void NDPIScene::setLevelCacheLimit(size_t limit)
+{
+    std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+    m_levelCacheLimit = limit;
+    evictLevels();
+}
+
+size_t NDPIScene::getLevelCacheLimit() const
+{
+    std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+    return m_levelCacheLimit;
+}
+
+void NDPIScene::setMaxCachedLevelSize(size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+    m_maxCachedLevelSize = size;
+}
+
+size_t NDPIScene::getMaxCachedLevelSize() const
+{
+    std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+    return m_maxCachedLevelSize;
+}
+
+size_t NDPIScene::getLevelCacheSize() const
+{
+    std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+    return m_levelCacheSize;
+}
+
+void NDPIScene::evictLevels()
+{
+    while (m_levelCacheSize > m_levelCacheLimit && !m_levelCache.empty()) {
+        m_levelCacheSize -= m_levelCache.back().second->getMemorySize();
+        m_levelCache.pop_back();
+    }
+}
+
+std::shared_ptr<CacheManager> NDPIScene::findLevelCache(int dirIndex)
+{
+    std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+    for (auto it = m_levelCache.begin(); it != m_levelCache.end(); ++it) {
+        if (it->first == dirIndex) {
+            m_levelCache.splice(m_levelCache.begin(), m_levelCache, it);
+            return m_levelCache.front().second;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<CacheManager> NDPIScene::getLevelCache(const NDPITiffDirectory& dir)
+{
+    const size_t levelSize = static_cast<size_t>(dir.width) * dir.height * dir.channels
+        * ImageTools::dataTypeSize(dir.dataType);
+    std::shared_ptr<std::mutex> decodeMutex;
+    {
+        std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+        if (levelSize > m_maxCachedLevelSize || levelSize > m_levelCacheLimit) {
+            return nullptr;
+        }
+        auto& dirMutex = m_levelDecodeMutexes[dir.dirIndex];
+        if (!dirMutex) {
+            dirMutex = std::make_shared<std::mutex>();
+        }
+        decodeMutex = dirMutex;
+    }
+    std::shared_ptr<CacheManager> cache = findLevelCache(dir.dirIndex);
+    if (cache) {
+        return cache;
+    }
+    // concurrent requests of the same level wait for a single decoding,
+    // different levels are decoded in parallel
+    std::lock_guard<std::mutex> decodeLock(*decodeMutex);
+    cache = findLevelCache(dir.dirIndex);
+    if (cache) {
+        return cache;
+    }
+    cache = std::make_shared<CacheManager>();
+    cacheLevel(dir, *cache);
+    if (cache->getTileCount(dir.dirIndex) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_levelCacheMutex);
+    m_levelCache.emplace_front(dir.dirIndex, cache);
+    m_levelCacheSize += cache->getMemorySize();
+    evictLevels();
+    return cache;
+}
+
+void NDPIScene::cacheLevel(const NDPITiffDirectory& dir, CacheManager& cache)
+{
+    const cv::Rect levelRect(0, 0, dir.width, dir.height);
+    cv::Mat raster;
+    if (!m_pfile->readJpegRestartRegion(dir, levelRect, raster)) {
+        auto hFile = m_pfile->acquireTiffHandle(dir);
+        NDPITiffTools::readStripedDir(hFile->getHandle(), dir, raster);
+    }
+    const cv::Size tileSize(LEVEL_CACHE_TILE_SIZE, LEVEL_CACHE_TILE_SIZE);
+    BlockTiler tiler(raster, tileSize);
+    tiler.apply([&cache, &dir, &tileSize](int x, int y, const cv::Mat& tile) {
+        cache.addTile(dir.dirIndex, { x * tileSize.width, y * tileSize.height }, tile);
+    });
+}
+
+Compression NDPIScene::readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data)
+{
+    NDPITIFFMessageHandler mh;
+
+    if (zoomLevel < 0 || zoomLevel >= getNumZoomLevels()) {
+        RAISE_RUNTIME_ERROR << "NDPIImageDriver: Invalid zoom level: " << zoomLevel
+            << ". Expected range: [0," << getNumZoomLevels() << ")";
+    }
+    const NDPITiffDirectory& dir = m_pfile->directories()[m_startDir + zoomLevel];
+    switch (dir.getType()) {
+    case NDPITiffDirectory::Type::Tiled: {
+        auto hFile = m_pfile->acquireTiffHandle(dir);
+        return NDPITiffTools::readRawTile(hFile->getHandle(), dir, tileIndex, data);
+    }
+    case NDPITiffDirectory::Type::SingleStripeMCU: {
+        NDPITiffTools::readMCUTileData(m_pfile->getFile(), dir, tileIndex, data);
+        return Compression::Jpeg;
+    }
+    default:
+        RAISE_RUNTIME_ERROR << "NDPIImageDriver: raw tiles are not available for directories of type "
+            << dir.getType() << ". File: " << getFilePath();
+    }
+}
+
 int NDPIScene::getTileCount(void* userData)
 {
     const NDPIUserData* data = static_cast<const NDPIUserData*>(userData);
@@ -280,6 +463,86 @@ bool NDPIScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userData)
     return false;
 }
 
+void NDPIScene::getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData)
+{
+    const NDPIUserData* data = static_cast<const NDPIUserData*>(userData);
+    const NDPITiffDirectory* dir = data->dir();
+    switch (dir->getType()) {
+    case NDPITiffDirectory::Type::Tiled:
+    case NDPITiffDirectory::Type::SingleStripeMCU:
+        TileComposer::getGridTilesInRect(rect, { dir->width, dir->height }, { dir->tileWidth, dir->tileHeight }, tileIndices);
+        break;
+    case NDPITiffDirectory::Type::Striped:
+        // a stripe spans the whole directory width
+        TileComposer::getGridTilesInRect(rect, { dir->width, dir->height }, { dir->width, dir->rowsPerStrip }, tileIndices);
+        break;
+    default:
+        Tiler::getTilesInRect(rect, tileIndices, userData);
+        break;
+    }
+}
+
+bool NDPIScene::supportsConcurrentReads(void*)
+{
+    // libtiff reads borrow pinned handles from the file pool,
+    // MCU tiles are read with positioned reads of the shared file handle
+    return true;
+}
+
+bool NDPIScene::supportsReducedReads(void* userData)
+{
+    // jpeg tiles and restart intervals are reduced in the inverse DCT
+    const NDPITiffDirectory* dir = static_cast<const NDPIUserData*>(userData)->dir();
+    switch (dir->getType()) {
+    case NDPITiffDirectory::Type::SingleStripeMCU:
+        return true;
+    case NDPITiffDirectory::Type::Tiled:
+        return dir->compression == 7 && dir->dataType == DataType::DT_Byte;
+    default:
+        return false;
+    }
+}
+
+bool NDPIScene::readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+    cv::OutputArray tileRaster, void* userData)
+{
+    NDPITIFFMessageHandler mh;
+
+    const NDPIUserData* data = static_cast<const NDPIUserData*>(userData);
+    const NDPITiffDirectory* dir = data->dir();
+    try {
+        cv::Mat reducedRaster;
+        if (dir->getType() == NDPITiffDirectory::Type::SingleStripeMCU) {
+            NDPITiffTools::readMCUTile(m_pfile->getFile(), *dir, tileIndex, reducedRaster, reduction);
+        }
+        else {
+            std::vector<uint8_t> stream;
+            {
+                auto hFile = m_pfile->acquireTiffHandle(*dir);
+                NDPITiffTools::readRawTile(hFile->getHandle(), *dir, tileIndex, stream);
+            }
+            ImageTools::decodeJpegStream(stream.data(), stream.size(), reducedRaster, reduction);
+        }
+        if (reducedRaster.channels() == dir->channels) {
+            Tools::extractChannels(reducedRaster, channelIndices, tileRaster);
+            return true;
+        }
+    }
+    catch (std::runtime_error&) {
+        SLIDEIO_LOG(WARNING) << "NDPIScene::readReducedTile: Cannot decode reduced tile " << tileIndex
+            << " from directory " << dir->dirIndex << ". Reading the full tile.";
+    }
+    return readTile(tileIndex, channelIndices, tileRaster, userData);
+}
+
+bool NDPIScene::getTileCacheKey(void* userData, TileCacheKey& key)
+{
+    const NDPIUserData* data = static_cast<const NDPIUserData*>(userData);
+    key.filePath = getFilePath();
+    key.level = data->dir()->dirIndex;
+    return true;
+}
+
 void NDPIScene::makeSureValidDirectoryType(NDPITiffDirectory::Type directoryType) {
     switch (directoryType) {
     case NDPITiffDirectory::Type::Tiled:
@@ -308,28 +571,34 @@ bool NDPIScene::readTile(int tileIndex, const std::vector<int>& channelIndices,
     try {
         switch (directoryType) {
         case NDPITiffDirectory::Type::Tiled: {
-            NDPITiffTools::readTile(m_pfile->getTiffHandle(), *dir, tileIndex, channelIndices, tileRaster);
+            auto hFile = m_pfile->acquireTiffHandle(*dir);
+            NDPITiffTools::readTile(hFile->getHandle(), *dir, tileIndex, channelIndices, tileRaster);
             ret = true;
             break;
         }
         case NDPITiffDirectory::Type::SingleStripeMCU: {
             cv::Mat stripRaster;
-            NDPITiffTools::readMCUTile(data->file(), *dir, tileIndex, stripRaster);
+            NDPITiffTools::readMCUTile(m_pfile->getFile(), *dir, tileIndex, stripRaster);
             Tools::extractChannels(stripRaster, channelIndices, tileRaster);
             ret = true;
             break;
         }
         case NDPITiffDirectory::Type::Striped: {
-            NDPITiffTools::readStripe(m_pfile->getTiffHandle(), *dir, tileIndex, channelIndices, tileRaster);
+            auto hFile = m_pfile->acquireTiffHandle(*dir);
+            NDPITiffTools::readStripe(hFile->getHandle(), *dir, tileIndex, channelIndices, tileRaster);
             ret = true;
             break;
         }
         case NDPITiffDirectory::Type::SingleStripe: {
-            cv::Mat raster;
-            NDPITiffTools::readStripedDir(m_pfile->getTiffHandle(), *dir, raster);
             cv::Rect tileRect;
             if(getTileRect(tileIndex,tileRect, userData)) {
-                cv::Mat blockRaster(raster, tileRect);
+                cv::Mat blockRaster;
+                if (!data->file() || !m_pfile->readJpegRestartRegion(*dir, tileRect, blockRaster)) {
+                    cv::Mat raster;
+                    auto hFile = m_pfile->acquireTiffHandle(*dir);
+                    NDPITiffTools::readStripedDir(hFile->getHandle(), *dir, raster);
+                    blockRaster = cv::Mat(raster, tileRect);
+                }
                 Tools::extractChannels(blockRaster, channelIndices, tileRaster);
                 ret = true;
             }
@@ -4,6 +4,11 @@
 #ifndef OPENCV_slideio_ndpiscene_HPP
 #define OPENCV_slideio_ndpiscene_HPP
 
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include "ndpitifftools.hpp"
 #include "slideio/drivers/ndpi/ndpi_api_def.hpp"
 #include "slideio/core/cvscene.hpp"
@@ -44,19 +49,54 @@ namespace slideio
                                         cv::OutputArray output) override;
         const NDPITiffDirectory& findZoomDirectory(const cv::Rect& imageBlockRect, const cv::Size& requiredBlockSize) const;
         void scaleBlockToDirectory(const cv::Rect& imageBlockRect, const slideio::NDPITiffDirectory& dir, cv::Rect& dirBlockRect) const;
+        Compression readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data) override;
         int getTileCount(void* userData) override;
         bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
+        void getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData) override;
         bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
                       void* userData) override;
+        bool supportsConcurrentReads(void* userData) override;
+        bool supportsReducedReads(void* userData) override;
+        bool readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+            cv::OutputArray tileRaster, void* userData) override;
+        bool getTileCacheKey(void* userData, TileCacheKey& key) override;
         void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output) override;
+        // Single stripe levels are decoded once and kept in memory while their total size
+        // does not exceed the limit (in bytes). Least recently used levels are evicted first.
+        // Zero limit disables the cache.
+        void setLevelCacheLimit(size_t limit);
+        size_t getLevelCacheLimit() const;
+        // levels with a bigger decoded size (in bytes) are not cached: their regions are decoded on request
+        void setMaxCachedLevelSize(size_t size);
+        size_t getMaxCachedLevelSize() const;
+        size_t getLevelCacheSize() const;
+    protected:
+        void readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, cv::OutputArray output) override;
+        void readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+            const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters) override;
     private:
+        void readDirectoryBlock(const NDPITiffDirectory& dir, const cv::Rect& dirBlockRect, const cv::Size& blockSize,
+            const std::vector<int>& channelIndices, cv::OutputArray output);
         void makeSureValidDirectoryType(NDPITiffDirectory::Type directoryType);
+        std::shared_ptr<CacheManager> getLevelCache(const NDPITiffDirectory& dir);
+        std::shared_ptr<CacheManager> findLevelCache(int dirIndex);
+        void cacheLevel(const NDPITiffDirectory& dir, CacheManager& cache);
+        void evictLevels();
     protected:
         NDPIFile* m_pfile;
         int m_startDir;
         int m_endDir;
         std::string m_sceneName;
         cv::Rect m_rect;
+        size_t m_levelCacheLimit;
+        size_t m_maxCachedLevelSize;
+        size_t m_levelCacheSize;
+        // decoded levels, most recently used first
+        std::list<std::pair<int, std::shared_ptr<CacheManager>>> m_levelCache;
+        mutable std::mutex m_levelCacheMutex;
+        // serialize decoding of the same level
+        std::map<int, std::shared_ptr<std::mutex>> m_levelDecodeMutexes;
     };
 
 }
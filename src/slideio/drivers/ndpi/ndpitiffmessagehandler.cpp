@@ -2,6 +2,7 @@
 // It is subject to the license terms in the LICENSE file found in the top-level directory
 // of this distribution and at http://slideio.com/license.html.
 #include <stdlib.h>
+#include <mutex>
 #include "slideio/drivers/ndpi/ndpitiffmessagehandler.hpp"
 #include "slideio/base/log.hpp"
 #include "slideio/base/exceptions.hpp"
@@ -59,12 +60,23 @@ void NDPITIFFErrorHandler(const char *module, const char *fmt, va_list ap) {
     }
 }
 
+static std::mutex handlerMutex;
+static int handlerCounter = 0;
+static TIFFErrorHandler oldErrorHandler = nullptr;
+static TIFFErrorHandler oldWarningHandler = nullptr;
+
 NDPITIFFMessageHandler::NDPITIFFMessageHandler() {
-    m_oldErrorHandler = (void*)TIFFSetErrorHandler(NDPITIFFErrorHandler);
-    m_oldWarningHandler = (void*)TIFFSetWarningHandler(NDPITIFFWarningHandler);
+    std::lock_guard<std::mutex> lock(handlerMutex);
+    if (handlerCounter++ == 0) {
+        oldErrorHandler = TIFFSetErrorHandler(NDPITIFFErrorHandler);
+        oldWarningHandler = TIFFSetWarningHandler(NDPITIFFWarningHandler);
+    }
 }
 
 NDPITIFFMessageHandler::~NDPITIFFMessageHandler() {
-    TIFFSetErrorHandler((TIFFErrorHandler)m_oldErrorHandler);
-    TIFFSetWarningHandler((TIFFErrorHandler)m_oldWarningHandler);
+    std::lock_guard<std::mutex> lock(handlerMutex);
+    if (--handlerCounter == 0) {
+        TIFFSetErrorHandler(oldErrorHandler);
+        TIFFSetWarningHandler(oldWarningHandler);
+    }
 }
@@ -7,14 +7,14 @@
 
 namespace slideio {
 
+    // Installs slideio handlers of libtiff messages for the lifetime of the object.
+    // libtiff handlers are global: nested and concurrent instances share one installation,
+    // the previous handlers are restored when the last instance is destroyed.
     class NDPITIFFMessageHandler
     {
     public:
         NDPITIFFMessageHandler();
         ~NDPITIFFMessageHandler();
-    private:
-        void* m_oldWarningHandler;
-        void* m_oldErrorHandler;
     };
 }
 
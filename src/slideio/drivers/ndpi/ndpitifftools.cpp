@@ -15,19 +15,28 @@
 #include "slideio/drivers/ndpi/ndpitifftools.hpp"
 
 #include <codecvt>
+#include <limits>
 #include <opencv2/imgproc.hpp>
 
 #include "slideio/imagetools/cvtools.hpp"
+#include "slideio/base/scratchbuffer.hpp"
 #include "jpeglib.h"
 #include "ndpifile.hpp"
 #include "slideio/core/tools/blocktiler.hpp"
 #include "slideio/core/tools/cachemanager.hpp"
+#include "slideio/core/tools/positionalfile.hpp"
 #include "slideio/imagetools/imagetools.hpp"
+#include "slideio/imagetools/tifftools.hpp"
+#include "slideio/imagetools/tiffifdparser.hpp"
+#include "slideio/imagetools/tiffdirectorytracker.hpp"
 
 const int NDPI_RESTART_MARKERS = 65426;
 
 using namespace slideio;
 
+// channels of RGBA rasters delivered by libtiff
+static const std::vector<int> RGB_CHANNELS = { 0, 1, 2 };
+
 
 static int getCvType(jpegxr_image_info& info)
 {
@@ -267,71 +276,25 @@ libtiff::TIFF* slideio::NDPITiffTools::openTiffFile(const std::string& path)
 
 void slideio::NDPITiffTools::closeTiffFile(libtiff::TIFF* file)
 {
-    libtiff::TIFFClose(file);
+    if (file) {
+        TIFFDirectoryTracker::forget(file);
+        libtiff::TIFFClose(file);
+    }
 }
 
 
+// the tags are read with the ndpi libtiff: its handles must not be passed to TiffTools
 static slideio::DataType retrieveTiffDataType(libtiff::TIFF* tiff)
 {
     int bitsPerSample = 0;
     int sampleFormat = 0;
-
-    slideio::DataType dataType = slideio::DataType::DT_Unknown;
     if (!libtiff::TIFFGetField(tiff, TIFFTAG_BITSPERSAMPLE, &bitsPerSample)) {
         RAISE_RUNTIME_ERROR << "Cannot retrieve bits per sample from tiff image";
     }
     if (!libtiff::TIFFGetField(tiff, TIFFTAG_SAMPLEFORMAT, &sampleFormat)) {
         sampleFormat = SAMPLEFORMAT_UINT;
     }
-
-    if (bitsPerSample == 8) {
-        if (sampleFormat == SAMPLEFORMAT_UINT) {
-            dataType = slideio::DataType::DT_Byte;
-        }
-        else if (sampleFormat == SAMPLEFORMAT_INT) {
-            dataType = slideio::DataType::DT_Int8;
-        }
-        else {
-            RAISE_RUNTIME_ERROR << "Unsupported sample format for 8bit images: " << sampleFormat;
-        }
-    }
-    else if (bitsPerSample == 16) {
-        if (sampleFormat == SAMPLEFORMAT_UINT) {
-            dataType = slideio::DataType::DT_UInt16;
-        }
-        else if (sampleFormat == SAMPLEFORMAT_INT) {
-            dataType = slideio::DataType::DT_Int16;
-        }
-        else if (sampleFormat == SAMPLEFORMAT_IEEEFP) {
-            dataType = slideio::DataType::DT_Float16;
-        }
-        else {
-            RAISE_RUNTIME_ERROR << "Unsupported sample format for 16bit images: " << sampleFormat;
-        }
-    }
-    else if (bitsPerSample == 32) {
-        if (sampleFormat == SAMPLEFORMAT_INT) {
-            dataType = slideio::DataType::DT_Int32;
-        }
-        else if (sampleFormat == SAMPLEFORMAT_IEEEFP) {
-            dataType = slideio::DataType::DT_Float32;
-        }
-        else {
-            RAISE_RUNTIME_ERROR << "Unsupported sample format for 32bit images: " << sampleFormat;
-        }
-    }
-    else if (bitsPerSample == 64) {
-        if (sampleFormat == SAMPLEFORMAT_IEEEFP) {
-            dataType = slideio::DataType::DT_Float64;
-        }
-        else {
-            RAISE_RUNTIME_ERROR << "Unsupported sample format for 64bit images: " << sampleFormat;
-        }
-    }
-    else {
-        RAISE_RUNTIME_ERROR << "Unsupported bits per sample: " << bitsPerSample;
-    }
-    return dataType;
+    return slideio::TiffTools::tiffDataType(bitsPerSample, sampleFormat);
 }
 
 void slideio::NDPITiffTools::scanTiffDirTags(libtiff::TIFF* tiff, int dirIndex, int64_t dirOffset,
@@ -427,26 +390,11 @@ void slideio::NDPITiffTools::scanTiffDirTags(libtiff::TIFF* tiff, int dirIndex,
     dir.dataType = retrieveTiffDataType(tiff);
 
     short YCbCrSubsampling[2] = {2, 2};
-    libtiff::TIFFGetField(tiff, TIFFTAG_YCBCRSUBSAMPLING, &YCbCrSubsampling[0], &YCbCrSubsampling[0]);
+    libtiff::TIFFGetField(tiff, TIFFTAG_YCBCRSUBSAMPLING, &YCbCrSubsampling[0], &YCbCrSubsampling[1]);
     dir.YCbCrSubsampling[0] = YCbCrSubsampling[0];
     dir.YCbCrSubsampling[1] = YCbCrSubsampling[1];
 
-    if (units == RESUNIT_INCH && resx > 0 && resy > 0) {
-        dir.res.x = 0.01 / resx;
-        dir.res.y = 0.01 / resy;
-    }
-    else if (units == RESUNIT_INCH && resx > 0 && resy > 0) {
-        dir.res.x = 0.0254 / resx;
-        dir.res.y = 0.0254 / resy;
-    }
-    else if (units == RESUNIT_CENTIMETER && resx > 0 && resy > 0) {
-        dir.res.x = 0.01 / resx;
-        dir.res.y = 0.01 / resy;
-    }
-    else {
-        dir.res.x = resx;
-        dir.res.y = resy;
-    }
+    dir.res = TiffTools::tiffResolution(units, resx, resy);
     dir.position = {posx, posy};
     bool tiled = libtiff::TIFFIsTiled(tiff);
     if (description)
@@ -531,17 +479,115 @@ void slideio::NDPITiffTools::scanTiffDir(libtiff::TIFF* tiff, int dirIndex, int6
         }
         for (int subdir = 0; subdir < subdirs; subdir++) {
             if (libtiff::TIFFSetSubDirectory(tiff, offsets[subdir])) {
-                scanTiffDirTags(tiff, dirIndex, dir.subdirectories[subdir].offset, dir.subdirectories[subdir]);
+                scanTiffDirTags(tiff, dirIndex, offsets[subdir], dir.subdirectories[subdir]);
             }
         }
     }
     SLIDEIO_LOG(INFO) << "NDPITiffTools::scanTiffDir-end " << dir.dirIndex;
 }
 
+void NDPITiffTools::scanTiffDirTags(const TiffIFDParser& parser, const TiffIFD& ifd, int dirIndex, int64_t dirOffset,
+                                    NDPITiffDirectory& dir)
+{
+    dir.dirIndex = dirIndex;
+    dir.offset = dirOffset;
+
+    uint64_t value = 0;
+    double number = 0;
+    auto getInt = [&parser, &ifd, &value](uint16_t tag, int defaultValue) {
+        return parser.getUInt(ifd, tag, value) ? static_cast<int>(value) : defaultValue;
+    };
+    auto getFloat = [&parser, &ifd, &number](uint16_t tag) {
+        return parser.getDouble(ifd, tag, number) ? static_cast<float>(number) : 0.f;
+    };
+    // defaults of absent tags follow the libtiff based scanning
+    dir.photometric = getInt(TIFFTAG_PHOTOMETRIC, 0);
+    dir.channels = getInt(TIFFTAG_SAMPLESPERPIXEL, 0);
+    if (dir.channels == 0 && (dir.photometric == 0 || dir.photometric == 1)) {
+        dir.channels = 1;
+    }
+    dir.bitsPerSample = getInt(TIFFTAG_BITSPERSAMPLE, 0);
+    dir.compression = static_cast<uint32_t>(getInt(TIFFTAG_COMPRESSION, COMPRESSION_NONE));
+    dir.width = getInt(TIFFTAG_IMAGEWIDTH, 0);
+    dir.height = getInt(TIFFTAG_IMAGELENGTH, 0);
+    dir.tiled = ifd.findEntry(TIFFTAG_TILEWIDTH) != nullptr;
+    dir.tileWidth = getInt(TIFFTAG_TILEWIDTH, 0);
+    dir.tileHeight = getInt(TIFFTAG_TILELENGTH, 0);
+    dir.interleaved = getInt(TIFFTAG_PLANARCONFIG, 0) == PLANARCONFIG_CONTIG;
+    dir.rowsPerStrip = getInt(TIFFTAG_ROWSPERSTRIP, dir.tiled ? 0 : dir.height);
+    dir.YCbCrSubsampling[0] = 2;
+    dir.YCbCrSubsampling[1] = 2;
+    if (parser.getUInt(ifd, TIFFTAG_YCBCRSUBSAMPLING, value, 0)) {
+        dir.YCbCrSubsampling[0] = static_cast<int>(value);
+    }
+    if (parser.getUInt(ifd, TIFFTAG_YCBCRSUBSAMPLING, value, 1)) {
+        dir.YCbCrSubsampling[1] = static_cast<int>(value);
+    }
+    dir.dataType = TiffTools::tiffDataType(dir.bitsPerSample, getInt(TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_UINT));
+    dir.slideioCompression = compressTiffToSlideio(dir.compression);
+    const uint16_t units = static_cast<uint16_t>(getInt(TIFFTAG_RESOLUTIONUNIT, 0));
+    dir.res = TiffTools::tiffResolution(units, getFloat(TIFFTAG_XRESOLUTION), getFloat(TIFFTAG_YRESOLUTION));
+    const float posx = getFloat(TIFFTAG_XPOSITION);
+    const float posy = getFloat(TIFFTAG_YPOSITION);
+    dir.position = {posx, posy};
+    dir.description.clear();
+    dir.userLabel.clear();
+    dir.comments.clear();
+    parser.getLazyString(ifd, TIFFTAG_IMAGEDESCRIPTION, dir.description);
+    parser.getString(ifd, NDPITAG_USERGIVENSLIDELABEL, dir.userLabel);
+    parser.getString(ifd, NDPITAG_COMMENTS, dir.comments);
+    dir.magnification = 0;
+    if (parser.getDouble(ifd, NDPITAG_MAGNIFICATION, number)) {
+        dir.magnification = static_cast<float>(number);
+        if (dir.magnification < 0) {
+            dir.auxImage = true;
+        }
+    }
+    const TiffIFDEntry* blankLines = ifd.findEntry(NDPITAG_BLANKLANES);
+    dir.blankLines = blankLines ? static_cast<uint32_t>(blankLines->count) : 0;
+    if (parser.getUInt(ifd, TIFFTAG_STRIPBYTECOUNTS, value)) {
+        dir.rawStripSize = static_cast<uint32_t>(value);
+    }
+    TiffTools::computeStripLayout(dir);
+
+    // restart marker offsets are relative to the first strip: 32-bit values as libtiff reports them
+    std::vector<uint64_t> markers;
+    uint64_t stripOffset = 0;
+    dir.mcuStarts.clear();
+    if (parser.getUInts(ifd, NDPI_RESTART_MARKERS, markers) && !markers.empty()
+        && parser.getUInt(ifd, TIFFTAG_STRIPOFFSETS, stripOffset)) {
+        dir.mcuStarts.reserve(markers.size());
+        for (uint64_t marker : markers) {
+            dir.mcuStarts.push_back(static_cast<uint32_t>(marker) + static_cast<uint32_t>(stripOffset));
+        }
+    }
+}
+
+void NDPITiffTools::scanTiffDir(const TiffIFDParser& parser, libtiff::TIFF* tiff, int dirIndex,
+                                NDPITiffDirectory& dir)
+{
+    const TiffIFD& ifd = parser.getDirectory(dirIndex);
+    scanTiffDirTags(parser, ifd, dirIndex, 0, dir);
+    // jpegxr metadata is stored in the codestream only
+    if (dir.slideioCompression == Compression::JpegXR) {
+        setCurrentDirectory(tiff, dir);
+        updateJpegXRCompressedDirectoryMedatata(tiff, dir);
+    }
+    dir.subdirectories.clear();
+    std::vector<uint64_t> offsets;
+    if (parser.getUInts(ifd, TIFFTAG_SUBIFD, offsets) && !offsets.empty()) {
+        dir.subdirectories.resize(offsets.size());
+        for (size_t subdir = 0; subdir < offsets.size(); ++subdir) {
+            const int64_t offset = static_cast<int64_t>(offsets[subdir]);
+            scanTiffDirTags(parser, parser.readDirectory(offset), dirIndex, offset, dir.subdirectories[subdir]);
+        }
+    }
+}
+
 
 void NDPITiffTools::readNotRGBStripedDir(libtiff::TIFF* file, const NDPITiffDirectory& dir, cv::_OutputArray output)
 {
-    std::vector<uint8_t> rgbaRaster(4 * dir.rowsPerStrip * dir.width);
+    ScratchBuffer rgbaRaster(4 * static_cast<size_t>(dir.rowsPerStrip) * dir.width);
 
     int buff_size = dir.width * dir.height * dir.channels * ImageTools::dataTypeSize(dir.dataType);
     cv::Size sizeImage = {dir.width, dir.height};
@@ -616,7 +662,7 @@ void NDPITiffTools::readJpegXRStripedDir(libtiff::TIFF* tiff, const NDPITiffDire
         setCurrentDirectory(tiff, dir);
     	// process interleaved channels
 		const int tileBufferSize = dir.channels * dir.width * dir.height * ImageTools::dataTypeSize(dir.dataType);
-		std::vector<uint8_t> rawTile(tileBufferSize);
+		ScratchBuffer rawTile(tileBufferSize);
 		const size_t readBytes = libtiff::TIFFReadRawStrip(tiff, 0, rawTile.data(), static_cast<int>(rawTile.size()));
 		if (readBytes <= 0) {
 		    RAISE_RUNTIME_ERROR << "TiffTools: Error reading raw tile";
@@ -656,7 +702,7 @@ void NDPITiffTools::readJpegXRTile(libtiff::TIFF* tiff, const slideio::NDPITiffD
 {
     cv::Size tileSize = computeTileSize(dir, tile);
     const int tileBufferSize = dir.channels * tileSize.width * tileSize.height * ImageTools::dataTypeSize(dir.dataType);
-    std::vector<uint8_t> rawTile(tileBufferSize);
+    ScratchBuffer rawTile(tileBufferSize);
     if (dir.interleaved) {
         // process interleaved channels
         libtiff::tmsize_t readBytes = libtiff::TIFFReadRawTile(tiff, tile, rawTile.data(), (int)rawTile.size());
@@ -764,6 +810,9 @@ void NDPITiffTools::readJpegScanlines(libtiff::TIFF* tiff, FILE* file, const NDP
     if(dir.slideioCompression != Compression::Jpeg) {
         RAISE_RUNTIME_ERROR << "NDPITiffTools::readJpegScanlines: Attempt to read jpeg scanlines from non jpeg directory";
     }
+    if (readJpegRestartRegion(file, dir, cv::Rect(0, firstScanline, dir.width, numberScanlines), output)) {
+        return;
+    }
 
     setCurrentDirectory(tiff, dir);
 
@@ -930,14 +979,22 @@ void NDPITiffTools::readJpegDirectoryRegion(libtiff::TIFF* tiff, const std::stri
         RAISE_RUNTIME_ERROR << "One strip directory is expected. Rows per strip: " << dir.rowsPerStrip << ". Height:" <<
             dir.height;
     }
-    setCurrentDirectory(tiff, dir);
-
     std::unique_ptr<FILE, Tools::FileDeleter> sfile(Tools::openFile(filePath.c_str(), "rb"));
     FILE* file = sfile.get();
     if (!file) {
         RAISE_RUNTIME_ERROR << "NDPI Image Driver: Cannot open file " << filePath;
     }
 
+    // only the restart intervals covering the region are read and decoded
+    cv::Mat regionRaster;
+    if (readJpegRestartRegion(file, dir, region, regionRaster)) {
+        Tools::extractChannels(regionRaster, channelIndices, output);
+        return;
+    }
+
+    // without restart markers the strip is decoded sequentially up to the bottom of the region
+    setCurrentDirectory(tiff, dir);
+
     const bool allChannels = Tools::isCompleteChannelList(channelIndices, dir.channels);
 
     const slideio::DataType dt = dir.dataType;
@@ -1042,39 +1099,144 @@ void NDPITiffTools::readJpegDirectoryRegion(libtiff::TIFF* tiff, const std::stri
 void NDPITiffTools::readDirectoryJpegHeaders(NDPIFile* ndpi, NDPITiffDirectory& dir)
 {
     if (dir.height == dir.rowsPerStrip && !dir.mcuStarts.empty()) {
-        const auto dirIndex = dir.dirIndex;
+        readStripJpegHeader(ndpi, dir);
+    }
+    else if (!dir.tiled && dir.height == dir.rowsPerStrip && dir.slideioCompression == Compression::Jpeg) {
+        // strips without the restart marker tag are scanned for the markers by the first
+        // region read (see NDPIFile::readJpegRestartRegion)
+        try {
+            readStripJpegHeader(ndpi, dir);
+        }
+        catch (std::runtime_error& ex) {
+            SLIDEIO_LOG(WARNING) << "NDPITiffTools::readDirectoryJpegHeaders: cannot read jpeg header of directory "
+                << dir.dirIndex << ": " << ex.what();
+            dir.jpegHeader.clear();
+        }
+    }
+}
 
-        libtiff::TIFF* tiff = ndpi->getTiffHandle();
-        setCurrentDirectory(tiff, dir);
+void NDPITiffTools::readStripJpegHeader(NDPIFile* ndpi, NDPITiffDirectory& dir)
+{
+    const auto dirIndex = dir.dirIndex;
 
-        std::unique_ptr<FILE, Tools::FileDeleter> sfile(Tools::openFile(ndpi->getFilePath(), "rb"));
-        FILE* file = sfile.get();
-        if (!file) {
-            RAISE_RUNTIME_ERROR << "NDPI Image Driver: Cannot open file " << ndpi->getFilePath();
-        }
+    libtiff::TIFF* tiff = ndpi->getTiffHandle();
+    setCurrentDirectory(tiff, dir);
 
-        const auto stripeOffset = libtiff::TIFFGetStrileOffset(tiff, 0);
+    std::unique_ptr<FILE, Tools::FileDeleter> sfile(Tools::openFile(ndpi->getFilePath(), "rb"));
+    FILE* file = sfile.get();
+    if (!file) {
+        RAISE_RUNTIME_ERROR << "NDPI Image Driver: Cannot open file " << ndpi->getFilePath();
+    }
 
-        int ret = Tools::setFilePos(file, stripeOffset, SEEK_SET);
-        if (ret) {
-            RAISE_RUNTIME_ERROR << "NDPI Image Driver: Cannot seek file " << ndpi->getFilePath() << " to offset "
-                << stripeOffset << ". For directory " << dirIndex << ". Code: " << ret;
-        }
-        cv::Size tileSize = NDPITiffTools::computeMCUTileSize(file, cv::Size(dir.width, dir.height));
+    const auto stripeOffset = libtiff::TIFFGetStrileOffset(tiff, 0);
 
+    int ret = Tools::setFilePos(file, stripeOffset, SEEK_SET);
+    if (ret) {
+        RAISE_RUNTIME_ERROR << "NDPI Image Driver: Cannot seek file " << ndpi->getFilePath() << " to offset "
+            << stripeOffset << ". For directory " << dirIndex << ". Code: " << ret;
+    }
+    if (!dir.mcuStarts.empty()) {
+        cv::Size tileSize = NDPITiffTools::computeMCUTileSize(file, cv::Size(dir.width, dir.height));
+        dir.tileWidth = tileSize.width;
+        dir.tileHeight = tileSize.height;
         ret = Tools::setFilePos(file, stripeOffset, SEEK_SET);
         if (ret) {
             RAISE_RUNTIME_ERROR << "NDPI Image Driver: Cannot seek file " << ndpi->getFilePath() << " to offset "
                 << stripeOffset << ". For directory " << dirIndex << ". Code: " << ret;
         }
-        const std::pair<uint64_t, uint64_t> headerInfo = NDPITiffTools::getJpegHeaderPos(file);
-        dir.tileWidth = tileSize.width;
-        dir.tileHeight = tileSize.height;
-        dir.jpegHeaderOffset = stripeOffset;
-        dir.jpegHeaderSize = static_cast<uint32_t>(headerInfo.second - stripeOffset);
-        dir.jpegSOFMarker = headerInfo.first;
+    }
+    const std::pair<uint64_t, uint64_t> headerInfo = NDPITiffTools::getJpegHeaderPos(file);
+    dir.jpegHeaderOffset = stripeOffset;
+    dir.jpegHeaderSize = static_cast<uint32_t>(headerInfo.second - stripeOffset);
+    dir.jpegSOFMarker = headerInfo.first;
+
+    // the header is shared by all restart intervals of the strip: read it once
+    dir.jpegHeader.resize(dir.jpegHeaderSize);
+    Tools::setFilePos(file, stripeOffset, SEEK_SET);
+    const size_t count = fread(dir.jpegHeader.data(), sizeof(uint8_t), dir.jpegHeader.size(), file);
+    if (count != dir.jpegHeader.size()) {
+        RAISE_RUNTIME_ERROR << "NDPI Image Driver: error by reading jpeg header of directory " << dirIndex
+            << ". Expected:" << dir.jpegHeader.size() << ". Read:" << count;
+    }
+    fixJpegHeader(dir, dir.jpegHeader.data());
+}
+
+bool NDPITiffTools::scanRestartMarkers(const PositionalFile& file, const NDPITiffDirectory& dir,
+    std::vector<uint32_t>& mcuStarts)
+{
+    mcuStarts.clear();
+    if (dir.tiled || dir.slideioCompression != Compression::Jpeg || dir.jpegHeader.empty()) {
+        return false;
+    }
+    ImageTools::JpegRestartLayout layout;
+    if (!ImageTools::parseJpegRestartHeader(dir.jpegHeader.data(), dir.jpegHeader.size(),
+        cv::Size(dir.width, dir.height), layout)) {
+        return false;
+    }
+    const uint64_t dataEnd = dir.jpegHeaderOffset + dir.rawStripSize;
+    const bool found = ImageTools::scanJpegRestartMarkers([&file](uint64_t offset, size_t size, uint8_t* buffer) {
+        file.read(offset, size, buffer);
+    }, dir.jpegHeaderOffset + dir.jpegHeaderSize, dataEnd, layout);
+    // interval offsets are kept in 32 bits as the restart marker tag stores them
+    if (!found || layout.intervals.back() > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    mcuStarts.assign(layout.intervals.begin(), layout.intervals.end());
+    return true;
+}
+
+bool NDPITiffTools::readJpegRestartRegion(const PositionalFile& file, const NDPITiffDirectory& dir,
+    const cv::Rect& region, cv::OutputArray output)
+{
+    return readJpegRestartRegion(file, dir, dir.mcuStarts, region, output);
+}
 
+bool NDPITiffTools::readJpegRestartRegion(const PositionalFile& file, const NDPITiffDirectory& dir,
+    const std::vector<uint32_t>& mcuStarts, const cv::Rect& region, cv::OutputArray output)
+{
+    return readJpegRestartRegion([&file](uint64_t offset, size_t size, uint8_t* buffer) {
+        file.read(offset, size, buffer);
+    }, dir, mcuStarts, region, output);
+}
+
+bool NDPITiffTools::readJpegRestartRegion(FILE* file, const NDPITiffDirectory& dir, const cv::Rect& region,
+    cv::OutputArray output)
+{
+    if (file == nullptr) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: file pointer is not set";
     }
+    return readJpegRestartRegion([file](uint64_t offset, size_t size, uint8_t* buffer) {
+        Tools::setFilePos(file, offset, SEEK_SET);
+        const size_t count = fread(buffer, sizeof(uint8_t), size, file);
+        if (count != size) {
+            RAISE_RUNTIME_ERROR << "NDPITiffTools: error by reading jpeg data at offset " << offset
+                << ". Expected:" << size << ". Read:" << count;
+        }
+    }, dir, dir.mcuStarts, region, output);
+}
+
+bool NDPITiffTools::readJpegRestartRegion(const std::function<void(uint64_t, size_t, uint8_t*)>& read,
+    const NDPITiffDirectory& dir, const std::vector<uint32_t>& mcuStarts, const cv::Rect& region,
+    cv::OutputArray output)
+{
+    if (dir.tiled || dir.slideioCompression != Compression::Jpeg || mcuStarts.empty() || dir.jpegHeader.empty()) {
+        return false;
+    }
+    ImageTools::JpegRestartLayout layout;
+    if (!ImageTools::parseJpegRestartHeader(dir.jpegHeader.data(), dir.jpegHeader.size(),
+        cv::Size(dir.width, dir.height), layout)) {
+        return false;
+    }
+    const cv::Size& intervalSize = layout.intervalSize;
+    const size_t numIntervals = static_cast<size_t>((dir.width + intervalSize.width - 1) / intervalSize.width)
+        * ((dir.height + intervalSize.height - 1) / intervalSize.height);
+    if (numIntervals != mcuStarts.size()) {
+        return false;
+    }
+    layout.intervals.assign(mcuStarts.begin(), mcuStarts.end());
+    layout.dataEnd = dir.jpegHeaderOffset + dir.rawStripSize;
+    ImageTools::decodeJpegRestartRegion(layout, read, region, output);
+    return true;
 }
 
 void NDPITiffTools::readUncompressedScanlines(libtiff::TIFF* tiff, FILE* file, const NDPITiffDirectory& dir, int firstScanline,
@@ -1098,7 +1260,7 @@ void NDPITiffTools::readJpegXRStrip(libtiff::TIFF* tiff, const NDPITiffDirectory
 {
     const int lineCount = computeStripHeight(dir.height, dir.rowsPerStrip, strip);
     const int stripSize = dir.channels * lineCount * dir.width * ImageTools::dataTypeSize(dir.dataType);
-    std::vector<uint8_t> rawStrip(stripSize);
+    ScratchBuffer rawStrip(stripSize);
     if (dir.interleaved) {
         // process interleaved channels
         libtiff::tmsize_t readBytes = libtiff::TIFFReadRawStrip(tiff, strip, rawStrip.data(), (int)rawStrip.size());
@@ -1118,8 +1280,9 @@ void NDPITiffTools::readNotRGBStrip(libtiff::TIFF* hFile, const NDPITiffDirector
     const int lineCount = computeStripHeight(dir.height, dir.rowsPerStrip, strip);
     cv::Size stripSize = {dir.width, lineCount};
     slideio::DataType dt = dir.dataType;
-    cv::Mat stripRaster;
-    stripRaster.create(stripSize, CV_MAKETYPE(slideio::CVTools::toOpencvType(dt), 4));
+    const int stripType = CV_MAKETYPE(slideio::CVTools::toOpencvType(dt), 4);
+    ScratchBuffer stripBuffer(static_cast<size_t>(stripSize.area()) * CV_ELEM_SIZE(stripType));
+    cv::Mat stripRaster(stripSize, stripType, stripBuffer.data());
     setCurrentDirectory(hFile, dir);
     if (dir.offset > 0) {
         libtiff::TIFFSetSubDirectory(hFile, dir.offset);
@@ -1132,25 +1295,7 @@ void NDPITiffTools::readNotRGBStrip(libtiff::TIFF* hFile, const NDPITiffDirector
 
     }
 
-    if (channelIndices.empty()) {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(3);
-        for (int channelIndex = 0; channelIndex < 3; ++channelIndex) {
-            cv::extractChannel(stripRaster, channelRasters[channelIndex], channelIndex);
-        }
-        cv::merge(channelRasters, output);
-    }
-    else if (channelIndices.size() == 1) {
-        cv::extractChannel(stripRaster, output, channelIndices[0]);
-    }
-    else {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(channelIndices.size());
-        for (int channelIndex : channelIndices) {
-            cv::extractChannel(stripRaster, channelRasters[channelIndex], channelIndices[channelIndex]);
-        }
-        cv::merge(channelRasters, output);
-    }
+    slideio::CVTools::extractChannels(stripRaster, channelIndices.empty() ? RGB_CHANNELS : channelIndices, output);
 }
 
 void NDPITiffTools::readRegularStrip(libtiff::TIFF* tiff, const NDPITiffDirectory& dir, int strip,
@@ -1172,20 +1317,7 @@ void NDPITiffTools::readRegularStrip(libtiff::TIFF* tiff, const NDPITiffDirector
         RAISE_RUNTIME_ERROR << "NDPITiffTools: error reading encoded strip " << strip
             << " of directory " << dir.dirIndex << ". Compression: " << (int)(dir.compression);
     }
-    if (channelIndices.empty()) {
-        stripRaster.copyTo(output);
-    }
-    else if (channelIndices.size() == 1) {
-        cv::extractChannel(stripRaster, output, channelIndices[0]);
-    }
-    else {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(channelIndices.size());
-        for (int channelIndex : channelIndices) {
-            cv::extractChannel(stripRaster, channelRasters[channelIndex], channelIndices[channelIndex]);
-        }
-        cv::merge(channelRasters, output);
-    }
+    slideio::CVTools::extractChannels(stripRaster, channelIndices, output);
 }
 
 void NDPITiffTools::readStripe(libtiff::TIFF* hFile, const slideio::NDPITiffDirectory& dir, int strip,
@@ -1228,20 +1360,7 @@ void slideio::NDPITiffTools::readRegularTile(libtiff::TIFF* hFile, const slideio
         RAISE_RUNTIME_ERROR << "NDPITiffTools: error reading encoded tiff tile " << tile
             << " of directory " << dir.dirIndex << ". Compression: " << dir.compression;
     }
-    if (channelIndices.empty()) {
-        tileRaster.copyTo(output);
-    }
-    else if (channelIndices.size() == 1) {
-        cv::extractChannel(tileRaster, output, channelIndices[0]);
-    }
-    else {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(channelIndices.size());
-        for (int channelIndex : channelIndices) {
-            cv::extractChannel(tileRaster, channelRasters[channelIndex], channelIndices[channelIndex]);
-        }
-        cv::merge(channelRasters, output);
-    }
+    slideio::CVTools::extractChannels(tileRaster, channelIndices, output);
 }
 
 
@@ -1270,41 +1389,30 @@ void NDPITiffTools::readNotRGBTile(libtiff::TIFF* hFile, const slideio::NDPITiff
             << " of directory " << dir.dirIndex << " Compression: " << dir.compression;
     }
     cv::Mat flipped;
-    if (channelIndices.empty()) {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(3);
-        for (int channelIndex = 0; channelIndex < 3; ++channelIndex) {
-            cv::extractChannel(tileRaster, channelRasters[channelIndex], channelIndex);
-        }
-        cv::merge(channelRasters, flipped);
-    }
-    else if (channelIndices.size() == 1) {
-        cv::extractChannel(tileRaster, flipped, channelIndices[0]);
-    }
-    else {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(channelIndices.size());
-        for (int channelIndex : channelIndices) {
-            cv::extractChannel(tileRaster, channelRasters[channelIndex], channelIndices[channelIndex]);
-        }
-        cv::merge(channelRasters, flipped);
-    }
+    slideio::CVTools::extractChannels(tileRaster, channelIndices.empty() ? RGB_CHANNELS : channelIndices, flipped);
     cv::flip(flipped, output, 0);
 }
 
 
 void slideio::NDPITiffTools::setCurrentDirectory(libtiff::TIFF* hFile, const slideio::NDPITiffDirectory& dir)
 {
-    if (!libtiff::TIFFSetDirectory(hFile, static_cast<uint16_t>(dir.dirIndex))) {
-        RAISE_RUNTIME_ERROR << "NDPITiffTools: error by setting current directory " << dir.dirIndex;
+    // the directory index stays unchanged when a sub-directory is loaded:
+    // a switch is skipped only if the handle is still on the IFD loaded for the same (index, offset)
+    if (TIFFDirectoryTracker::isCurrent(hFile, dir.dirIndex, dir.offset, libtiff::TIFFCurrentDirOffset(hFile))) {
+        return;
     }
-    if (dir.offset > 0) {
-        if (!libtiff::TIFFSetSubDirectory(hFile, dir.offset)) {
-            RAISE_RUNTIME_ERROR << "NDPITiffTools: error by setting current sub-directory. Directory:"
-                << dir.dirIndex
-                << ".Offset:" << dir.offset;
+    TIFFDirectoryTracker::forget(hFile);
+    if (dir.offset <= 0) {
+        if (!libtiff::TIFFSetDirectory(hFile, static_cast<uint16_t>(dir.dirIndex))) {
+            RAISE_RUNTIME_ERROR << "NDPITiffTools: error by setting current directory " << dir.dirIndex;
         }
     }
+    else if (!libtiff::TIFFSetSubDirectory(hFile, dir.offset)) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: error by setting current sub-directory. Directory:"
+            << dir.dirIndex
+            << ".Offset:" << dir.offset;
+    }
+    TIFFDirectoryTracker::setCurrent(hFile, dir.dirIndex, dir.offset, libtiff::TIFFCurrentDirOffset(hFile));
 }
 
 void slideio::NDPITiffTools::decodeJxrBlock(const uint8_t* data, size_t dataBlockSize, cv::OutputArray output)
@@ -1411,18 +1519,25 @@ void NDPITiffTools::fixJpegHeader(const NDPITiffDirectory& dir, uint8_t* data) {
     }
 }
 
-void NDPITiffTools::readMCUTile(FILE* file, const NDPITiffDirectory& dir, int tile, cv::OutputArray output)
+void NDPITiffTools::readMCUTile(const PositionalFile& file, const NDPITiffDirectory& dir, int tile,
+    cv::OutputArray output, int scaleDenominator)
+{
+    std::vector<uint8_t> tileData;
+    readMCUTileData(file, dir, tile, tileData);
+    jpeglibDecodeTile(tileData.data(), tileData.size(), cv::Size(dir.tileWidth, dir.tileHeight), output,
+        scaleDenominator);
+}
+
+void NDPITiffTools::readMCUTileData(const PositionalFile& file, const NDPITiffDirectory& dir, int tile,
+    std::vector<uint8_t>& tileData)
 {
-    if(tile>=dir.mcuStarts.size()) {
+    if(tile < 0 || tile>=dir.mcuStarts.size()) {
         RAISE_RUNTIME_ERROR << "NDPITiffTools: tile index is out of range (0-"
             << dir.mcuStarts.size() << "). Received:" << tile;
     }
-    if(file ==nullptr) {
-        RAISE_RUNTIME_ERROR << "NDPITiffTools: file pointer is not set";
+    if(dir.jpegHeader.empty()) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: jpeg header of directory " << dir.dirIndex << " is not loaded";
     }
-    // read jpeg header
-    const uint64_t headerOffset = dir.jpegHeaderOffset;
-    const uint32_t headerSize = dir.jpegHeaderSize;
     const uint64_t tileOffset = dir.mcuStarts[tile];
 
     uint32_t tileSize = 0;
@@ -1433,32 +1548,61 @@ void NDPITiffTools::readMCUTile(FILE* file, const NDPITiffDirectory& dir, int ti
         uint64_t stripEndOffset = dir.jpegHeaderOffset + dir.rawStripSize;
         tileSize = static_cast<uint32_t>(stripEndOffset - tileOffset);
     }
-    std::vector<uint8_t> tileData(headerSize + tileSize);
-
-    Tools::setFilePos(file, headerOffset, SEEK_SET);
-    auto count = fread(tileData.data(), sizeof(uint8_t), headerSize, file);
-    if(count != headerSize) {
-        RAISE_RUNTIME_ERROR << "NDPITiffTools: error by reading jpeg header. Expected:" << headerSize << ". Read:" << count;
-    }
-
-    Tools::setFilePos(file, tileOffset, SEEK_SET);
-    count = fread(tileData.data() + headerSize, sizeof(uint8_t), tileSize, file);
-    if(count != tileSize) {
-        RAISE_RUNTIME_ERROR << "NDPITiffTools: error by reading jpeg tile. Expected:" << tileSize << ". Read:" << count;
-    }
+    const size_t headerSize = dir.jpegHeader.size();
+    tileData.resize(headerSize + tileSize);
+    std::copy(dir.jpegHeader.begin(), dir.jpegHeader.end(), tileData.begin());
+    file.read(tileOffset, tileSize, tileData.data() + headerSize);
     if(tileData[tileData.size() - 2] != 0xFF) {
         RAISE_RUNTIME_ERROR << "NDPITiffTools: error by reading jpeg tile. Expected 0xFF.";
     }
 
     tileData[tileData.size() - 1] = JPEG_EOI; // End of image marker
+}
 
-    fixJpegHeader(dir, (uint8_t*)tileData.data());
-    jpeglibDecodeTile(tileData.data(), tileData.size(), cv::Size(dir.tileWidth, dir.tileHeight), output);
-
+Compression NDPITiffTools::readRawTile(libtiff::TIFF* hFile, const NDPITiffDirectory& dir, int tile, std::vector<uint8_t>& data)
+{
+    if (!dir.tiled) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: Expected tiled configuration, received striped";
+    }
+    // the handle belongs to the ndpi libtiff: only the ndpi libtiff functions may be called for it
+    setCurrentDirectory(hFile, dir);
+    const int tileCount = static_cast<int>(libtiff::TIFFNumberOfTiles(hFile));
+    if (tile < 0 || tile >= tileCount) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: invalid tile index " << tile << " of directory " << dir.dirIndex
+            << ". Expected range: [0," << tileCount << ")";
+    }
+    uint64_t* byteCounts = nullptr;
+    if (!libtiff::TIFFGetField(hFile, TIFFTAG_TILEBYTECOUNTS, &byteCounts) || byteCounts == nullptr) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: cannot read tile byte counts of directory " << dir.dirIndex;
+    }
+    std::vector<uint8_t> rawTile(static_cast<size_t>(byteCounts[tile]));
+    const libtiff::tmsize_t readBytes = libtiff::TIFFReadRawTile(hFile, tile, rawTile.data(),
+        static_cast<libtiff::tmsize_t>(rawTile.size()));
+    if (readBytes <= 0) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: error reading raw tile " << tile << " of directory " << dir.dirIndex;
+    }
+    rawTile.resize(static_cast<size_t>(readBytes));
+    if (dir.compression == 7) {
+        uint32_t tablesSize = 0;
+        uint8_t* tables = nullptr;
+        if (!libtiff::TIFFGetField(hFile, TIFFTAG_JPEGTABLES, &tablesSize, &tables)) {
+            tablesSize = 0;
+            tables = nullptr;
+        }
+        ImageTools::makeStandaloneJpeg(tables, tablesSize, rawTile.data(), rawTile.size(), dir.photometric == 2, data);
+        return Compression::Jpeg;
+    }
+    data.swap(rawTile);
+    return dir.slideioCompression;
 }
 
-void NDPITiffTools::jpeglibDecodeTile(const uint8_t* jpg_buffer, size_t jpg_size, const cv::Size& tileSize, cv::OutputArray output)
+void NDPITiffTools::jpeglibDecodeTile(const uint8_t* jpg_buffer, size_t jpg_size, const cv::Size& tileSize, cv::OutputArray output,
+    int scaleDenominator)
 {
+    if (scaleDenominator != 1 && scaleDenominator != 2 && scaleDenominator != 4 && scaleDenominator != 8) {
+        RAISE_RUNTIME_ERROR << "NDPITiffTools: invalid jpeg scale denominator " << scaleDenominator
+            << ". Expected 1, 2, 4 or 8";
+    }
     // code derived from: https://gist.github.com/PhirePhly/3080633
     struct jpeg_decompress_struct cinfo {};
     struct jpeg_error_mgr jerr {};
@@ -1474,8 +1618,9 @@ void NDPITiffTools::jpeglibDecodeTile(const uint8_t* jpg_buffer, size_t jpg_size
     // the cinfo struct output fields, but will indicate if the
     // jpeg is valid.
     auto rc = jpeg_read_header(&cinfo, TRUE);
+    // downscaling by 2, 4 or 8 skips the dropped coefficients in the inverse DCT
     cinfo.scale_num = 1;
-    cinfo.scale_denom = 1;
+    cinfo.scale_denom = static_cast<unsigned int>(scaleDenominator);
     cinfo.image_width = tileSize.width;
     cinfo.image_height = tileSize.height;
     cinfo.out_color_space = JCS_EXT_RGB;
@@ -1501,9 +1646,8 @@ void NDPITiffTools::jpeglibDecodeTile(const uint8_t* jpg_buffer, size_t jpg_size
     output.create(height, width, CV_MAKETYPE(CV_8U, channels));
     cv::Mat mat = output.getMat();
 
-    // The row_stride is the total number of bytes it takes to store an
-    // entire scanline (row). 
-    const unsigned int rowStride = width * channels;
+    // Rows are addressed through the matrix step: the output may be a view
+    // of a larger raster (e.g. a part of the block composed from tiles).
 
     // Now that you have the decompressor entirely configured, it's time
     // to read out all of the scanlines of the jpeg.
@@ -1520,8 +1664,7 @@ void NDPITiffTools::jpeglibDecodeTile(const uint8_t* jpg_buffer, size_t jpg_size
     while (cinfo.output_scanline < cinfo.output_height)
     {
         unsigned char* bufferArray[1];
-        bufferArray[0] = mat.data +
-            (cinfo.output_scanline) * rowStride;
+        bufferArray[0] = mat.ptr(static_cast<int>(cinfo.output_scanline));
 
         jpeg_read_scanlines(&cinfo, bufferArray, 1);
     }
@@ -1550,7 +1693,6 @@ slideio::NDPITIFFKeeper::NDPITIFFKeeper(libtiff::TIFF* hfile) : m_hFile(hfile)
 
 NDPITIFFKeeper::~NDPITIFFKeeper()
 {
-    if (m_hFile)
-        libtiff::TIFFClose(m_hFile);
+    NDPITiffTools::closeTiffFile(m_hFile);
 }
 
@@ -9,7 +9,9 @@
 #include "slideio/core/cvstructs.hpp"
 #include "slideio/base/slideio_enums.hpp"
 #include "slideio/base/base.hpp"
+#include "slideio/imagetools/tiffstring.hpp"
 #include <opencv2/core.hpp>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -27,7 +29,10 @@ namespace libtiff
 namespace slideio
 {
     class NDPIFile;
+    class PositionalFile;
     class CacheManager;
+    class TiffIFDParser;
+    struct TiffIFD;
 
     struct SLIDEIO_NDPI_EXPORTS  NDPITiffDirectory
     {
@@ -51,7 +56,7 @@ namespace slideio
         Compression slideioCompression;
         int dirIndex;
         int64 offset;
-        std::string description;
+        TiffString description;
         std::string userLabel;
         std::string comments;
         std::vector<NDPITiffDirectory> subdirectories;
@@ -64,9 +69,11 @@ namespace slideio
         double magnification;
         uint32_t blankLines;
         std::vector<uint32_t> mcuStarts;
-        uint64_t jpegHeaderOffset;
-        uint64_t jpegSOFMarker;
-        uint32_t jpegHeaderSize;
+        uint64_t jpegHeaderOffset = 0;
+        uint64_t jpegSOFMarker = 0;
+        uint32_t jpegHeaderSize = 0;
+        // jpeg header of the strip (SOI to SOS) with the size limited for the decoder
+        std::vector<uint8_t> jpegHeader;
         uint32_t rawStripSize = 0;
         bool auxImage = false;
 
@@ -95,11 +102,24 @@ namespace slideio
         static void closeTiffFile(libtiff::TIFF* file);
         static cv::Size computeMCUTileSize(FILE* file, const cv::Size& dirSize);
         static std::pair<uint64_t, uint64_t> getJpegHeaderPos(FILE* file);
-        static void readMCUTile(FILE* file, const NDPITiffDirectory& dir, int tile, cv::OutputArray output);
-        static void jpeglibDecodeTile(const uint8_t* jpg_buffer, size_t jpg_size, const cv::Size& tileSize, cv::OutputArray output);
+        // scaleDenominator 2, 4 or 8 decodes the tile reduced by the factor in the inverse DCT
+        static void readMCUTile(const PositionalFile& file, const NDPITiffDirectory& dir, int tile, cv::OutputArray output,
+            int scaleDenominator = 1);
+        // builds a standalone jpeg stream of a tile from the cached strip header and the restart interval of the tile
+        static void readMCUTileData(const PositionalFile& file, const NDPITiffDirectory& dir, int tile,
+            std::vector<uint8_t>& tileData);
+        // reads encoded tile data of a tiled directory without decoding
+        static Compression readRawTile(libtiff::TIFF* hFile, const NDPITiffDirectory& dir, int tile, std::vector<uint8_t>& data);
+        static void jpeglibDecodeTile(const uint8_t* jpg_buffer, size_t jpg_size, const cv::Size& tileSize, cv::OutputArray output,
+            int scaleDenominator = 1);
         static void scanTiffDirTags(libtiff::TIFF* tiff, int dirIndex, int64_t dirOffset, slideio::NDPITiffDirectory& dir);
         static void updateJpegXRCompressedDirectoryMedatata(libtiff::TIFF* tiff, NDPITiffDirectory& dir);
         static void scanTiffDir(libtiff::TIFF* tiff, int dirIndex, int64_t dirOffset, slideio::NDPITiffDirectory& dir);
+        static void scanTiffDirTags(const TiffIFDParser& parser, const TiffIFD& ifd, int dirIndex, int64_t dirOffset,
+            slideio::NDPITiffDirectory& dir);
+        // libtiff handle is used only for directories with metadata outside of the tags (jpegxr)
+        static void scanTiffDir(const TiffIFDParser& parser, libtiff::TIFF* tiff, int dirIndex,
+            slideio::NDPITiffDirectory& dir);
         static void readNotRGBStripedDir(libtiff::TIFF* tiff, const NDPITiffDirectory& dir, cv::_OutputArray output);
         static void readRegularStripedDir(libtiff::TIFF* file, const slideio::NDPITiffDirectory& dir, cv::OutputArray output);
         static void readJpegXRStripedDir(libtiff::TIFF* tiff, const NDPITiffDirectory& dir, cv::_OutputArray output);
@@ -128,10 +148,27 @@ namespace slideio
         static void readJpegDirectoryRegion(libtiff::TIFF* tiff, const std::string& filePath, const cv::Rect& region, const NDPITiffDirectory& dir,
             const std::vector<int>& channelIndices, cv::_OutputArray output);
         static void readDirectoryJpegHeaders(NDPIFile* ndpi, NDPITiffDirectory& dir);
+        // decodes a region of a single strip jpeg directory by its restart intervals in parallel.
+        // Returns false if the strip cannot be split by the intervals.
+        static bool readJpegRestartRegion(const PositionalFile& file, const NDPITiffDirectory& dir, const cv::Rect& region,
+            cv::OutputArray output);
+        static bool readJpegRestartRegion(FILE* file, const NDPITiffDirectory& dir, const cv::Rect& region,
+            cv::OutputArray output);
+        // the same with restart interval offsets found by scanRestartMarkers
+        static bool readJpegRestartRegion(const PositionalFile& file, const NDPITiffDirectory& dir,
+            const std::vector<uint32_t>& mcuStarts, const cv::Rect& region, cv::OutputArray output);
+        // finds restart intervals of a single strip jpeg directory without the restart marker tag
+        // by scanning the entropy coded data of the strip. Returns false if the strip has no markers.
+        static bool scanRestartMarkers(const PositionalFile& file, const NDPITiffDirectory& dir,
+            std::vector<uint32_t>& mcuStarts);
         static void readUncompressedScanlines(libtiff::TIFF* tiff, FILE* file, const NDPITiffDirectory& dir, int firstScanline, int numberScanlines, const std::vector<int>& vector,
                                       cv::_OutputArray tileRaster);
     private:
         static void fixJpegHeader(const NDPITiffDirectory& dir, uint8_t* data);
+        static void readStripJpegHeader(NDPIFile* ndpi, NDPITiffDirectory& dir);
+        static bool readJpegRestartRegion(const std::function<void(uint64_t, size_t, uint8_t*)>& read,
+            const NDPITiffDirectory& dir, const std::vector<uint32_t>& mcuStarts, const cv::Rect& region,
+            cv::OutputArray output);
     };
 
     class  NDPITIFFKeeper
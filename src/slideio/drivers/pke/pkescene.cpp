@@ -13,7 +13,8 @@ PKEScene::PKEScene(const std::string& filePath, const std::string& name):
     m_compression(Compression::Unknown),
     m_resolution(0., 0.),
     m_dataType(slideio::DataType::DT_Unknown),
-    m_magnification(0.)
+    m_magnification(0.),
+    m_handlePool(filePath)
 {
 }
 
@@ -24,6 +25,7 @@ PKEScene::PKEScene(const std::string& filePath, libtiff::TIFF* hFile, const std:
     m_resolution(0., 0.),
     m_dataType(slideio::DataType::DT_Unknown),
     m_magnification(0.),
+    m_handlePool(filePath),
     m_tiffKeeper(hFile)
 {
 }
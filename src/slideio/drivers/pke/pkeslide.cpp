@@ -61,7 +61,7 @@ std::shared_ptr<PKESlide> PKESlide::openFile(const std::string& filePath)
     }
     TIFFKeeper keeper(tiff);
 
-    TiffTools::scanFile(tiff, directories);
+    TiffTools::scanFile(filePath, directories);
 
     std::vector<TiffDirectory> image_dirs;
     std::map<std::string, std::shared_ptr<CVScene>> auxImages;
@@ -5,6 +5,7 @@
 #include "slideio/drivers/pke/pketools.hpp"
 #include "slideio/slideio/slideio.hpp"
 #include "slideio/imagetools/tifftools.hpp"
+#include "slideio/imagetools/cvtools.hpp"
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
@@ -64,37 +65,20 @@ int PKESmallScene::getNumChannels() const
 void PKESmallScene::readResampledBlockChannels(const cv::Rect& blockRect, const cv::Size& blockSize,
     const std::vector<int>& channelIndices, cv::OutputArray output)
 {
-    auto hFile = getFileHandle();
+    auto hFile = m_handlePool.acquire(m_directory);
 
-    if (hFile == nullptr)
-        throw std::runtime_error("PKEDriver: Invalid file header by raster reading operation");
-
-    cv::Mat wholeDirRaster;
+    // strong downscaling keeps every n-th row of the block: strips without the rows are not decoded
+    const int rowStep = std::max(1, blockRect.height / std::max(1, blockSize.height));
+    cv::Mat regionRaster;
+    TiffTools::readStripedDirRegion(hFile->getHandle(), m_directory, blockRect, rowStep, regionRaster);
+    cv::Mat blockRaster;
     if(channelIndices.empty())
     {
-        TiffTools::readStripedDir(hFile, m_directory, wholeDirRaster);
+        blockRaster = regionRaster;
     }
     else
     {
-        cv::Mat dirRaster;
-        TiffTools::readStripedDir(hFile, m_directory, dirRaster);
-        if(channelIndices.size()==1)
-        {
-            cv::extractChannel(dirRaster, wholeDirRaster, channelIndices[0]);
-        }
-        else
-        {
-            std::vector<cv::Mat> channelRasters;
-            channelRasters.reserve(channelIndices.size());
-            for (const auto& channelIndex : channelIndices)
-            {
-                cv::Mat channelRaster;
-                cv::extractChannel(dirRaster, channelRaster, channelIndex);
-                channelRasters.push_back(channelRaster);
-            }
-            cv::merge(channelRasters, wholeDirRaster);
-        }
+        CVTools::extractChannels(regionRaster, channelIndices, blockRaster);
     }
-    cv::Mat blockRaster = wholeDirRaster(blockRect);
     cv::resize(blockRaster, output, blockSize);
 }
@@ -7,6 +7,7 @@
 #include "slideio/drivers/pke/pketools.hpp"
 #include "slideio/drivers/pke/pkescene.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/imagetools/cvtools.hpp"
 #include <tinyxml2.h>
 
@@ -166,9 +167,6 @@ int PKETiledScene::getNumChannels() const {
 
 void PKETiledScene::readResampledBlockChannels(const cv::Rect& blockRect, const cv::Size& blockSize,
                                                const std::vector<int>& channelIndices, cv::OutputArray output) {
-    auto hFile = getFileHandle();
-    if (hFile == nullptr)
-        throw std::runtime_error("PKEDriver: Invalid file header by raster reading operation");
     double zoomX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
     double zoomY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
     double zoom = std::max(zoomX, zoomY);
@@ -231,16 +229,40 @@ bool PKETiledScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userDat
     return true;
 }
 
+void PKETiledScene::getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData) {
+    const int level = *(static_cast<int*>(userData));
+    const int dirIndex = m_zoomDirectoryIndices[level];
+    const TiffDirectory& dir = m_directories[dirIndex];
+    if (dir.tiled) {
+        TileComposer::getGridTilesInRect(rect, {dir.width, dir.height}, {dir.tileWidth, dir.tileHeight}, tileIndices);
+    }
+    else {
+        Tiler::getTilesInRect(rect, tileIndices, userData);
+    }
+}
+
+bool PKETiledScene::supportsConcurrentReads(void* userData) {
+    // every read borrows a handle pinned to its directory from the pool
+    return true;
+}
+
+bool PKETiledScene::getTileCacheKey(void* userData, TileCacheKey& key) {
+    key.filePath = getFilePath();
+    key.level = *(static_cast<int*>(userData));
+    return true;
+}
+
 bool slideio::PKETiledScene::readTiffTile(int tileIndex, const TiffDirectory& dir,
                                           const std::vector<int>& channelIndices, cv::OutputArray tileRaster) {
     bool ret = false;
     try {
+        auto hFile = m_handlePool.acquire(dir);
         if (isBrightField()) {
-            TiffTools::readTile(getFileHandle(), dir, tileIndex, channelIndices, tileRaster);
+            TiffTools::readTile(hFile->getHandle(), dir, tileIndex, channelIndices, tileRaster);
             ret = true;
         }
         else if (channelIndices.size() == 1) {
-            TiffTools::readTile(getFileHandle(), dir, tileIndex, {0}, tileRaster);
+            TiffTools::readTile(hFile->getHandle(), dir, tileIndex, {0}, tileRaster);
             ret = true;
         }
         else {
@@ -248,7 +270,7 @@ bool slideio::PKETiledScene::readTiffTile(int tileIndex, const TiffDirectory& di
             std::vector<int> channels = Tools::completeChannelList(channelIndices, getNumChannels());
             for (const auto& channelIndex : channels) {
                 cv::Mat channelRaster;
-                TiffTools::readTile(getFileHandle(), dir, tileIndex, {0}, channelRaster);
+                TiffTools::readTile(hFile->getHandle(), dir, tileIndex, {0}, channelRaster);
                 channelRasters.push_back(channelRaster);
             }
             cv::merge(channelRasters, tileRaster);
@@ -268,7 +290,8 @@ bool slideio::PKETiledScene::readTiffTile(int tileIndex, const TiffDirectory& di
 bool slideio::PKETiledScene::readTiffDirectory(const TiffDirectory& dir, const std::vector<int>& channelIndices,
                                                cv::OutputArray wholeDirRaster) {
     cv::Mat dirRaster;
-    TiffTools::readStripedDir(getFileHandle(), dir, dirRaster);
+    auto hFile = m_handlePool.acquire(dir);
+    TiffTools::readStripedDir(hFile->getHandle(), dir, dirRaster);
     Tools::extractChannels(dirRaster, channelIndices, wholeDirRaster);
     return true;
 }
@@ -299,8 +322,9 @@ bool PKETiledScene::readTile(int tileIndex, const std::vector<int>& channelIndic
         std::vector<cv::Mat> channelRasters;
         for (const auto& channelIndex : channels) {
             cv::Mat channelRaster;
-            const TiffDirectory newDir = m_directories.at(dir.dirIndex + channels[0]);
-            TiffTools::readRegularStripedDir(getFileHandle(), newDir, channelRaster);
+            const TiffDirectory& newDir = m_directories.at(dir.dirIndex + channelIndex);
+            auto hFile = m_handlePool.acquire(newDir);
+            TiffTools::readRegularStripedDir(hFile->getHandle(), newDir, channelRaster);
             channelRasters.push_back(channelRaster);
         }
         cv::merge(channelRasters, tileRaster);
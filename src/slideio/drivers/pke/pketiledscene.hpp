@@ -32,8 +32,11 @@ namespace slideio
         // Tiler methods
         int getTileCount(void* userData) override;
         bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
+        void getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData) override;
+        bool supportsConcurrentReads(void* userData) override;
         bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
             void* userData) override;
+        bool getTileCacheKey(void* userData, TileCacheKey& key) override;
         void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output) override;
         std::string getChannelName(int channel) const override;
         bool isBrightField() const;
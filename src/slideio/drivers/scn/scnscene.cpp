@@ -6,6 +6,7 @@
 #include "slideio/core/tools/xmltools.hpp"
 #include "slideio/imagetools/imagetools.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/imagetools/libtiff.hpp"
 #include <boost/format.hpp>
 
@@ -13,14 +14,16 @@
 using namespace slideio;
 using namespace tinyxml2;
 
-SCNScene::SCNScene(const std::string& filePath, const tinyxml2::XMLElement* xmlImage):
+SCNScene::SCNScene(const std::string& filePath, const tinyxml2::XMLElement* xmlImage,
+    const std::vector<TiffDirectory>& directories):
     m_filePath(filePath),
     m_compression(Compression::Unknown),
     m_resolution(0., 0.),
     m_magnification(0.),
-    m_interleavedChannels(false)
+    m_interleavedChannels(false),
+    m_handlePool(filePath)
 {
-    init(xmlImage);
+    init(xmlImage, directories);
 }
 
 SCNScene::~SCNScene()
@@ -40,9 +43,6 @@ int SCNScene::getNumChannels() const
 void SCNScene::readResampledBlockChannels(const cv::Rect& blockRect, const cv::Size& blockSize,
                                           const std::vector<int>& channelIndicesIn, cv::OutputArray output)
 {
-    auto hFile = getFileHandle();
-    if (hFile == nullptr)
-        throw std::runtime_error("SCNImageDriver: Invalid file handle by raster reading operation");
     double zoomX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
     double zoomY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
     double zoom = std::max(zoomX, zoomY);
@@ -162,7 +162,7 @@ void SCNScene::defineChannelDataType()
     }
 }
 
-void SCNScene::setupChannels(const XMLElement* xmlImage)
+void SCNScene::setupChannels(const XMLElement* xmlImage, const std::vector<TiffDirectory>& directories)
 {
     const XMLElement* xmlPixels = xmlImage->FirstChildElement("pixels");
     int maxChannelIndex = -1;
@@ -175,9 +175,10 @@ void SCNScene::setupChannels(const XMLElement* xmlImage)
     m_channelDirectories.resize(std::max(1, maxChannelIndex + 1));
     for(auto & dim: dimensions) {
         int channel = dim.c < 0 ? 0 : dim.c;
-        TiffDirectory channelDir;
-        TiffTools::scanTiffDir(m_tiff, dim.ifd, 0, channelDir);
-        m_channelDirectories[channel].push_back(channelDir);
+        if (dim.ifd < 0 || dim.ifd >= static_cast<int>(directories.size())) {
+            RAISE_RUNTIME_ERROR << "SCNImageDriver: invalid directory index " << dim.ifd << " in file " << m_filePath;
+        }
+        m_channelDirectories[channel].push_back(directories[dim.ifd]);
     }
 
     for(auto & dirs:m_channelDirectories) {
@@ -195,7 +196,7 @@ void SCNScene::setupChannels(const XMLElement* xmlImage)
     }
 }
 
-void SCNScene::init(const XMLElement* xmlImage)
+void SCNScene::init(const XMLElement* xmlImage, const std::vector<TiffDirectory>& directories)
 {
     m_tiff = TiffTools::openTiffFile(m_filePath.c_str());
     if (!m_tiff.isValid())
@@ -213,7 +214,7 @@ void SCNScene::init(const XMLElement* xmlImage)
     m_reawMetadata = imageDoc.str();
 
     parseGeometry(xmlImage);
-    setupChannels(xmlImage);
+    setupChannels(xmlImage, directories);
     parseChannelNames(xmlImage);
     parseMagnification(xmlImage);
     parseChannelNames(xmlImage);
@@ -271,6 +272,28 @@ bool SCNScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userData)
     return true;
 }
 
+void SCNScene::getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData)
+{
+    const SCNTilingInfo* info = (const SCNTilingInfo*)userData;
+    const TiffDirectory* dir = info->channel2ifd.begin()->second;
+    TileComposer::getGridTilesInRect(rect, { dir->width, dir->height }, { dir->tileWidth, dir->tileHeight }, tileIndices);
+}
+
+bool SCNScene::supportsConcurrentReads(void* userData)
+{
+    // every tile read borrows handles pinned to the channel directories from the pool
+    return true;
+}
+
+bool SCNScene::getTileCacheKey(void* userData, TileCacheKey& key)
+{
+    const SCNTilingInfo* info = (const SCNTilingInfo*)userData;
+    const TiffDirectory* dir = info->channel2ifd.begin()->second;
+    key.filePath = m_filePath;
+    key.level = dir->dirIndex;
+    return true;
+}
+
 bool SCNScene::readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
     void* userData)
 {
@@ -278,21 +301,24 @@ bool SCNScene::readTile(int tileIndex, const std::vector<int>& channelIndices, c
     if(m_interleavedChannels)
     {
         const TiffDirectory* dir = info->channel2ifd.begin()->second;
-        TiffTools::readTile(getFileHandle(), *dir, tileIndex, channelIndices, tileRaster);
+        auto hFile = m_handlePool.acquire(*dir);
+        TiffTools::readTile(hFile->getHandle(), *dir, tileIndex, channelIndices, tileRaster);
     }
     else if(channelIndices.size()==1)
     {
         const std::vector<int> localChannelIndices = { 0 };
         const TiffDirectory* dir = info->channel2ifd.begin()->second;
-        TiffTools::readTile(getFileHandle(), *dir, tileIndex, localChannelIndices, tileRaster);
+        auto hFile = m_handlePool.acquire(*dir);
+        TiffTools::readTile(hFile->getHandle(), *dir, tileIndex, localChannelIndices, tileRaster);
     }
     else
     {
         const std::vector<int> localChannelIndices = { 0 };
         std::vector<cv::Mat> channelRasters;
         channelRasters.resize(channelIndices.size());
-        for(int channelIndex:channelIndices)
+        for(int index = 0; index < static_cast<int>(channelIndices.size()); ++index)
         {
+            const int channelIndex = channelIndices[index];
             auto it = info->channel2ifd.find(channelIndex);
             if (it == info->channel2ifd.end())
                 throw std::runtime_error(
@@ -300,7 +326,8 @@ bool SCNScene::readTile(int tileIndex, const std::vector<int>& channelIndices, c
                         "SCNImageDriver: invalid channel index (%1%) received during tile reading. File %2%.")
                          % channelIndex % m_filePath).str());
             const TiffDirectory* dir = it->second;
-            TiffTools::readTile(getFileHandle(), *dir, tileIndex, localChannelIndices, channelRasters[channelIndex]);
+            auto hFile = m_handlePool.acquire(*dir);
+            TiffTools::readTile(hFile->getHandle(), *dir, tileIndex, localChannelIndices, channelRasters[index]);
         }
         cv::merge(channelRasters, tileRaster);
     }
@@ -10,6 +10,7 @@
 #include "slideio/core/tools/tilecomposer.hpp"
 #include "slideio/drivers/scn/scnstruct.h"
 #include "slideio/imagetools/tiffkeeper.hpp"
+#include "slideio/imagetools/tiffhandlepool.hpp"
 
 namespace tinyxml2
 {
@@ -30,8 +31,10 @@ namespace slideio
          * \brief Constructor
          * \param filePath: path to the slide file
          * \param xmlImage: xml element corresponded to the scene
+         * \param directories: directories of the file
          */
-        SCNScene(const std::string& filePath, const tinyxml2::XMLElement* xmlImage);
+        SCNScene(const std::string& filePath, const tinyxml2::XMLElement* xmlImage,
+            const std::vector<TiffDirectory>& directories);
 
         virtual ~SCNScene();
 
@@ -64,18 +67,21 @@ namespace slideio
         std::string getChannelName(int channel) const override;
         int getTileCount(void* userData) override;
         bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
+        void getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData) override;
         bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
             void* userData) override;
+        bool supportsConcurrentReads(void* userData) override;
+        bool getTileCacheKey(void* userData, TileCacheKey& key) override;
         void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output) override;
         const TiffDirectory& findZoomDirectory(int channelIndex, double zoom) const;
     protected:
-        void init(const tinyxml2::XMLElement* xmlImage);
+        void init(const tinyxml2::XMLElement* xmlImage, const std::vector<TiffDirectory>& directories);
         static std::vector<SCNDimensionInfo> parseDimensions(const tinyxml2::XMLElement* xmlPixels);
         void parseChannelNames(const tinyxml2::XMLElement* xmlImage);
         void parseGeometry(const tinyxml2::XMLElement* xmlImage);
         void parseMagnification(const tinyxml2::XMLElement* xmlImage);
         void defineChannelDataType();
-        void setupChannels(const tinyxml2::XMLElement* xmlPixels);
+        void setupChannels(const tinyxml2::XMLElement* xmlPixels, const std::vector<TiffDirectory>& directories);
         libtiff::TIFF* getFileHandle() {
             return m_tiff;
         }
@@ -94,6 +100,8 @@ namespace slideio
         std::vector<DataType> m_channelDataType;
         std::vector<std::vector<TiffDirectory>> m_channelDirectories;
         bool m_interleavedChannels;
+        // directory pinned handles for concurrent tile reading
+        TIFFHandlePool m_handlePool;
     };
 }
 
@@ -21,13 +21,15 @@ SCNSlide::SCNSlide(const std::string& filePath) : m_filePath(filePath)
 
 void SCNSlide::init()
 {
-    std::vector<TiffDirectory> directories;
     m_tiff = TiffTools::openTiffFile(m_filePath);
     if (!m_tiff.isValid()) {
         throw std::runtime_error(std::string("SCNImageDriver: Cannot open file:") + m_filePath);
     }
-    TiffTools::scanFile(m_tiff, directories);
-    m_rawMetadata = directories[0].description;
+    TiffTools::scanFile(m_filePath, m_directories);
+    if (m_directories.empty()) {
+        throw std::runtime_error(std::string("SCNImageDriver: No directories found in file:") + m_filePath);
+    }
+    m_rawMetadata = m_directories[0].description;
     constructScenes();
 }
 
@@ -52,7 +54,7 @@ void SCNSlide::constructScenes()
         {
             if (strcmp(tagName, "image") == 0)
             {
-                std::shared_ptr<SCNScene> scene(new SCNScene(m_filePath, xmlImage));
+                std::shared_ptr<SCNScene> scene(new SCNScene(m_filePath, xmlImage, m_directories));
                 double magn = scene->getMagnification();
                 if (magn >= 1.)
                 {
@@ -77,10 +79,9 @@ void SCNSlide::constructScenes()
             {
                 const char *type = xmlImage->Attribute("type");
                 int dir = xmlImage->IntAttribute("ifd", -1);
-                if (type && dir>=0)
+                if (type && dir>=0 && dir<static_cast<int>(m_directories.size()))
                 {
-                    slideio::TiffDirectory directory;
-                    TiffTools::scanTiffDir(m_tiff.getHandle(), dir, 0, directory);
+                    const slideio::TiffDirectory& directory = m_directories[dir];
                     std::shared_ptr<CVScene> scene(new SVSSmallScene(m_filePath, tagName,
                         directory, m_tiff.getHandle()));
                     m_auxImages[type] = scene;
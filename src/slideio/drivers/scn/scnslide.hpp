@@ -35,6 +35,7 @@ namespace slideio
         std::map<std::string, std::shared_ptr<slideio::CVScene>> m_auxImages;
         std::string m_filePath;
         TIFFKeeper m_tiff;
+        std::vector<TiffDirectory> m_directories;
     };
 }
 
@@ -8,6 +8,7 @@
 #include "slideio/core/cvscene.hpp"
 #include "slideio/imagetools/tiffkeeper.hpp"
 #include "slideio/imagetools/tifftools.hpp"
+#include "slideio/imagetools/tiffhandlepool.hpp"
 
 #if defined(_MSC_VER)
 #pragma warning( push )
@@ -58,6 +59,8 @@ namespace slideio
         Resolution m_resolution;
         double m_magnification;
         slideio::DataType m_dataType;
+        // directory pinned handles for concurrent raster reading
+        TIFFHandlePool m_handlePool;
     private:
         TIFFKeeper m_tiffKeeper;
     };
@@ -58,7 +58,7 @@ std::shared_ptr<SVSSlide> SVSSlide::openFile(const std::string& filePath)
     }
     TIFFKeeper keeper(tiff);
 
-    TiffTools::scanFile(tiff, directories);
+    TiffTools::scanFile(filePath, directories);
 
     std::vector<int> image;
     int thumbnail(-1), macro(-1), label(-1);
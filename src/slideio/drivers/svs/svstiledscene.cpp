@@ -7,10 +7,21 @@
 #include "slideio/imagetools/imagetools.hpp"
 #include "slideio/drivers/svs/svsscene.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/imagetools/cvtools.hpp"
+#include "slideio/base/exceptions.hpp"
+#include <map>
 
 using namespace slideio;
 
+namespace
+{
+    bool isJpeg2000(const TiffDirectory& dir)
+    {
+        return dir.compression == 34712 || dir.compression == 33003 || dir.compression == 33005;
+    }
+}
+
 
 SVSTiledScene::SVSTiledScene(const std::string& filePath, const std::string& name, 
     const std::vector<TiffDirectory>& dirs): SVSScene(filePath, name), m_directories(dirs)
@@ -91,9 +102,6 @@ int SVSTiledScene::getNumChannels() const
 void SVSTiledScene::readResampledBlockChannels(const cv::Rect& blockRect, const cv::Size& blockSize,
     const std::vector<int>& channelIndices, cv::OutputArray output)
 {
-    auto hFile = getFileHandle();
-    if (hFile == nullptr)
-        throw std::runtime_error("SVSDriver: Invalid file header by raster reading operation");
     double zoomX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
     double zoomY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
     double zoom = std::max(zoomX, zoomY);
@@ -105,6 +113,44 @@ void SVSTiledScene::readResampledBlockChannels(const cv::Rect& blockRect, const
     TileComposer::composeRect(this, channelIndices, resizedBlock, blockSize, output, (void*)&dir);
 }
 
+void SVSTiledScene::readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect,
+    const std::vector<int>& channelIndices, int, int, cv::OutputArray output)
+{
+    const TiffDirectory& dir = m_directories[zoomLevel];
+    TileComposer::composeRect(this, channelIndices, levelRect, levelRect.size(), output, (void*)&dir);
+}
+
+void SVSTiledScene::readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+    const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters)
+{
+    // blocks are grouped by the pyramid level they are read from
+    std::map<const TiffDirectory*, std::vector<int>> levelBlocks;
+    std::vector<cv::Rect> resizedBlocks(blockRects.size());
+    for (size_t block = 0; block < blockRects.size(); ++block) {
+        const cv::Rect& blockRect = blockRects[block];
+        const double zoomX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
+        const double zoomY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
+        const TiffDirectory& dir = findZoomDirectory(std::max(zoomX, zoomY));
+        const double zoomDirX = static_cast<double>(dir.width) / static_cast<double>(m_directories[0].width);
+        const double zoomDirY = static_cast<double>(dir.height) / static_cast<double>(m_directories[0].height);
+        Tools::scaleRect(blockRect, zoomDirX, zoomDirY, resizedBlocks[block]);
+        levelBlocks[&dir].push_back(static_cast<int>(block));
+    }
+    for (const auto& level : levelBlocks) {
+        const std::vector<int>& blocks = level.second;
+        std::vector<cv::Rect> rects(blocks.size());
+        std::vector<cv::Mat> rasters(blocks.size());
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            rects[index] = resizedBlocks[blocks[index]];
+            rasters[index] = blockRasters[blocks[index]];
+        }
+        TileComposer::composeRects(this, channelIndices, rects, blockSize, rasters, (void*)level.first);
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            blockRasters[blocks[index]] = rasters[index];
+        }
+    }
+}
+
 const TiffDirectory& SVSTiledScene::findZoomDirectory(double zoom) const
 {
     const cv::Rect sceneRect = getRect();
@@ -116,6 +162,39 @@ const TiffDirectory& SVSTiledScene::findZoomDirectory(double zoom) const
     return m_directories[index];
 }
 
+Compression SVSTiledScene::readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data)
+{
+    if (zoomLevel < 0 || zoomLevel >= static_cast<int>(m_directories.size())) {
+        RAISE_RUNTIME_ERROR << "SVSDriver: Invalid zoom level: " << zoomLevel
+            << ". Expected range: [0," << m_directories.size() << ")";
+    }
+    const TiffDirectory& dir = m_directories[zoomLevel];
+    auto hFile = m_handlePool.acquire(dir);
+    return TiffTools::readRawTile(hFile->getHandle(), dir, tileIndex, data);
+}
+
+bool SVSTiledScene::getBlockDataRanges(const BlockRequest& block, std::vector<FileRange>& ranges)
+{
+    if (block.zoomLevel >= static_cast<int>(m_directories.size())) {
+        return false;
+    }
+    if (block.zoomLevel >= 0) {
+        const TiffDirectory& dir = m_directories[block.zoomLevel];
+        return TileComposer::getDataRanges(this, block.rect, ranges, (void*)&dir);
+    }
+    if (block.rect.width <= 0 || block.rect.height <= 0) {
+        return false;
+    }
+    const double zoomX = static_cast<double>(block.size.width) / static_cast<double>(block.rect.width);
+    const double zoomY = static_cast<double>(block.size.height) / static_cast<double>(block.rect.height);
+    const TiffDirectory& dir = findZoomDirectory(std::max(zoomX, zoomY));
+    const double zoomDirX = static_cast<double>(dir.width) / static_cast<double>(m_directories[0].width);
+    const double zoomDirY = static_cast<double>(dir.height) / static_cast<double>(m_directories[0].height);
+    cv::Rect resizedBlock;
+    Tools::scaleRect(block.rect, zoomDirX, zoomDirY, resizedBlock);
+    return TileComposer::getDataRanges(this, resizedBlock, ranges, (void*)&dir);
+}
+
 int SVSTiledScene::getTileCount(void* userData)
 {
     const TiffDirectory* dir = (const TiffDirectory*)userData;
@@ -138,6 +217,39 @@ bool SVSTiledScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userDat
     return true;
 }
 
+void SVSTiledScene::getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData)
+{
+    const TiffDirectory* dir = (const TiffDirectory*)userData;
+    TileComposer::getGridTilesInRect(rect, { dir->width, dir->height }, { dir->tileWidth, dir->tileHeight }, tileIndices);
+}
+
+bool SVSTiledScene::supportsConcurrentReads(void* userData)
+{
+    // every tile read borrows its own handle from the pool
+    return true;
+}
+
+bool SVSTiledScene::getTileCacheKey(void* userData, TileCacheKey& key)
+{
+    const TiffDirectory* dir = static_cast<const TiffDirectory*>(userData);
+    key.filePath = getFilePath();
+    key.level = dir->dirIndex;
+    return true;
+}
+
+bool SVSTiledScene::getTileDataRange(int tileIndex, FileRange& range, void* userData)
+{
+    const TiffDirectory* dir = static_cast<const TiffDirectory*>(userData);
+    auto hFile = m_handlePool.acquire(*dir);
+    return TiffTools::getTileDataRange(hFile->getHandle(), *dir, tileIndex, range.offset, range.size);
+}
+
+bool SVSTiledScene::supportsStridedOutput(void* userData)
+{
+    // TiffTools tile readers decode into the output or copy to it with OpenCV functions
+    return true;
+}
+
 bool SVSTiledScene::readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
     void* userData)
 {
@@ -145,7 +257,8 @@ bool SVSTiledScene::readTile(int tileIndex, const std::vector<int>& channelIndic
     bool ret = false;
     try
     {
-        TiffTools::readTile(getFileHandle(), *dir, tileIndex, channelIndices, tileRaster);
+        auto hFile = m_handlePool.acquire(*dir);
+        TiffTools::readTile(hFile->getHandle(), *dir, tileIndex, channelIndices, tileRaster);
         ret = true;
     }
     catch(std::runtime_error&){
@@ -158,6 +271,45 @@ bool SVSTiledScene::readTile(int tileIndex, const std::vector<int>& channelIndic
     return ret;
 }
 
+bool SVSTiledScene::supportsReducedReads(void* userData)
+{
+    const TiffDirectory* dir = static_cast<const TiffDirectory*>(userData);
+    return (dir->compression == 7 && dir->dataType == DataType::DT_Byte) || isJpeg2000(*dir);
+}
+
+bool SVSTiledScene::readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+    cv::OutputArray tileRaster, void* userData)
+{
+    const TiffDirectory* dir = static_cast<const TiffDirectory*>(userData);
+    const cv::Rect tileRect(0, 0, dir->tileWidth, dir->tileHeight);
+    return readTileRegion(tileIndex, channelIndices, tileRect, reduction, tileRaster, userData);
+}
+
+bool SVSTiledScene::supportsRegionReads(void* userData)
+{
+    // jpeg 2000 decodes only the code blocks of the region
+    const TiffDirectory* dir = static_cast<const TiffDirectory*>(userData);
+    return isJpeg2000(*dir);
+}
+
+bool SVSTiledScene::readTileRegion(int tileIndex, const std::vector<int>& channelIndices, const cv::Rect& region,
+    int reduction, cv::OutputArray tileRaster, void* userData)
+{
+    const TiffDirectory* dir = static_cast<const TiffDirectory*>(userData);
+    try
+    {
+        auto hFile = m_handlePool.acquire(*dir);
+        if (TiffTools::readTileRegion(hFile->getHandle(), *dir, tileIndex, channelIndices, region, reduction,
+            tileRaster)) {
+            return true;
+        }
+    }
+    catch(std::exception&) {
+        // the regular reader reports the tile as missing
+    }
+    return Tiler::readTileRegion(tileIndex, channelIndices, region, 1, tileRaster, userData);
+}
+
 void SVSTiledScene::initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output)
 {
     initializeSceneBlock(blockSize, channelIndices, output);
@@ -31,12 +31,30 @@ namespace slideio
         void readResampledBlockChannels(const cv::Rect& blockRect, const cv::Size& blockSize, const std::vector<int>& channelIndices,
             cv::OutputArray output) override;
         const slideio::TiffDirectory& findZoomDirectory(double zoom) const;
+        Compression readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data) override;
+        bool getBlockDataRanges(const BlockRequest& block, std::vector<FileRange>& ranges) override;
         // Tiler methods
         int getTileCount(void* userData) override;
         bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
+        void getTilesInRect(const cv::Rect& rect, std::vector<int>& tileIndices, void* userData) override;
+        bool supportsConcurrentReads(void* userData) override;
+        bool supportsStridedOutput(void* userData) override;
         bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
             void* userData) override;
+        bool supportsReducedReads(void* userData) override;
+        bool readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+            cv::OutputArray tileRaster, void* userData) override;
+        bool supportsRegionReads(void* userData) override;
+        bool readTileRegion(int tileIndex, const std::vector<int>& channelIndices, const cv::Rect& region,
+            int reduction, cv::OutputArray tileRaster, void* userData) override;
+        bool getTileCacheKey(void* userData, TileCacheKey& key) override;
+        bool getTileDataRange(int tileIndex, FileRange& range, void* userData) override;
         void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output) override;
+    protected:
+        void readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, cv::OutputArray output) override;
+        void readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+            const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters) override;
     private:
         std::vector<slideio::TiffDirectory> m_directories;
     };
@@ -117,22 +117,33 @@ void slideio::vsi::EtsFile::read(std::list<std::shared_ptr<Volume>>& volumes) {
     }
 }
 
-void vsi::EtsFile::readTilePart(const vsi::TileInfo& tileInfo, cv::OutputArray tileRaster) {
+void vsi::EtsFile::readTilePart(const vsi::TileInfo& tileInfo, cv::OutputArray tileRaster,
+                                const slideio::ReadCoalescer* reads, int reduction) {
     const int64_t offset = tileInfo.offset;
     const uint32_t tileCompressedSize = tileInfo.size;
-    m_etsStream->setPos(offset);
-    m_buffer.resize(tileCompressedSize);
-    m_etsStream->readBytes(m_buffer.data(), static_cast<int>(m_buffer.size()));
-    tileRaster.create(m_tileSize, CV_MAKETYPE(CVTools::cvTypeFromDataType(m_dataType), m_numChannels));
-    if (m_compression == slideio::Compression::Uncompressed) {
-        const int tileSize = m_tileSize.width * m_tileSize.height * m_numChannels;
-        std::memcpy(tileRaster.getMat().data, m_buffer.data(), tileSize);
+    const uint8_t* data = reads ? reads->find(offset, tileCompressedSize) : nullptr;
+    if (data == nullptr) {
+        m_etsStream->setPos(offset);
+        m_buffer.resize(tileCompressedSize);
+        m_etsStream->readBytes(m_buffer.data(), static_cast<int>(m_buffer.size()));
+        data = m_buffer.data();
+    }
+    // decoders allocate the raster of the reduced size
+    if (m_compression == slideio::Compression::Jpeg) {
+        ImageTools::decodeJpegStream(data, tileCompressedSize, tileRaster, reduction);
     }
-    else if (m_compression == slideio::Compression::Jpeg) {
-        ImageTools::decodeJpegStream(m_buffer.data(), m_buffer.size(), tileRaster);
+    else if (m_compression == slideio::Compression::Uncompressed) {
+        tileRaster.create(m_tileSize, CV_MAKETYPE(CVTools::cvTypeFromDataType(m_dataType), m_numChannels));
+        const int tileSize = m_tileSize.width * m_tileSize.height * m_numChannels;
+        std::memcpy(tileRaster.getMat().data, data, tileSize);
     }
     else if (m_compression == slideio::Compression::Jpeg2000) {
-        ImageTools::decodeJp2KStream(m_buffer.data(), m_buffer.size(), tileRaster);
+        // reduction by 2^levels skips the highest wavelet levels
+        int levels = 0;
+        while ((2 << levels) <= reduction) {
+            ++levels;
+        }
+        ImageTools::decodeJp2KStream(data, tileCompressedSize, tileRaster, {}, false, levels);
     }
     else {
         RAISE_RUNTIME_ERROR << "VSIImageDriver: readTile: Compression " << static_cast<int>(m_compression)
@@ -140,12 +151,42 @@ void vsi::EtsFile::readTilePart(const vsi::TileInfo& tileInfo, cv::OutputArray t
     }
 }
 
+slideio::Compression vsi::EtsFile::readRawTile(int levelIndex, int tileIndex, std::vector<uint8_t>& data) {
+    if (levelIndex < 0 || levelIndex >= m_pyramid.getNumLevels()) {
+        RAISE_RUNTIME_ERROR << "VSIImageDriver: readRawTile: Pyramid level "
+            << levelIndex << " is out of range (0 - " << m_pyramid.getNumLevels() << " )";
+    }
+    if (m_pyramid.getNumChannelIndices() > 1) {
+        RAISE_RUNTIME_ERROR << "VSIImageDriver: readRawTile: raw tiles are not supported for images "
+            "with separately stored channels. File: " << m_filePath;
+    }
+    const PyramidLevel& pyramidLevel = m_pyramid.getLevel(levelIndex);
+    const cv::Size levelSize = pyramidLevel.getSize();
+    const int tilesX = (levelSize.width - 1) / m_tileSize.width + 1;
+    const int tilesY = (levelSize.height - 1) / m_tileSize.height + 1;
+    if (tileIndex < 0 || tileIndex >= tilesX * tilesY) {
+        RAISE_RUNTIME_ERROR << "VSIImageDriver: readRawTile: Tile index "
+            << tileIndex << " is out of range (0 - " << tilesX * tilesY << " )";
+    }
+    data.clear();
+    const int levelTileIndex = pyramidLevel.findTile(tileIndex % tilesX, tileIndex / tilesX);
+    if (levelTileIndex >= 0) {
+        const TileInfo& tileInfo = pyramidLevel.getTile(levelTileIndex, 0, 0, 0);
+        data.resize(tileInfo.size);
+        m_etsStream->setPos(tileInfo.offset);
+        m_etsStream->readBytes(data.data(), static_cast<int>(data.size()));
+    }
+    return m_compression;
+}
+
 void vsi::EtsFile::readTile(int levelIndex,
                             int tileIndex,
                             const std::vector<int>& channelIndices,
                             int zSlice,
                             int tFrame,
-                            cv::OutputArray output) {
+                            cv::OutputArray output,
+                            const slideio::ReadCoalescer* reads,
+                            int reduction) {
     if (levelIndex < 0 || levelIndex >= m_pyramid.getNumLevels()) {
         RAISE_RUNTIME_ERROR << "VSIImageDriver: readTile: Pyramid level "
             << levelIndex << " is out of range (0 - " << m_pyramid.getNumLevels() << " )";
@@ -173,7 +214,7 @@ void vsi::EtsFile::readTile(int levelIndex,
                     << channelIndex << " is out of range (0 - " << numChannelIndices << " )";
             }
             const TileInfo& tileInfo = pyramidLevel.getTile(tileIndex, channelIndex, zSlice, tFrame);
-            readTilePart(tileInfo, channelRasters[rasterIndex++]);
+            readTilePart(tileInfo, channelRasters[rasterIndex++], reads, reduction);
         }
         if (channelRasters.size() == 1) {
             channelRasters[0].copyTo(output);
@@ -185,7 +226,47 @@ void vsi::EtsFile::readTile(int levelIndex,
     else {
         cv::Mat tileRaster;
         const TileInfo& tileInfo = pyramidLevel.getTile(tileIndex, 0, zSlice, tFrame);
-        readTilePart(tileInfo, tileRaster);
+        readTilePart(tileInfo, tileRaster, reads, reduction);
         Tools::extractChannels(tileRaster, channelIndices, output);
     }
 }
+
+void vsi::EtsFile::getTileRanges(int levelIndex, int tileIndex, const std::vector<int>& channelIndices, int zSlice,
+                                 int tFrame, std::vector<slideio::FileRange>& ranges) const {
+    if (levelIndex < 0 || levelIndex >= m_pyramid.getNumLevels()) {
+        return;
+    }
+    const PyramidLevel& pyramidLevel = m_pyramid.getLevel(levelIndex);
+    if (tileIndex < 0 || tileIndex >= pyramidLevel.getNumTiles()) {
+        return;
+    }
+    auto addRange = [&ranges](const TileInfo& tileInfo) {
+        slideio::FileRange range;
+        range.offset = tileInfo.offset;
+        range.size = tileInfo.size;
+        ranges.push_back(range);
+    };
+    if (m_pyramid.getNumChannelIndices() > 1) {
+        std::vector<int> channels(channelIndices);
+        if (channels.empty()) {
+            for (int channelIndex = 0; channelIndex < getNumChannels(); ++channelIndex) {
+                channels.push_back(channelIndex);
+            }
+        }
+        for (const int channelIndex : channels) {
+            if (channelIndex >= 0 && channelIndex < getNumChannels()) {
+                addRange(pyramidLevel.getTile(tileIndex, channelIndex, zSlice, tFrame));
+            }
+        }
+    }
+    else {
+        addRange(pyramidLevel.getTile(tileIndex, 0, zSlice, tFrame));
+    }
+}
+
+void vsi::EtsFile::loadRanges(const std::vector<slideio::FileRange>& ranges, slideio::ReadCoalescer& reads) {
+    reads.load(ranges, [this](int64_t offset, int64_t size, uint8_t* data) {
+        m_etsStream->setPos(offset);
+        m_etsStream->readBytes(data, static_cast<uint32_t>(size));
+    });
+}
@@ -13,6 +13,7 @@
 #include "slideio/base/slideio_enums.hpp"
 #include "slideio/drivers/vsi/vsistream.hpp"
 #include "slideio/drivers/vsi/pyramid.hpp"
+#include "slideio/core/tools/readcoalescer.hpp"
 
 #if defined(_MSC_VER)
 #pragma warning(push)
@@ -45,7 +46,10 @@ namespace slideio
             }
 
             void read(std::list<std::shared_ptr<Volume>>& volumes);
-            void readTilePart(const vsi::TileInfo& tileInfo, cv::OutputArray tileRaster);
+            // data of the tile is taken from "reads" if it was loaded there.
+            // Jpeg and jpeg 2000 tiles are decoded reduced by the factor "reduction" (1, 2, 4 or 8).
+            void readTilePart(const vsi::TileInfo& tileInfo, cv::OutputArray tileRaster,
+                const slideio::ReadCoalescer* reads = nullptr, int reduction = 1);
 
             void assignVolume(const std::shared_ptr<Volume>& volume) {
                 m_volume = volume;
@@ -82,7 +86,15 @@ namespace slideio
             const PyramidLevel& getPyramidLevel(int index) const {
                 return m_pyramid.getLevel(index);
             }
-            void readTile(int levelIndex, int tileIndex, const std::vector<int>& channelIndices, int zSlice, int tFrame, cv::OutputArray output);
+            void readTile(int levelIndex, int tileIndex, const std::vector<int>& channelIndices, int zSlice, int tFrame, cv::OutputArray output,
+                const slideio::ReadCoalescer* reads = nullptr, int reduction = 1);
+            // collects file ranges of the parts of a tile read by readTile
+            void getTileRanges(int levelIndex, int tileIndex, const std::vector<int>& channelIndices, int zSlice, int tFrame,
+                std::vector<slideio::FileRange>& ranges) const;
+            // loads file ranges of tiles with a few large reads
+            void loadRanges(const std::vector<slideio::FileRange>& ranges, slideio::ReadCoalescer& reads);
+            // reads encoded data of a tile in the level grid. The data is empty if the tile is not stored.
+            slideio::Compression readRawTile(int levelIndex, int tileIndex, std::vector<uint8_t>& data);
         private:
             std::string m_filePath;
             DataType m_dataType = DataType::DT_Unknown;
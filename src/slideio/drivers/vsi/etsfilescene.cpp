@@ -6,6 +6,7 @@
 
 #include "slideio/base/exceptions.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/drivers/vsi/etsfile.hpp"
 #include "slideio/drivers/vsi/vsifile.hpp"
 
@@ -17,6 +18,8 @@ struct TileComposerUserData
     int levelIndex = -1;
     int zSlice = 0;
     int tFrame = 0;
+    // tiles of the block being composed loaded by prefetchTiles
+    std::shared_ptr<ReadCoalescer> reads;
 };
 
 EtsFileScene::EtsFileScene(const std::string& filePath,
@@ -64,16 +67,62 @@ bool EtsFileScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userData
     return true;
 }
 
+bool EtsFileScene::getTileCacheKey(void* userData, TileCacheKey& key) {
+    const TileComposerUserData* tileComposerUserData = static_cast<TileComposerUserData*>(userData);
+    const std::shared_ptr<EtsFile> etsFile = getEtsFile();
+    if (!etsFile) {
+        return false;
+    }
+    key.filePath = etsFile->getFilePath();
+    key.level = tileComposerUserData->levelIndex;
+    key.zSlice = tileComposerUserData->zSlice;
+    key.tFrame = tileComposerUserData->tFrame;
+    return true;
+}
+
 bool EtsFileScene::readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
                             void* userData) {
     const TileComposerUserData* tileComposerUserData = static_cast<TileComposerUserData*>(userData);
     const int levelIndex = tileComposerUserData->levelIndex;
     const std::shared_ptr<EtsFile> etsFile = getEtsFile();
     etsFile->readTile(levelIndex, tileIndex, channelIndices, tileComposerUserData->zSlice, tileComposerUserData->tFrame,
-                      tileRaster);
+                      tileRaster, tileComposerUserData->reads.get());
     return true;
 }
 
+bool EtsFileScene::supportsReducedReads(void* userData) {
+    const std::shared_ptr<EtsFile> etsFile = getEtsFile();
+    return etsFile && (etsFile->getCompression() == Compression::Jpeg
+        || etsFile->getCompression() == Compression::Jpeg2000);
+}
+
+bool EtsFileScene::readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+                                   cv::OutputArray tileRaster, void* userData) {
+    const TileComposerUserData* tileComposerUserData = static_cast<TileComposerUserData*>(userData);
+    const std::shared_ptr<EtsFile> etsFile = getEtsFile();
+    etsFile->readTile(tileComposerUserData->levelIndex, tileIndex, channelIndices, tileComposerUserData->zSlice,
+                      tileComposerUserData->tFrame, tileRaster, tileComposerUserData->reads.get(), reduction);
+    return true;
+}
+
+void EtsFileScene::prefetchTiles(const std::vector<int>& tileIndices, const std::vector<int>& channelIndices,
+                                 void* userData) {
+    TileComposerUserData* tileComposerUserData = static_cast<TileComposerUserData*>(userData);
+    const std::shared_ptr<EtsFile> etsFile = getEtsFile();
+    if (!etsFile) {
+        return;
+    }
+    std::vector<FileRange> ranges;
+    for (const int tileIndex : tileIndices) {
+        etsFile->getTileRanges(tileComposerUserData->levelIndex, tileIndex, channelIndices,
+                               tileComposerUserData->zSlice, tileComposerUserData->tFrame, ranges);
+    }
+    // tiles of a level are stored one after another: neighbours are read at once
+    std::shared_ptr<ReadCoalescer> reads = std::make_shared<ReadCoalescer>();
+    etsFile->loadRanges(ranges, *reads);
+    tileComposerUserData->reads = reads;
+}
+
 void EtsFileScene::addAuxImage(const std::string& name, std::shared_ptr<CVScene> scene) {
     m_auxScenes[name] = scene;
     m_auxNames.push_back(name);
@@ -146,6 +195,7 @@ std::string EtsFileScene::getChannelName(int channel) const {
 void EtsFileScene::readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv::Size& blockSize,
                                                 const std::vector<int>& channelIndices, int zSliceIndex,
                                                 int tFrameIndex, cv::OutputArray output) {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
     const auto etsFile = getEtsFile();
     if (!etsFile) {
         RAISE_RUNTIME_ERROR << "VSIImageDriver: ETS file is not initialized";
@@ -174,6 +224,70 @@ void EtsFileScene::readResampledBlockChannelsEx(const cv::Rect& blockRect, const
     TileComposer::composeRect(this, channelIndices, resizedBlock, blockSize, output, (void*)&userData);
 }
 
+void EtsFileScene::readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect,
+                                            const std::vector<int>& channelIndices, int zSliceIndex,
+                                            int tFrameIndex, cv::OutputArray output) {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
+    TileComposerUserData userData;
+    userData.levelIndex = zoomLevel;
+    userData.zSlice = zSliceIndex;
+    userData.tFrame = tFrameIndex;
+    TileComposer::composeRect(this, channelIndices, levelRect, levelRect.size(), output, (void*)&userData);
+}
+
+void EtsFileScene::readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+                                               const std::vector<int>& channelIndices,
+                                               std::vector<cv::Mat>& blockRasters) {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
+    const auto etsFile = getEtsFile();
+    if (!etsFile) {
+        RAISE_RUNTIME_ERROR << "VSIImageDriver: ETS file is not initialized";
+    }
+    if (!etsFile->getVolume()) {
+        RAISE_RUNTIME_ERROR << "VSIImageDriver: ETS file does not contain volume";
+    }
+    // blocks are grouped by the pyramid level they are read from
+    std::map<int, std::vector<int>> levelBlocks;
+    std::vector<cv::Rect> resizedBlocks(blockRects.size());
+    for (size_t block = 0; block < blockRects.size(); ++block) {
+        const cv::Rect& blockRect = blockRects[block];
+        const double zoomX = static_cast<double>(blockSize.width) / static_cast<double>(blockRect.width);
+        const double zoomY = static_cast<double>(blockSize.height) / static_cast<double>(blockRect.height);
+        const int levelIndex = findZoomLevelIndex(std::max(zoomX, zoomY));
+        if (levelIndex < 0 || levelIndex >= etsFile->getNumPyramidLevels()) {
+            RAISE_RUNTIME_ERROR << "VSIImageDriver: Unexpected zoom level index: "
+                << levelIndex << " Expected: " << "0 - " << etsFile->getNumPyramidLevels();
+        }
+        const double levelZoom = 1. / etsFile->getPyramidLevel(levelIndex).getScaleLevel();
+        Tools::scaleRect(blockRect, levelZoom, levelZoom, resizedBlocks[block]);
+        levelBlocks[levelIndex].push_back(static_cast<int>(block));
+    }
+    for (const auto& level : levelBlocks) {
+        TileComposerUserData userData;
+        userData.levelIndex = level.first;
+        const std::vector<int>& blocks = level.second;
+        std::vector<cv::Rect> rects(blocks.size());
+        std::vector<cv::Mat> rasters(blocks.size());
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            rects[index] = resizedBlocks[blocks[index]];
+            rasters[index] = blockRasters[blocks[index]];
+        }
+        TileComposer::composeRects(this, channelIndices, rects, blockSize, rasters, (void*)&userData);
+        for (size_t index = 0; index < blocks.size(); ++index) {
+            blockRasters[blocks[index]] = rasters[index];
+        }
+    }
+}
+
+Compression EtsFileScene::readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data) {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
+    const auto etsFile = getEtsFile();
+    if (!etsFile) {
+        RAISE_RUNTIME_ERROR << "VSIImageDriver: ETS file is not initialized";
+    }
+    return etsFile->readRawTile(zoomLevel, tileIndex, data);
+}
+
 void EtsFileScene::init() {
     if (!m_vsiFile) {
         RAISE_RUNTIME_ERROR << "VSIImageDriver: VSI file is not initialized";
@@ -27,6 +27,12 @@ namespace slideio
             bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
             bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
                           void* userData) override;
+            bool supportsReducedReads(void* userData) override;
+            bool readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+                                 cv::OutputArray tileRaster, void* userData) override;
+            bool getTileCacheKey(void* userData, TileCacheKey& key) override;
+            void prefetchTiles(const std::vector<int>& tileIndices, const std::vector<int>& channelIndices,
+                               void* userData) override;
             void addAuxImage(const std::string& name, std::shared_ptr<CVScene> scene);
             std::shared_ptr<CVScene> getAuxImage(const std::string& imageName) const override;
             int getNumZSlices() const override;
@@ -42,7 +48,12 @@ namespace slideio
             void readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv::Size& blockSize,
                 const std::vector<int>& componentIndices, int zSliceIndex, int tFrameIndex,
                 cv::OutputArray output) override;
+            Compression readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data) override;
         protected:
+            void readLevelBlockChannelsEx(int zoomLevel, const cv::Rect& levelRect, const std::vector<int>& channelIndices,
+                int zSliceIndex, int tFrameIndex, cv::OutputArray output) override;
+            void readResampledBlocksChannels(const std::vector<cv::Rect>& blockRects, const cv::Size& blockSize,
+                const std::vector<int>& channelIndices, std::vector<cv::Mat>& blockRasters) override;
             void init();
             std::shared_ptr<EtsFile> getEtsFile() const;
             int findZoomLevelIndex(double zoom) const;
@@ -5,6 +5,7 @@
 
 #include "slideio/base/exceptions.hpp"
 #include "slideio/drivers/vsi/dimensions.hpp"
+#include <algorithm>
 
 using namespace slideio;
 using namespace slideio::vsi;
@@ -36,6 +37,23 @@ const TileInfo& PyramidLevel::getTile(int tileIndex, int channelIndex, int zInde
         << " channel: " << channelIndex << " z: " << zIndex << " t: " << tIndex;
 }
 
+int PyramidLevel::findTile(int tileX, int tileY) const {
+    // tiles are sorted by row and column
+    const auto it = std::lower_bound(m_tileIndices.begin(), m_tileIndices.end(), std::make_pair(tileY, tileX),
+        [this](int tileStart, const std::pair<int, int>& position) {
+            const auto& coordinates = m_tiles[tileStart].coordinates;
+            return std::make_pair(coordinates[1], coordinates[0]) < position;
+        });
+    if (it == m_tileIndices.end()) {
+        return -1;
+    }
+    const auto& coordinates = m_tiles[*it].coordinates;
+    if (coordinates[0] != tileX || coordinates[1] != tileY) {
+        return -1;
+    }
+    return static_cast<int>(it - m_tileIndices.begin());
+}
+
 void Pyramid::init(std::vector<TileInfo>& tiles, const cv::Size& imageSize, const cv::Size& tileSize,
                    const IDimensionOrder* dimOrder) {
     if (tiles.empty()) {
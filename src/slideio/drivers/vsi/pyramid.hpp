@@ -33,6 +33,8 @@ namespace slideio
             cv::Size getSize() const { return m_size; }
             int getNumTiles() const { return static_cast<int>(m_tileIndices.size()); }
             const TileInfo& getTile(int tileIndex, int channelIndex, int zIndex, int tIndex) const;
+            // returns index of the tile at the grid position or -1 if the tile is not stored
+            int findTile(int tileX, int tileY) const;
         private:
             int m_scaleLevel = 1;
             cv::Size m_size;
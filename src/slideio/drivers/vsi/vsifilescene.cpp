@@ -20,6 +20,7 @@ VsiFileScene::VsiFileScene(const std::string& filePath, std::shared_ptr<vsi::VSI
 void VsiFileScene::readResampledBlockChannels(const cv::Rect& blockRect, const cv::Size& blockSize,
                                               const std::vector<int>& channelIndices, cv::OutputArray output)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
     const TiffDirectory& directory = m_vsiFile->getTiffDirectory(m_directoryIndex);
     if(!directory.tiled) {
         cv::Mat directoryRaster;
@@ -9,6 +9,7 @@
 #include "slideio/drivers/zvi/zviutils.hpp"
 #include "slideio/drivers/zvi/zviimageitem.hpp"
 #include "slideio/imagetools/imagetools.hpp"
+#include "slideio/base/scratchbuffer.hpp"
 
 using namespace slideio;
 
@@ -148,7 +149,7 @@ void ZVIImageItem::readRaster(ole::compound_document& doc, cv::OutputArray raste
         std::streampos endPos = stream->pos();
         std::streamsize bytesToRead = endPos - getDataOffset();
         stream->seek(getDataOffset(), std::ios::beg);
-        std::vector<uint8_t> buff(bytesToRead);
+        ScratchBuffer buff(static_cast<size_t>(bytesToRead));
         stream->read(reinterpret_cast<char*>(buff.data()), bytesToRead);
         ImageTools::decodeJpegStream(buff.data(), buff.size(), raster);
     }
@@ -10,6 +10,7 @@
 
 #include "zviutils.hpp"
 #include "slideio/core/tools/tools.hpp"
+#include "slideio/core/tools/tilecache.hpp"
 #include "slideio/imagetools/cvtools.hpp"
 #include "slideio/imagetools/imagetools.hpp"
 
@@ -106,6 +107,7 @@ void ZVIScene::readResampledBlockChannelsEx(const cv::Rect& blockRect, const cv:
                                             const std::vector<int>& componentIndices, int zSliceIndex, int tFrameIndex,
                                             cv::OutputArray output)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_readMutex);
     TilerData userData;
     userData.zSliceIndex = zSliceIndex;
     TileComposer::composeRect(this, componentIndices, blockRect, blockSize, output, &userData);
@@ -133,6 +135,14 @@ bool ZVIScene::getTileRect(int tileIndex, cv::Rect& tileRect, void* userData)
     return true;
 }
 
+bool ZVIScene::getTileCacheKey(void* userData, TileCacheKey& key)
+{
+    const TilerData* data = static_cast<const TilerData*>(userData);
+    key.filePath = m_filePath;
+    key.zSlice = data->zSliceIndex;
+    return true;
+}
+
 bool ZVIScene::readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
                         void* userData)
 {
@@ -54,6 +54,7 @@ namespace slideio
         bool getTileRect(int tileIndex, cv::Rect& tileRect, void* userData) override;
         bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
                       void* userData) override;
+        bool getTileCacheKey(void* userData, TileCacheKey& key) override;
         void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices, cv::OutputArray output) override;
     private:
         ZVIPixelFormat getPixelFormat() const;
@@ -0,0 +1,92 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/imagetools/imagetools.hpp"
+#include "slideio/base/exceptions.hpp"
+#include <algorithm>
+
+using namespace slideio;
+
+namespace
+{
+    // JFIF (ITU-R BT.601 full range) coefficients in 16 bit fixed point as libjpeg uses them
+    const int SCALE_BITS = 16;
+    const int ONE_HALF = 1 << (SCALE_BITS - 1);
+    const int CR_R = 91881;     // 1.402
+    const int CB_G = -22554;    // -0.344136
+    const int CR_G = -46802;    // -0.714136
+    const int CB_B = 116130;    // 1.772
+
+    struct ChromaTerms
+    {
+        int red;
+        int green;
+        int blue;
+    };
+
+    inline ChromaTerms chromaTerms(int cb, int cr)
+    {
+        cb -= 128;
+        cr -= 128;
+        return { CR_R * cr + ONE_HALF, CB_G * cb + CR_G * cr + ONE_HALF, CB_B * cb + ONE_HALF };
+    }
+
+    inline uint8_t clampByte(int value)
+    {
+        return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+    }
+
+    inline void lumaToRGB(int luma, const ChromaTerms& chroma, uint8_t* pixel)
+    {
+        const int scaledLuma = luma << SCALE_BITS;
+        pixel[0] = clampByte((scaledLuma + chroma.red) >> SCALE_BITS);
+        pixel[1] = clampByte((scaledLuma + chroma.green) >> SCALE_BITS);
+        pixel[2] = clampByte((scaledLuma + chroma.blue) >> SCALE_BITS);
+    }
+}
+
+void ImageTools::convertYCbCrToRGB(const uint8_t* data, int width, int height,
+    int subsamplingX, int subsamplingY, cv::OutputArray output)
+{
+    auto validSubsampling = [](int value) {
+        return value == 1 || value == 2 || value == 4;
+    };
+    if (!validSubsampling(subsamplingX) || !validSubsampling(subsamplingY) || subsamplingY > subsamplingX) {
+        RAISE_RUNTIME_ERROR << "ImageTools: unsupported YCbCr subsampling " << subsamplingX << "x" << subsamplingY;
+    }
+    output.create(height, width, CV_8UC3);
+    cv::Mat raster = output.getMat();
+    if (subsamplingX == 1 && subsamplingY == 1) {
+        // plain Y,Cb,Cr pixels: a flat loop the compiler vectorizes
+        const uint8_t* pixel = data;
+        for (int row = 0; row < height; ++row) {
+            uint8_t* rgb = raster.ptr(row);
+            for (int column = 0; column < width; ++column, pixel += 3, rgb += 3) {
+                lumaToRGB(pixel[0], chromaTerms(pixel[1], pixel[2]), rgb);
+            }
+        }
+        return;
+    }
+    // data units: subsamplingX*subsamplingY luma samples followed by Cb and Cr.
+    // Chroma terms are computed once per unit.
+    const int lumaCount = subsamplingX * subsamplingY;
+    const int unitSize = lumaCount + 2;
+    const int unitsPerRow = (width + subsamplingX - 1) / subsamplingX;
+    const uint8_t* unit = data;
+    for (int unitRow = 0; unitRow * subsamplingY < height; ++unitRow) {
+        const int firstRow = unitRow * subsamplingY;
+        const int rows = std::min(subsamplingY, height - firstRow);
+        for (int unitColumn = 0; unitColumn < unitsPerRow; ++unitColumn, unit += unitSize) {
+            const ChromaTerms chroma = chromaTerms(unit[lumaCount], unit[lumaCount + 1]);
+            const int firstColumn = unitColumn * subsamplingX;
+            const int columns = std::min(subsamplingX, width - firstColumn);
+            for (int y = 0; y < rows; ++y) {
+                const uint8_t* luma = unit + y * subsamplingX;
+                uint8_t* rgb = raster.ptr(firstRow + y) + firstColumn * 3;
+                for (int x = 0; x < columns; ++x, rgb += 3) {
+                    lumaToRGB(luma[x], chroma, rgb);
+                }
+            }
+        }
+    }
+}
@@ -122,6 +122,91 @@ void CVTools::insertSliceInMultidimMatrix(cv::Mat& multidimMat, const cv::Mat& s
     }
 }
 
+template <typename Type, int Count>
+static void gatherPixels(const Type* source, int sourceChannels, const int* indices, int count,
+    int pixels, Type* target)
+{
+    // fixed number of output channels: the channel loop is unrolled by the compiler
+    const int targetChannels = Count > 0 ? Count : count;
+    for (int pixel = 0; pixel < pixels; ++pixel, source += sourceChannels, target += targetChannels) {
+        for (int channel = 0; channel < targetChannels; ++channel) {
+            target[channel] = source[indices[channel]];
+        }
+    }
+}
+
+template <typename Type>
+static void gatherChannels(const cv::Mat& source, const std::vector<int>& indices, cv::Mat& target)
+{
+    typedef void (*Kernel)(const Type*, int, const int*, int, int, Type*);
+    const int count = static_cast<int>(indices.size());
+    Kernel kernel = gatherPixels<Type, 0>;
+    switch (count) {
+    case 1: kernel = gatherPixels<Type, 1>; break;
+    case 2: kernel = gatherPixels<Type, 2>; break;
+    case 3: kernel = gatherPixels<Type, 3>; break;
+    case 4: kernel = gatherPixels<Type, 4>; break;
+    default: break;
+    }
+    const int sourceChannels = source.channels();
+    int rows = source.rows;
+    int pixels = source.cols;
+    if (source.isContinuous() && target.isContinuous()) {
+        pixels *= rows;
+        rows = 1;
+    }
+    for (int row = 0; row < rows; ++row) {
+        kernel(source.ptr<Type>(row), sourceChannels, indices.data(), count, pixels, target.ptr<Type>(row));
+    }
+}
+
+void CVTools::extractChannels(const cv::Mat& source, const std::vector<int>& channelIndices, cv::OutputArray output)
+{
+    const int sourceChannels = source.channels();
+    bool identity = channelIndices.empty() || static_cast<int>(channelIndices.size()) == sourceChannels;
+    for (int index = 0; index < static_cast<int>(channelIndices.size()); ++index) {
+        const int channelIndex = channelIndices[index];
+        if (channelIndex < 0 || channelIndex >= sourceChannels) {
+            RAISE_RUNTIME_ERROR << "Attempt to extract channel " << channelIndex << " from "
+                << sourceChannels << " channels.";
+        }
+        identity = identity && channelIndex == index;
+    }
+    if (identity) {
+        source.copyTo(output);
+        return;
+    }
+    // output.create releases the source data if the output is the source matrix: the header keeps it alive
+    const cv::Mat src = source;
+    const int count = static_cast<int>(channelIndices.size());
+    output.create(src.size(), CV_MAKETYPE(src.depth(), count));
+    cv::Mat target = output.getMat();
+    cv::Mat gathered = target;
+    if (target.datastart < src.dataend && src.datastart < target.dataend) {
+        // the output shares memory with the source
+        gathered = cv::Mat(src.size(), target.type());
+    }
+    switch (src.elemSize1()) {
+    case 1:
+        gatherChannels<uint8_t>(src, channelIndices, gathered);
+        break;
+    case 2:
+        gatherChannels<uint16_t>(src, channelIndices, gathered);
+        break;
+    case 4:
+        gatherChannels<uint32_t>(src, channelIndices, gathered);
+        break;
+    case 8:
+        gatherChannels<uint64_t>(src, channelIndices, gathered);
+        break;
+    default:
+        RAISE_RUNTIME_ERROR << "Unsupported element size " << src.elemSize1() << " for channel extraction";
+    }
+    if (gathered.data != target.data) {
+        gathered.copyTo(target);
+    }
+}
+
 std::string CVTools::dataTypeToString(DataType dataType) {
 #define TONAME(name) std::string(#name)
 
@@ -46,6 +46,15 @@ namespace slideio
          */
         static void insertSliceInMultidimMatrix(cv::Mat& multidimMat, const cv::Mat& sliceMat,
                                                 const std::vector<int>& indices);
+        /**
+         * \brief Copies a subset of channels of an interleaved raster to an interleaved raster in one pass.
+         * \param source: interleaved raster
+         * \param channelIndices: source channel indices in the order of the output channels.
+         * Empty vector selects all channels.
+         * \param output: raster of the source depth with channelIndices.size() channels
+         */
+        static void extractChannels(const cv::Mat& source, const std::vector<int>& channelIndices,
+                                    cv::OutputArray output);
         static std::string dataTypeToString(DataType dataType);
         static std::string compressionToString(Compression dataType);
     };
@@ -23,8 +23,16 @@ namespace slideio {
         void setQuality(int quality) {
             m_quality = quality;
         }
+        // number of MCUs between restart markers (0 - no restart markers)
+        int getRestartInterval() const {
+            return m_restartInterval;
+        }
+        void setRestartInterval(int restartInterval) {
+            m_restartInterval = restartInterval;
+        }
     private:
         int m_quality;
+        int m_restartInterval = 0;
     };
     class JP2KEncodeParameters : public EncodeParameters {
     public:
@@ -5,6 +5,7 @@
 #define OPENCV_slideio_imagetools_HPP
 
 #include <opencv2/core.hpp>
+#include <functional>
 #include "slideio/imagetools/slideio_imagetools_def.hpp"
 #include "slideio/base/slideio_enums.hpp"
 #include "slideio/imagetools/encodeparameters.hpp"
@@ -25,23 +26,72 @@ namespace slideio
             std::vector<int> chanelTypes; // cv types
             cv::Size size = {};
         };
+        // jpeg stream with restart markers split into restart intervals. Each interval
+        // covers a rectangle of intervalSize pixels and is decoded independently.
+        struct JpegRestartLayout {
+            std::vector<uint8_t> header;    // stream from SOI to the end of the SOS segment
+            uint32_t sofOffset = 0;         // position of the SOF marker in the header
+            cv::Size imageSize;
+            cv::Size intervalSize;
+            int channels = 0;
+            std::vector<uint64_t> intervals;    // data offsets of the intervals
+            uint64_t dataEnd = 0;               // data offset after the last interval
+        };
+        // reads "size" bytes of jpeg data located at "offset"
+        typedef std::function<void(uint64_t offset, size_t size, uint8_t* buffer)> JpegDataReader;
     public:
         static void readGDALImage(const std::string& path, cv::OutputArray output);
         static void writeRGBImage(const std::string& path, Compression compression, cv::Mat raster);
         static void writeTiffImage(const std::string& path, cv::Mat raster);
         static void readJxrImage(const std::string& path, cv::OutputArray output);
         static void decodeJxrBlock(const uint8_t* data, size_t size, cv::OutputArray output);
-        static void decodeJpegStream(const uint8_t* data, size_t size, cv::OutputArray output);
+        // scaleDenominator 2, 4 or 8 decodes the image reduced by the factor in the inverse DCT.
+        // The reduced size is rounded up.
+        static void decodeJpegStream(const uint8_t* data, size_t size, cv::OutputArray output,
+            int scaleDenominator = 1);
+        // converts 8 bit YCbCr data of tiff files to interleaved RGB. Subsampled data is organized in
+        // units of subsamplingX*subsamplingY luma samples followed by Cb and Cr samples.
+        static void convertYCbCrToRGB(const uint8_t* data, int width, int height,
+            int subsamplingX, int subsamplingY, cv::OutputArray output);
         static void encodeJpeg(const cv::Mat& raster, std::vector<uint8_t>& encodedStream, const JpegEncodeParameters& params);
+        // builds a standalone jpeg stream from an abbreviated one (tiff tiles) and shared tables.
+        // rgbColorSpace marks components as RGB (no YCbCr transform) with an Adobe segment.
+        static void makeStandaloneJpeg(const uint8_t* tables, size_t tablesSize, const uint8_t* data, size_t dataSize,
+            bool rgbColorSpace, std::vector<uint8_t>& output);
+        // parses the header of a baseline jpeg stream with restart markers. imageSize overrides
+        // the size from the SOF segment (huge ndpi strips have no valid size there).
+        // Returns false if the restart intervals do not form a grid of rectangles.
+        static bool parseJpegRestartHeader(const uint8_t* data, size_t size, const cv::Size& imageSize,
+            JpegRestartLayout& layout);
+        // parses a complete jpeg stream in memory and finds the restart intervals by their markers.
+        // Interval offsets are relative to the stream start.
+        static bool parseJpegRestartStream(const uint8_t* data, size_t size, const cv::Size& imageSize,
+            JpegRestartLayout& layout);
+        // finds the restart intervals of entropy coded data between dataOffset and dataEnd by their markers.
+        // The data is read by chunks: the stream does not have to be in memory.
+        static bool scanJpegRestartMarkers(const JpegDataReader& reader, uint64_t dataOffset, uint64_t dataEnd,
+            JpegRestartLayout& layout);
+        // decodes a region of the image: only the intervals that intersect the region are read
+        // (one read per interval row) and they are decoded in parallel. Subsampled chroma is
+        // upsampled within an interval: border pixels may slightly differ from a sequential decoding.
+        static void decodeJpegRestartRegion(const JpegRestartLayout& layout, const JpegDataReader& reader,
+            const cv::Rect& region, cv::OutputArray output);
         // jpeg 2000 related methods
         static void readJp2KFile(const std::string& path, cv::OutputArray output);
         static void readJp2KStremHeader(const uint8_t* data, size_t dataSize, ImageHeader& header);
         static void decodeJp2KStream(const std::vector<uint8_t>& data, cv::OutputArray output,
             const std::vector<int>& channelIndices = std::vector<int>(),
             bool forceYUV = false);
+        // reduction drops the highest wavelet resolution levels: the image is decoded 2^reduction
+        // times smaller (limited by the number of resolution levels of the stream). A non-empty region
+        // (in full resolution image coordinates) restricts decoding to the code blocks of the region.
         static void decodeJp2KStream(const uint8_t* data, size_t dataSize, cv::OutputArray output,
             const std::vector<int>& channelIndices = std::vector<int>(),
-            bool forceYUV = false);
+            bool forceYUV = false, int reduction = 0, const cv::Rect& region = cv::Rect());
+        // threads of the jpeg 2000 decoder (0 - all processors). The default 1 keeps decoding
+        // in the calling thread: tiles of a block are already decoded in parallel.
+        static void setJp2KDecodingThreads(int numThreads);
+        static int getJp2KDecodingThreads();
         static int encodeJp2KStream(const cv::Mat& mat, uint8_t* buffer, int bufferSize,
             const JP2KEncodeParameters& parameters);
         static double computeSimilarity(const cv::Mat& left, const cv::Mat& right, bool ignoreTypes=false);
@@ -11,6 +11,8 @@
 #include <openjpeg.h>
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 
 #include "single_tests/jp2k/jp2_memory.hpp"
@@ -97,6 +99,26 @@ static OPJ_CODEC_FORMAT getJP2KCodec(const std::vector<uint8_t>& data)
     return getJP2KCodec(data.data(), data.size());
 }
 
+// number of threads of the openjpeg decoder: 1 keeps decoding in the calling thread
+static std::atomic<int> jp2kDecodingThreads{1};
+
+// size of a component at the resolution reduced by 2^reduction (as openjpeg computes it)
+static OPJ_UINT32 reducedSize(OPJ_UINT32 begin, OPJ_UINT32 end, int reduction)
+{
+    const OPJ_UINT32 divisor = 1u << reduction;
+    return (end + divisor - 1) / divisor - (begin + divisor - 1) / divisor;
+}
+
+void slideio::ImageTools::setJp2KDecodingThreads(int numThreads)
+{
+    jp2kDecodingThreads = numThreads;
+}
+
+int slideio::ImageTools::getJp2KDecodingThreads()
+{
+    return jp2kDecodingThreads;
+}
+
 void slideio::ImageTools::decodeJp2KStream(
     const std::vector<uint8_t>& data,
     cv::OutputArray output,
@@ -106,7 +128,7 @@ void slideio::ImageTools::decodeJp2KStream(
 }
 
 void slideio::ImageTools::decodeJp2KStream(const uint8_t* data, size_t dataSize, cv::OutputArray output,
-    const std::vector<int>& channelIndices, bool forceYUV) {
+    const std::vector<int>& channelIndices, bool forceYUV, int reduction, const cv::Rect& region) {
     opj_codec_t* codec(nullptr);
     opj_image_t* image(nullptr);
     opj_stream_t* stream(nullptr);
@@ -123,11 +145,40 @@ void slideio::ImageTools::decodeJp2KStream(const uint8_t* data, size_t dataSize,
         if (!opj_setup_decoder(codec, &jp2dParams)) {
             throw std::runtime_error("Cannot setup codec");
         }
+        const int threads = jp2kDecodingThreads;
+        if (threads != 1 && opj_has_thread_support()) {
+            opj_codec_set_threads(codec, threads > 0 ? threads : opj_get_num_cpus());
+        }
         if (!opj_read_header(stream, codec, &image) || (image->numcomps == 0)) {
             throw std::runtime_error("Error reading image header");
         }
         if (forceYUV)
             image->color_space = OPJ_CLRSPC_SYCC;
+        if (reduction > 0) {
+            // the highest wavelet levels are not decoded. At least one resolution must remain.
+            opj_codestream_info_v2_t* info = opj_get_cstr_info(codec);
+            const int numResolutions = (info && info->m_default_tile_info.tccp_info)
+                ? static_cast<int>(info->m_default_tile_info.tccp_info[0].numresolutions) : 1;
+            opj_destroy_cstr_info(&info);
+            reduction = std::min(reduction, numResolutions - 1);
+            if (reduction > 0 && !opj_set_decoded_resolution_factor(codec, static_cast<OPJ_UINT32>(reduction))) {
+                throw std::runtime_error("Cannot set resolution factor of Jp2K stream");
+            }
+        }
+        reduction = std::max(reduction, 0);
+        if (!region.empty()) {
+            // the window is given in the full resolution grid of the image
+            const cv::Rect imageRect(static_cast<int>(image->x0), static_cast<int>(image->y0),
+                static_cast<int>(image->x1 - image->x0), static_cast<int>(image->y1 - image->y0));
+            const cv::Rect area = (region + imageRect.tl()) & imageRect;
+            if (area.empty()) {
+                throw std::runtime_error("Decoding region is outside of Jp2K image");
+            }
+            if (area != imageRect && !opj_set_decode_area(codec, image, area.x, area.y, area.x + area.width,
+                area.y + area.height)) {
+                throw std::runtime_error("Cannot set decoding area of Jp2K stream");
+            }
+        }
         // decode the image
         OPJ_BOOL ret = opj_decode(codec, stream, image);
         if (!ret)
@@ -139,12 +190,12 @@ void slideio::ImageTools::decodeJp2KStream(const uint8_t* data, size_t dataSize,
         opj_stream_destroy(stream);
         stream = nullptr;
 
-        const OPJ_UINT32 imageWidth = image->x1 - image->x0;
-        const OPJ_UINT32 imageHeight = image->y1 - image->y0;
+        // the decoded area at the reduced resolution
+        const OPJ_UINT32 imageWidth = reducedSize(image->x0, image->x1, reduction);
+        const OPJ_UINT32 imageHeight = reducedSize(image->y0, image->y1, reduction);
         const OPJ_UINT32 numComps = image->numcomps;
         const int dt = getComponentDataType(image->comps);
 
-        output.create(imageHeight, imageWidth, CV_MAKETYPE(dt, image->numcomps));
         const cv::Size imageSize(imageWidth, imageHeight);
 
         std::vector<cv::Mat> imagePlanes;
@@ -171,30 +222,34 @@ void slideio::ImageTools::decodeJp2KStream(const uint8_t* data, size_t dataSize,
                 imagePlanes.push_back(compRaster);
             }
         }
-        cv::Mat targetImage;
+        // the planes are merged straight into the output if all channels are requested:
+        // the output may be a view of the caller raster
         if (forceYUV)
         {
             cv::Mat cvImage;
             cv::merge(imagePlanes, cvImage);
-            cv::cvtColor(cvImage, targetImage, cv::COLOR_YUV2RGB);
-        }
-        else
-        {
-            cv::merge(imagePlanes, targetImage);
+            if (channels.empty())
+            {
+                cv::cvtColor(cvImage, output, cv::COLOR_YUV2RGB);
+            }
+            else
+            {
+                cv::cvtColor(cvImage, cvImage, cv::COLOR_YUV2RGB);
+                cv::split(cvImage, imagePlanes);
+            }
         }
-        if (channels.empty())
+        else if (channels.empty())
         {
-            // if no channel is defined - return all channels
-            targetImage.copyTo(output);
+            cv::merge(imagePlanes, output);
         }
-        else
+        if (!channels.empty())
         {
             std::vector<cv::Mat> targetChannels;
             for (const int& channel : channels)
             {
-                cv::Mat channelRaster;
-                cv::extractChannel(targetImage, channelRaster, channel);
-                targetChannels.push_back(channelRaster);
+                if (channel < 0 || channel >= static_cast<int>(imagePlanes.size()))
+                    throw std::runtime_error("Invalid channel index for Jp2K stream");
+                targetChannels.push_back(imagePlanes[channel]);
             }
             if (targetChannels.size() == 1)
             {
@@ -5,12 +5,17 @@
 #include "slideio/imagetools/imagetools.hpp"
 #include "slideio/base/exceptions.hpp"
 #include "slideio/imagetools/jpeglib_aux.hpp"
+#include <cstring>
 
 
-void slideio::ImageTools::decodeJpegStream(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray output)
+void slideio::ImageTools::decodeJpegStream(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray output,
+    int scaleDenominator)
 {
+    if (scaleDenominator != 1 && scaleDenominator != 2 && scaleDenominator != 4 && scaleDenominator != 8) {
+        RAISE_RUNTIME_ERROR << "Invalid jpeg scale denominator " << scaleDenominator << ". Expected 1, 2, 4 or 8";
+    }
     try {
-        jpeglibDecode(jpg_buffer, jpg_size, output);
+        jpeglibDecode(jpg_buffer, jpg_size, output, scaleDenominator);
     }
     catch(std::runtime_error& er) {
         RAISE_RUNTIME_ERROR << "Error decoding jpeg stream: " << er.what();
@@ -21,9 +26,276 @@ void slideio::ImageTools::decodeJpegStream(const uint8_t* jpg_buffer, size_t jpg
 void slideio::ImageTools::encodeJpeg(const cv::Mat& raster, std::vector<uint8_t>& encodedStream, const JpegEncodeParameters& params)
 {
     try {
-        jpeglibEncode(raster, encodedStream, params.getQuality());
+        jpeglibEncode(raster, encodedStream, params.getQuality(), params.getRestartInterval());
     }
     catch (std::runtime_error& er) {
         RAISE_RUNTIME_ERROR << "Error encoding jpeg stream: " << er.what();
     }
 }
+
+void slideio::ImageTools::makeStandaloneJpeg(const uint8_t* tables, size_t tablesSize, const uint8_t* data,
+    size_t dataSize, bool rgbColorSpace, std::vector<uint8_t>& output)
+{
+    const uint8_t SOI[] = { 0xFF, 0xD8 };
+    // APP14 Adobe segment with color transform 0: components are not YCbCr
+    const uint8_t ADOBE[] = { 0xFF, 0xEE, 0x00, 0x0E, 'A', 'd', 'o', 'b', 'e',
+        0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    if (dataSize < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        RAISE_RUNTIME_ERROR << "Invalid jpeg stream: missing SOI marker";
+    }
+    // tables stream: SOI, table segments, EOI
+    const bool hasTables = tables != nullptr && tablesSize > 4;
+    const size_t tablesPayload = hasTables ? tablesSize - 4 : 0;
+    output.clear();
+    output.reserve(dataSize + tablesPayload + (rgbColorSpace ? sizeof(ADOBE) : 0));
+    output.insert(output.end(), SOI, SOI + sizeof(SOI));
+    if (rgbColorSpace) {
+        output.insert(output.end(), ADOBE, ADOBE + sizeof(ADOBE));
+    }
+    if (hasTables) {
+        output.insert(output.end(), tables + 2, tables + 2 + tablesPayload);
+    }
+    output.insert(output.end(), data + 2, data + dataSize);
+}
+
+namespace
+{
+    bool isRestartMarker(uint8_t marker)
+    {
+        return marker >= 0xD0 && marker <= 0xD7;
+    }
+
+    cv::Size intervalGrid(const slideio::ImageTools::JpegRestartLayout& layout)
+    {
+        const cv::Size& imageSize = layout.imageSize;
+        const cv::Size& intervalSize = layout.intervalSize;
+        return { (imageSize.width + intervalSize.width - 1) / intervalSize.width,
+            (imageSize.height + intervalSize.height - 1) / intervalSize.height };
+    }
+}
+
+bool slideio::ImageTools::parseJpegRestartHeader(const uint8_t* data, size_t size, const cv::Size& imageSize,
+    JpegRestartLayout& layout)
+{
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        RAISE_RUNTIME_ERROR << "Invalid jpeg stream: missing SOI marker";
+    }
+    int restartInterval = 0;
+    int maxSamplingH = 0;
+    int maxSamplingV = 0;
+    int channels = 0;
+    int scanChannels = 0;
+    cv::Size sofSize;
+    size_t sofOffset = 0;
+    bool baseline = false;
+    size_t pos = 2;
+    while (true) {
+        if (pos + 4 > size) {
+            RAISE_RUNTIME_ERROR << "Invalid jpeg stream: unexpected end of the header";
+        }
+        if (data[pos] != 0xFF) {
+            RAISE_RUNTIME_ERROR << "Invalid jpeg stream: expected marker at position " << pos;
+        }
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            // fill byte
+            ++pos;
+            continue;
+        }
+        const size_t length = (data[pos + 2] << 8) | data[pos + 3];
+        const uint8_t* segment = data + pos + 4;
+        if (length < 2 || pos + 2 + length > size) {
+            RAISE_RUNTIME_ERROR << "Invalid jpeg stream: truncated segment of marker " << static_cast<int>(marker);
+        }
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            // only sequential dct streams with huffman coding can be split by restart intervals
+            baseline = marker == 0xC0 || marker == 0xC1;
+            sofOffset = pos;
+            channels = segment[5];
+            if (length < 8 + 3 * static_cast<size_t>(channels)) {
+                RAISE_RUNTIME_ERROR << "Invalid jpeg stream: truncated SOF segment";
+            }
+            sofSize.height = (segment[1] << 8) | segment[2];
+            sofSize.width = (segment[3] << 8) | segment[4];
+            for (int channel = 0; channel < channels; ++channel) {
+                const uint8_t sampling = segment[6 + channel * 3 + 1];
+                maxSamplingH = std::max(maxSamplingH, sampling >> 4);
+                maxSamplingV = std::max(maxSamplingV, sampling & 0x0F);
+            }
+        }
+        else if (marker == 0xDD && length >= 4) {
+            restartInterval = (segment[0] << 8) | segment[1];
+        }
+        else if (marker == 0xDA) {
+            scanChannels = segment[0];
+        }
+        pos += 2 + length;
+        if (marker == 0xDA) {
+            break;
+        }
+    }
+    // all components have to be in a single scan: every interval is then a complete image part
+    if (sofOffset == 0 || !baseline || restartInterval == 0 || scanChannels != channels
+        || maxSamplingH == 0 || maxSamplingV == 0) {
+        return false;
+    }
+    layout.imageSize = imageSize.area() > 0 ? imageSize : sofSize;
+    if (layout.imageSize.area() <= 0) {
+        return false;
+    }
+    // a single component scan is not interleaved: its MCU is one 8x8 block
+    const int mcuWidth = channels == 1 ? 8 : maxSamplingH * 8;
+    const int mcuHeight = channels == 1 ? 8 : maxSamplingV * 8;
+    const int mcusPerRow = (layout.imageSize.width + mcuWidth - 1) / mcuWidth;
+    if (restartInterval <= mcusPerRow && mcusPerRow % restartInterval == 0) {
+        layout.intervalSize = { restartInterval * mcuWidth, mcuHeight };
+    }
+    else if (restartInterval % mcusPerRow == 0) {
+        layout.intervalSize = { mcusPerRow * mcuWidth, restartInterval / mcusPerRow * mcuHeight };
+    }
+    else {
+        return false;
+    }
+    // the size of every interval is written to its own SOF segment
+    const int maxDimension = 0xFFFF;
+    if (layout.intervalSize.width > maxDimension || layout.intervalSize.height > maxDimension) {
+        return false;
+    }
+    layout.header.assign(data, data + pos);
+    layout.sofOffset = static_cast<uint32_t>(sofOffset);
+    layout.channels = channels;
+    layout.intervals.clear();
+    layout.dataEnd = 0;
+    return true;
+}
+
+bool slideio::ImageTools::parseJpegRestartStream(const uint8_t* data, size_t size, const cv::Size& imageSize,
+    JpegRestartLayout& layout)
+{
+    if (!parseJpegRestartHeader(data, size, imageSize, layout)) {
+        return false;
+    }
+    return scanJpegRestartMarkers([data](uint64_t offset, size_t count, uint8_t* buffer) {
+        std::memcpy(buffer, data + offset, count);
+    }, layout.header.size(), size, layout);
+}
+
+bool slideio::ImageTools::scanJpegRestartMarkers(const JpegDataReader& reader, uint64_t dataOffset, uint64_t dataEnd,
+    JpegRestartLayout& layout)
+{
+    const uint64_t CHUNK_SIZE = 4 * 1024 * 1024;
+    std::vector<uint8_t> chunk;
+    layout.intervals.assign(1, dataOffset);
+    layout.dataEnd = 0;
+    // a marker may be split between chunks
+    bool markerPrefix = false;
+    for (uint64_t chunkOffset = dataOffset; chunkOffset < dataEnd && layout.dataEnd == 0;) {
+        const size_t chunkSize = static_cast<size_t>(std::min(CHUNK_SIZE, dataEnd - chunkOffset));
+        chunk.resize(chunkSize);
+        reader(chunkOffset, chunkSize, chunk.data());
+        for (size_t pos = 0; pos < chunkSize; ++pos) {
+            const uint8_t value = chunk[pos];
+            if (!markerPrefix) {
+                markerPrefix = value == 0xFF;
+                continue;
+            }
+            // stuffed zeros are skipped with the data, fill bytes keep the prefix
+            markerPrefix = value == 0xFF;
+            if (isRestartMarker(value)) {
+                layout.intervals.push_back(chunkOffset + pos + 1);
+            }
+            else if (value == 0xD9) {
+                layout.dataEnd = chunkOffset + pos + 1;
+                break;
+            }
+        }
+        chunkOffset += chunkSize;
+    }
+    if (layout.dataEnd == 0) {
+        layout.dataEnd = dataEnd;
+    }
+    return static_cast<int>(layout.intervals.size()) == intervalGrid(layout).area();
+}
+
+void slideio::ImageTools::decodeJpegRestartRegion(const JpegRestartLayout& layout, const JpegDataReader& reader,
+    const cv::Rect& region, cv::OutputArray output)
+{
+    const cv::Rect imageRect(cv::Point(0, 0), layout.imageSize);
+    if (region.empty() || (region & imageRect) != region) {
+        RAISE_RUNTIME_ERROR << "Invalid jpeg region (" << region.x << "," << region.y << ","
+            << region.width << "," << region.height << ") for image size " << layout.imageSize.width
+            << "x" << layout.imageSize.height;
+    }
+    const cv::Size grid = intervalGrid(layout);
+    if (static_cast<int>(layout.intervals.size()) != grid.area()) {
+        RAISE_RUNTIME_ERROR << "Invalid jpeg restart layout: expected " << grid.area() << " intervals. Received: "
+            << layout.intervals.size();
+    }
+    const cv::Size& intervalSize = layout.intervalSize;
+    const int firstColumn = region.x / intervalSize.width;
+    const int lastColumn = (region.x + region.width - 1) / intervalSize.width;
+    const int firstRow = region.y / intervalSize.height;
+    const int lastRow = (region.y + region.height - 1) / intervalSize.height;
+    const int rowIntervals = lastColumn - firstColumn + 1;
+
+    // intervals of a row are stored one after another: a single read per row
+    std::vector<std::vector<uint8_t>> rowData(lastRow - firstRow + 1);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const int first = row * grid.width + firstColumn;
+        const int last = row * grid.width + lastColumn;
+        const uint64_t begin = layout.intervals[first];
+        const uint64_t end = last + 1 < grid.area() ? layout.intervals[last + 1] : layout.dataEnd;
+        if (end <= begin) {
+            RAISE_RUNTIME_ERROR << "Invalid jpeg restart layout: empty interval " << first;
+        }
+        std::vector<uint8_t>& data = rowData[row - firstRow];
+        data.resize(static_cast<size_t>(end - begin));
+        reader(begin, data.size(), data.data());
+    }
+
+    output.create(region.size(), CV_MAKETYPE(CV_8U, layout.channels));
+    cv::Mat raster = output.getMat();
+    cv::parallel_for_(cv::Range(0, rowIntervals * (lastRow - firstRow + 1)), [&](const cv::Range& range) {
+        std::vector<uint8_t> stream;
+        for (int item = range.start; item < range.end; ++item) {
+            const int row = firstRow + item / rowIntervals;
+            const int column = firstColumn + item % rowIntervals;
+            const int index = row * grid.width + column;
+            const std::vector<uint8_t>& data = rowData.at(row - firstRow);
+            const uint64_t rowBegin = layout.intervals[row * grid.width + firstColumn];
+            const size_t begin = static_cast<size_t>(layout.intervals[index] - rowBegin);
+            const size_t end = column < lastColumn ? static_cast<size_t>(layout.intervals[index + 1] - rowBegin)
+                : data.size();
+            const cv::Rect intervalRect = cv::Rect(column * intervalSize.width, row * intervalSize.height,
+                intervalSize.width, intervalSize.height) & imageRect;
+
+            stream.assign(layout.header.begin(), layout.header.end());
+            uint8_t* sof = stream.data() + layout.sofOffset;
+            sof[5] = static_cast<uint8_t>(intervalRect.height >> 8);
+            sof[6] = static_cast<uint8_t>(intervalRect.height & 0xFF);
+            sof[7] = static_cast<uint8_t>(intervalRect.width >> 8);
+            sof[8] = static_cast<uint8_t>(intervalRect.width & 0xFF);
+            stream.insert(stream.end(), data.begin() + begin, data.begin() + end);
+            // the restart marker closing the interval becomes the end of image
+            const size_t streamSize = stream.size();
+            if (end - begin >= 2 && stream[streamSize - 2] == 0xFF
+                && (isRestartMarker(stream[streamSize - 1]) || stream[streamSize - 1] == 0xD9)) {
+                stream[streamSize - 1] = 0xD9;
+            }
+            else {
+                stream.push_back(0xFF);
+                stream.push_back(0xD9);
+            }
+            const cv::Rect part = intervalRect & region;
+            if (part == intervalRect) {
+                cv::Mat target = raster(part - region.tl());
+                decodeJpegStream(stream.data(), stream.size(), target);
+            }
+            else {
+                cv::Mat intervalRaster;
+                decodeJpegStream(stream.data(), stream.size(), intervalRaster);
+                intervalRaster(part - intervalRect.tl()).copyTo(raster(part - region.tl()));
+            }
+        }
+    });
+}
@@ -4,7 +4,7 @@
 #include <boost/format.hpp>
 #include <opencv2/core/mat.hpp>
 
-void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray output)
+void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray output, int scaleDenominator)
 {
     // code derived from: https://gist.github.com/PhirePhly/3080633
     struct jpeg_decompress_struct cinfo {};
@@ -29,6 +29,11 @@ void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray o
         );
     }
 
+    // Downscaling by 2, 4 or 8 is done in the inverse DCT: the skipped
+    // coefficients are never computed.
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = static_cast<unsigned int>(scaleDenominator);
+
     // By calling jpeg_start_decompress, you populate cinfo
     // and can then allocate your output bitmap buffers for
     // each scanline.
@@ -43,9 +48,8 @@ void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray o
     output.create(height, width, CV_MAKETYPE(CV_8U, channels));
     cv::Mat mat = output.getMat();
 
-    // The row_stride is the total number of bytes it takes to store an
-    // entire scanline (row). 
-    const unsigned int rowStride = width * channels;
+    // Rows are addressed through the matrix step: the output may be a view
+    // of a larger raster (e.g. a part of the block composed from tiles).
 
     // Now that you have the decompressor entirely configured, it's time
     // to read out all of the scanlines of the jpeg.
@@ -62,8 +66,7 @@ void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray o
     while (cinfo.output_scanline < cinfo.output_height)
     {
         unsigned char* bufferArray[1];
-        bufferArray[0] = mat.data +
-            (cinfo.output_scanline) * rowStride;
+        bufferArray[0] = mat.ptr(static_cast<int>(cinfo.output_scanline));
 
         jpeg_read_scanlines(&cinfo, bufferArray, 1);
     }
@@ -84,7 +87,7 @@ void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray o
     jpeg_destroy_decompress(&cinfo);
 }
 
-void jpeglibEncode(const cv::Mat& raster, std::vector<uint8_t>& encodedStream, int quality)
+void jpeglibEncode(const cv::Mat& raster, std::vector<uint8_t>& encodedStream, int quality, int restartInterval)
 {
     if (!raster.isContinuous()) {
         throw std::runtime_error("Expected continuous matrix!");
@@ -116,6 +119,7 @@ void jpeglibEncode(const cv::Mat& raster, std::vector<uint8_t>& encodedStream, i
     }
     jpeg_set_defaults(&cinfo);
     jpeg_set_quality(&cinfo, quality, TRUE);
+    cinfo.restart_interval = static_cast<unsigned int>(restartInterval);
     size_t length = 0;
     uint8_t* output = nullptr;
     jpeg_mem_dest(&cinfo, &output, &length);
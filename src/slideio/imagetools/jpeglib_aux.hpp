@@ -5,6 +5,6 @@
 #include <vector>
 #include <stdint.h>
 
-void jpeglibEncode(const cv::Mat& raster, std::vector<uint8_t>& encodedStream, int quality);
-void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray output);
+void jpeglibEncode(const cv::Mat& raster, std::vector<uint8_t>& encodedStream, int quality, int restartInterval = 0);
+void jpeglibDecode(const uint8_t* jpg_buffer, size_t jpg_size, cv::OutputArray output, int scaleDenominator = 1);
 
@@ -0,0 +1,61 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/imagetools/tiffdirectorytracker.hpp"
+#include <mutex>
+#include <unordered_map>
+
+using namespace slideio;
+
+namespace
+{
+    struct DirectoryPosition
+    {
+        int dirIndex;
+        int64_t offset;
+        uint64_t ifdOffset;
+    };
+
+    std::mutex& trackerMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::unordered_map<const void*, DirectoryPosition>& positions()
+    {
+        static std::unordered_map<const void*, DirectoryPosition> map;
+        return map;
+    }
+
+    int64_t normalizeOffset(int64_t offset)
+    {
+        // main directories are stored with offset 0
+        return offset > 0 ? offset : 0;
+    }
+}
+
+bool TIFFDirectoryTracker::isCurrent(const void* handle, int dirIndex, int64_t offset, uint64_t currentIFDOffset)
+{
+    std::lock_guard<std::mutex> lock(trackerMutex());
+    const auto it = positions().find(handle);
+    if (it == positions().end()) {
+        return false;
+    }
+    const DirectoryPosition& position = it->second;
+    return position.dirIndex == dirIndex
+        && position.offset == normalizeOffset(offset)
+        && position.ifdOffset == currentIFDOffset;
+}
+
+void TIFFDirectoryTracker::setCurrent(const void* handle, int dirIndex, int64_t offset, uint64_t currentIFDOffset)
+{
+    std::lock_guard<std::mutex> lock(trackerMutex());
+    positions()[handle] = DirectoryPosition{ dirIndex, normalizeOffset(offset), currentIFDOffset };
+}
+
+void TIFFDirectoryTracker::forget(const void* handle)
+{
+    std::lock_guard<std::mutex> lock(trackerMutex());
+    positions().erase(handle);
+}
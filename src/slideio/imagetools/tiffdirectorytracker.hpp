@@ -0,0 +1,37 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/imagetools/slideio_imagetools_def.hpp"
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    /**@brief Keeps the directory last loaded into a libtiff handle.
+     *
+     * libtiff reports the same directory index for a main directory and for a sub-directory
+     * loaded after it, so the index alone cannot tell if a directory switch may be skipped.
+     * The tracker stores the (directory index, sub-directory offset) pair set for a handle
+     * together with the IFD offset reported by libtiff after the switch. The class does not
+     * depend on libtiff: it is shared by the libtiff builds of imagetools and the ndpi driver.
+     */
+    class SLIDEIO_IMAGETOOLS_EXPORTS TIFFDirectoryTracker
+    {
+    public:
+        // returns true if the directory was the last one set for the handle and
+        // the handle was not moved to another IFD since then
+        static bool isCurrent(const void* handle, int dirIndex, int64_t offset, uint64_t currentIFDOffset);
+        static void setCurrent(const void* handle, int dirIndex, int64_t offset, uint64_t currentIFDOffset);
+        // must be called before the handle is closed
+        static void forget(const void* handle);
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
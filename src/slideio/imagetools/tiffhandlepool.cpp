@@ -0,0 +1,47 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/imagetools/tiffhandlepool.hpp"
+#include "slideio/imagetools/tifftools.hpp"
+#include "slideio/base/exceptions.hpp"
+
+using namespace slideio;
+
+TIFFHandlePool::TIFFHandlePool(const std::string& filePath, size_t maxIdlePerDirectory) :
+    m_filePath(filePath), m_maxIdle(maxIdlePerDirectory)
+{
+}
+
+TIFFHandlePool::Handle TIFFHandlePool::acquire(const TiffDirectory& dir)
+{
+    ResourcePool<TIFFKeeper>* pool = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& dirPool = m_pools[DirectoryKey(dir.dirIndex, dir.offset)];
+        if (!dirPool) {
+            const std::string filePath = m_filePath;
+            TiffDirectory pinnedDir;
+            pinnedDir.dirIndex = dir.dirIndex;
+            pinnedDir.offset = dir.offset;
+            dirPool.reset(new ResourcePool<TIFFKeeper>([filePath, pinnedDir]() {
+                std::unique_ptr<TIFFKeeper> keeper(new TIFFKeeper(filePath));
+                if (!keeper->isValid()) {
+                    RAISE_RUNTIME_ERROR << "TIFFHandlePool: cannot open file " << filePath;
+                }
+                TiffTools::setCurrentDirectory(keeper->getHandle(), pinnedDir);
+                return keeper;
+            }, m_maxIdle));
+        }
+        // pools are never removed from the map: the pointer stays valid without the lock
+        pool = dirPool.get();
+    }
+    return pool->acquire();
+}
+
+void TIFFHandlePool::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& item : m_pools) {
+        item.second->clear();
+    }
+}
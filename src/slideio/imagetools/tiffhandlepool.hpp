@@ -0,0 +1,52 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/imagetools/slideio_imagetools_def.hpp"
+#include "slideio/imagetools/tiffkeeper.hpp"
+#include "slideio/base/resourcepool.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    struct TiffDirectory;
+
+    /**@brief Pool of libtiff handles of a file for concurrent reading.
+     *
+     * A libtiff handle keeps the current directory, switching of directories re-parses the IFD.
+     * Every handle of the pool is pinned to one directory (or sub-directory): acquire() returns
+     * a handle with the directory already loaded. Reads from different threads or different
+     * pyramid levels do not interfere and do not re-read directories.
+     */
+    class SLIDEIO_IMAGETOOLS_EXPORTS TIFFHandlePool
+    {
+    public:
+        typedef ResourcePool<TIFFKeeper>::Lease Handle;
+        explicit TIFFHandlePool(const std::string& filePath, size_t maxIdlePerDirectory = 8);
+        TIFFHandlePool(const TIFFHandlePool&) = delete;
+        TIFFHandlePool& operator=(const TIFFHandlePool&) = delete;
+        Handle acquire(const TiffDirectory& dir);
+        void clear();
+        const std::string& getFilePath() const {
+            return m_filePath;
+        }
+    private:
+        typedef std::pair<int, int64_t> DirectoryKey;
+        std::string m_filePath;
+        size_t m_maxIdle;
+        std::mutex m_mutex;
+        std::map<DirectoryKey, std::unique_ptr<ResourcePool<TIFFKeeper>>> m_pools;
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
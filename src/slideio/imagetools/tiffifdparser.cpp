@@ -0,0 +1,343 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/imagetools/tiffifdparser.hpp"
+#include "slideio/base/exceptions.hpp"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstring>
+#include <set>
+#if defined(WIN32)
+#include <codecvt>
+#include <locale>
+#endif
+
+using namespace slideio;
+
+namespace bip = boost::interprocess;
+
+// a bound for corrupted files: real slides have less than a hundred tags per directory
+static const uint64_t MAX_DIRECTORY_ENTRIES = 4096;
+
+struct TiffIFDParser::Mapping
+{
+    bip::file_mapping file;
+    bip::mapped_region region;
+};
+
+const TiffIFDEntry* TiffIFD::findEntry(uint16_t tag) const
+{
+    auto it = std::lower_bound(entries.begin(), entries.end(), tag,
+        [](const TiffIFDEntry& entry, uint16_t value) {
+            return entry.tag < value;
+        });
+    if (it == entries.end() || it->tag != tag) {
+        return nullptr;
+    }
+    return &(*it);
+}
+
+TiffIFDParser::TiffIFDParser(const std::string& filePath, bool ndpi) : m_filePath(filePath), m_ndpi(ndpi)
+{
+    m_mapping.reset(new Mapping);
+#if defined(WIN32)
+    std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
+    const std::wstring wsPath = converter.from_bytes(filePath);
+    m_mapping->file = bip::file_mapping(wsPath.c_str(), bip::read_only);
+#else
+    m_mapping->file = bip::file_mapping(filePath.c_str(), bip::read_only);
+#endif
+    // pages are loaded by the system on access: only the directories are read from the disk
+    m_mapping->region = bip::mapped_region(m_mapping->file, bip::read_only);
+    m_data = static_cast<const uint8_t*>(m_mapping->region.get_address());
+    m_fileSize = m_mapping->region.get_size();
+
+    const uint8_t* header = data(0, 8);
+    if (header[0] == 'I' && header[1] == 'I') {
+        m_bigEndian = false;
+    }
+    else if (header[0] == 'M' && header[1] == 'M') {
+        m_bigEndian = true;
+    }
+    else {
+        RAISE_RUNTIME_ERROR << "TiffIFDParser: " << filePath << " is not a tiff file";
+    }
+    const uint64_t version = readUInt(2, 2);
+    int64_t offset = 0;
+    if (version == 42) {
+        offset = static_cast<int64_t>(readUInt(4, 4));
+    }
+    else if (version == 43 && !m_ndpi) {
+        m_bigTiff = true;
+        if (readUInt(4, 2) != 8) {
+            RAISE_RUNTIME_ERROR << "TiffIFDParser: unsupported offset size of BigTIFF file " << filePath;
+        }
+        offset = static_cast<int64_t>(readUInt(8, 8));
+    }
+    else {
+        RAISE_RUNTIME_ERROR << "TiffIFDParser: unsupported tiff version " << version << " of file " << filePath;
+    }
+    std::set<int64_t> visited;
+    while (offset != 0) {
+        if (!visited.insert(offset).second) {
+            RAISE_RUNTIME_ERROR << "TiffIFDParser: loop in the directory chain of file " << filePath;
+        }
+        int64_t nextOffset = 0;
+        m_directories.push_back(readDirectory(offset, nextOffset));
+        offset = nextOffset;
+    }
+}
+
+TiffIFDParser::~TiffIFDParser() = default;
+
+const TiffIFD& TiffIFDParser::getDirectory(int dirIndex) const
+{
+    if (dirIndex < 0 || dirIndex >= getNumberOfDirectories()) {
+        RAISE_RUNTIME_ERROR << "TiffIFDParser: invalid directory index " << dirIndex
+            << ". Expected range: [0," << getNumberOfDirectories() << ")";
+    }
+    return m_directories[dirIndex];
+}
+
+TiffIFD TiffIFDParser::readDirectory(int64_t offset) const
+{
+    int64_t nextOffset = 0;
+    return readDirectory(offset, nextOffset);
+}
+
+TiffIFD TiffIFDParser::readDirectory(int64_t offset, int64_t& nextOffset) const
+{
+    const int countSize = m_bigTiff ? 8 : 2;
+    const int entrySize = m_bigTiff ? 20 : 12;
+    const int valueSize = m_bigTiff ? 8 : 4;
+    TiffIFD ifd;
+    ifd.offset = offset;
+    const uint64_t entryCount = readUInt(offset, countSize);
+    if (entryCount > MAX_DIRECTORY_ENTRIES) {
+        RAISE_RUNTIME_ERROR << "TiffIFDParser: invalid number of entries " << entryCount
+            << " in directory at offset " << offset;
+    }
+    ifd.entries.resize(entryCount);
+    uint64_t position = offset + countSize;
+    for (auto& entry : ifd.entries) {
+        entry.tag = static_cast<uint16_t>(readUInt(position, 2));
+        entry.type = static_cast<uint16_t>(readUInt(position + 2, 2));
+        entry.count = readUInt(position + 4, m_bigTiff ? 8 : 4);
+        const uint64_t valueField = position + (m_bigTiff ? 12 : 8);
+        const int size = typeSize(entry.type);
+        if (size > 0 && entry.count <= static_cast<uint64_t>(valueSize / size)) {
+            entry.valuePosition = valueField;
+        }
+        else {
+            entry.valuePosition = readUInt(valueField, valueSize);
+        }
+        position += entrySize;
+    }
+    // NDPI files keep 64-bit next directory offsets
+    nextOffset = static_cast<int64_t>(readUInt(position, (m_bigTiff || m_ndpi) ? 8 : 4));
+    if (m_ndpi) {
+        // followed by the high words of the 32-bit value fields
+        position += 8;
+        for (auto& entry : ifd.entries) {
+            const uint64_t high = readUInt(position, 4);
+            const int size = typeSize(entry.type);
+            if (size == 0 || entry.count > static_cast<uint64_t>(valueSize / size)) {
+                entry.valuePosition |= high << 32;
+            }
+            position += 4;
+        }
+    }
+    if (nextOffset < 0 || static_cast<uint64_t>(nextOffset) >= m_fileSize) {
+        RAISE_RUNTIME_ERROR << "TiffIFDParser: invalid offset of the next directory " << nextOffset;
+    }
+    // a wrong offset (e.g. a misread ndpi high word) must fail here and not by reading the value
+    for (const auto& entry : ifd.entries) {
+        const uint64_t size = typeSize(entry.type);
+        if (size > 0 && (entry.count > m_fileSize / size || entry.valuePosition > m_fileSize
+            || entry.count * size > m_fileSize - entry.valuePosition)) {
+            RAISE_RUNTIME_ERROR << "TiffIFDParser: value of tag " << entry.tag << " (" << entry.count
+                << " items at offset " << entry.valuePosition << ") is beyond the end of the file";
+        }
+    }
+    // the specification requires sorted tags, some writers do not follow it
+    std::stable_sort(ifd.entries.begin(), ifd.entries.end(),
+        [](const TiffIFDEntry& left, const TiffIFDEntry& right) {
+            return left.tag < right.tag;
+        });
+    return ifd;
+}
+
+bool TiffIFDParser::getUInt(const TiffIFD& ifd, uint16_t tag, uint64_t& value, uint64_t index) const
+{
+    const TiffIFDEntry* entry = ifd.findEntry(tag);
+    if (!entry || index >= entry->count) {
+        return false;
+    }
+    const int size = typeSize(entry->type);
+    switch (entry->type) {
+    case 1: case 3: case 4: case 7: case 13: case 16: case 18:
+        value = readUInt(entry->valuePosition + index * size, size);
+        return true;
+    case 6: case 8: case 9: case 17:
+    {
+        // sign extension of the signed types
+        const uint64_t raw = readUInt(entry->valuePosition + index * size, size);
+        const int shift = 64 - size * 8;
+        value = static_cast<uint64_t>(static_cast<int64_t>(raw << shift) >> shift);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool TiffIFDParser::getUInts(const TiffIFD& ifd, uint16_t tag, std::vector<uint64_t>& values) const
+{
+    const TiffIFDEntry* entry = ifd.findEntry(tag);
+    if (!entry) {
+        return false;
+    }
+    const int size = typeSize(entry->type);
+    if (size == 0) {
+        return false;
+    }
+    // validates the whole range at once
+    data(entry->valuePosition, entry->count * size);
+    values.resize(entry->count);
+    for (uint64_t index = 0; index < entry->count; ++index) {
+        if (!getUInt(ifd, tag, values[index], index)) {
+            values.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TiffIFDParser::getDouble(const TiffIFD& ifd, uint16_t tag, double& value, uint64_t index) const
+{
+    const TiffIFDEntry* entry = ifd.findEntry(tag);
+    if (!entry || index >= entry->count) {
+        return false;
+    }
+    const uint64_t position = entry->valuePosition + index * typeSize(entry->type);
+    switch (entry->type) {
+    case 5:
+    {
+        const uint64_t numerator = readUInt(position, 4);
+        const uint64_t denominator = readUInt(position + 4, 4);
+        value = denominator ? static_cast<double>(numerator) / static_cast<double>(denominator) : 0.;
+        return true;
+    }
+    case 10:
+    {
+        const int32_t numerator = static_cast<int32_t>(readUInt(position, 4));
+        const int32_t denominator = static_cast<int32_t>(readUInt(position + 4, 4));
+        value = denominator ? static_cast<double>(numerator) / static_cast<double>(denominator) : 0.;
+        return true;
+    }
+    case 11:
+    {
+        const uint32_t bits = static_cast<uint32_t>(readUInt(position, 4));
+        float number;
+        std::memcpy(&number, &bits, sizeof(number));
+        value = number;
+        return true;
+    }
+    case 12:
+    {
+        const uint64_t bits = readUInt(position, 8);
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+    case 6: case 8: case 9: case 17:
+    {
+        uint64_t number = 0;
+        getUInt(ifd, tag, number, index);
+        value = static_cast<double>(static_cast<int64_t>(number));
+        return true;
+    }
+    default:
+    {
+        uint64_t number = 0;
+        if (!getUInt(ifd, tag, number, index)) {
+            return false;
+        }
+        value = static_cast<double>(number);
+        return true;
+    }
+    }
+}
+
+bool TiffIFDParser::getString(const TiffIFD& ifd, uint16_t tag, std::string& value) const
+{
+    const TiffIFDEntry* entry = ifd.findEntry(tag);
+    if (!entry || (entry->type != 2 && entry->type != 7 && entry->type != 1)) {
+        return false;
+    }
+    const char* text = reinterpret_cast<const char*>(data(entry->valuePosition, entry->count));
+    // stops at the first zero as libtiff does
+    const size_t length = std::find(text, text + entry->count, '\0') - text;
+    value.assign(text, length);
+    return true;
+}
+
+bool TiffIFDParser::getLazyString(const TiffIFD& ifd, uint16_t tag, TiffString& value,
+    uint64_t maxEagerSize) const
+{
+    const TiffIFDEntry* entry = ifd.findEntry(tag);
+    if (!entry || (entry->type != 2 && entry->type != 7 && entry->type != 1)) {
+        return false;
+    }
+    if (entry->count <= maxEagerSize) {
+        std::string text;
+        getString(ifd, tag, text);
+        value = text;
+    }
+    else {
+        value = TiffString(m_filePath, entry->valuePosition, entry->count);
+    }
+    return true;
+}
+
+int TiffIFDParser::typeSize(uint16_t type)
+{
+    switch (type) {
+    case 1: case 2: case 6: case 7:
+        return 1;
+    case 3: case 8:
+        return 2;
+    case 4: case 9: case 11: case 13:
+        return 4;
+    case 5: case 10: case 12: case 16: case 17: case 18:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+const uint8_t* TiffIFDParser::data(uint64_t position, uint64_t size) const
+{
+    if (position > m_fileSize || size > m_fileSize - position) {
+        RAISE_RUNTIME_ERROR << "TiffIFDParser: attempt to read " << size << " bytes at offset " << position
+            << " beyond the end of the file (" << m_fileSize << " bytes)";
+    }
+    return m_data + position;
+}
+
+uint64_t TiffIFDParser::readUInt(uint64_t position, int size) const
+{
+    const uint8_t* bytes = data(position, size);
+    uint64_t value = 0;
+    if (m_bigEndian) {
+        for (int index = 0; index < size; ++index) {
+            value = (value << 8) | bytes[index];
+        }
+    }
+    else {
+        for (int index = size - 1; index >= 0; --index) {
+            value = (value << 8) | bytes[index];
+        }
+    }
+    return value;
+}
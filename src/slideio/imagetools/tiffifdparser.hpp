@@ -0,0 +1,96 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/imagetools/slideio_imagetools_def.hpp"
+#include "slideio/imagetools/tiffstring.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    struct TiffIFDEntry
+    {
+        uint16_t tag = 0;
+        uint16_t type = 0;
+        uint64_t count = 0;
+        // file position of the value: inside the entry for short values
+        uint64_t valuePosition = 0;
+    };
+
+    struct TiffIFD
+    {
+        int64_t offset = 0;
+        // sorted by tag
+        std::vector<TiffIFDEntry> entries;
+        const TiffIFDEntry* findEntry(uint16_t tag) const;
+    };
+
+    /**@brief Lightweight parser of TIFF image file directories over a memory mapped file.
+     *
+     * Only the directory entries are parsed on construction: tag values are decoded on request
+     * straight from the mapping, so big values (image descriptions, strip and tile offsets, tables)
+     * that are not requested are never read from the disk. Classic TIFF, BigTIFF and NDPI
+     * (classic TIFF with 64-bit next directory offsets and high words of the entry offsets stored
+     * after the directory) layouts are supported. The parser throws std::runtime_error on
+     * malformed files, including values placed beyond the end of the file. It is immutable after construction and may be used from several threads.
+     */
+    class SLIDEIO_IMAGETOOLS_EXPORTS TiffIFDParser
+    {
+    public:
+        explicit TiffIFDParser(const std::string& filePath, bool ndpi = false);
+        ~TiffIFDParser();
+        TiffIFDParser(const TiffIFDParser&) = delete;
+        TiffIFDParser& operator=(const TiffIFDParser&) = delete;
+        int getNumberOfDirectories() const {
+            return static_cast<int>(m_directories.size());
+        }
+        const TiffIFD& getDirectory(int dirIndex) const;
+        // parses a directory outside of the main chain (e.g. a SubIFD)
+        TiffIFD readDirectory(int64_t offset) const;
+        bool isBigTiff() const {
+            return m_bigTiff;
+        }
+        uint64_t getFileSize() const {
+            return m_fileSize;
+        }
+        const std::string& getFilePath() const {
+            return m_filePath;
+        }
+        // integer value (BYTE, SHORT, LONG, LONG8, IFD and signed types) of the entry item
+        bool getUInt(const TiffIFD& ifd, uint16_t tag, uint64_t& value, uint64_t index = 0) const;
+        bool getUInts(const TiffIFD& ifd, uint16_t tag, std::vector<uint64_t>& values) const;
+        // numeric value of any type, rationals are divided
+        bool getDouble(const TiffIFD& ifd, uint16_t tag, double& value, uint64_t index = 0) const;
+        // ASCII value without the terminating zero
+        bool getString(const TiffIFD& ifd, uint16_t tag, std::string& value) const;
+        // ASCII value read from the file on first access if it is longer than maxEagerSize
+        bool getLazyString(const TiffIFD& ifd, uint16_t tag, TiffString& value, uint64_t maxEagerSize = 256) const;
+        static int typeSize(uint16_t type);
+    private:
+        const uint8_t* data(uint64_t position, uint64_t size) const;
+        uint64_t readUInt(uint64_t position, int size) const;
+        TiffIFD readDirectory(int64_t offset, int64_t& nextOffset) const;
+    private:
+        struct Mapping;
+        std::unique_ptr<Mapping> m_mapping;
+        std::string m_filePath;
+        const uint8_t* m_data = nullptr;
+        uint64_t m_fileSize = 0;
+        bool m_bigEndian = false;
+        bool m_bigTiff = false;
+        bool m_ndpi = false;
+        std::vector<TiffIFD> m_directories;
+    };
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
@@ -0,0 +1,132 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#include "slideio/imagetools/tiffstring.hpp"
+#include "slideio/base/exceptions.hpp"
+#include <fstream>
+#include <mutex>
+#if defined(WIN32)
+#include <codecvt>
+#include <locale>
+#endif
+
+using namespace slideio;
+
+struct TiffString::State
+{
+    std::mutex mutex;
+    std::string value;
+    std::string filePath;
+    uint64_t position = 0;
+    uint64_t count = 0;
+    bool loaded = true;
+};
+
+static const std::string emptyString;
+
+TiffString::TiffString(const std::string& value)
+{
+    *this = value;
+}
+
+TiffString::TiffString(const char* value)
+{
+    *this = value;
+}
+
+TiffString::TiffString(const std::string& filePath, uint64_t position, uint64_t count)
+{
+    m_state = std::make_shared<State>();
+    m_state->filePath = filePath;
+    m_state->position = position;
+    m_state->count = count;
+    m_state->loaded = false;
+}
+
+TiffString& TiffString::operator=(const std::string& value)
+{
+    // copies share the state: assignment never changes the value of the other copies
+    m_state = std::make_shared<State>();
+    m_state->value = value;
+    return *this;
+}
+
+TiffString& TiffString::operator=(const char* value)
+{
+    return *this = std::string(value ? value : "");
+}
+
+const std::string& TiffString::str() const
+{
+    if (!m_state) {
+        return emptyString;
+    }
+    State& state = *m_state;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.loaded) {
+#if defined(WIN32)
+        std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
+        std::ifstream stream(converter.from_bytes(state.filePath), std::ios::binary);
+#else
+        std::ifstream stream(state.filePath, std::ios::binary);
+#endif
+        std::string value(static_cast<size_t>(state.count), '\0');
+        if (!stream || !stream.seekg(static_cast<std::streamoff>(state.position))
+            || !stream.read(&value[0], static_cast<std::streamsize>(value.size()))) {
+            RAISE_RUNTIME_ERROR << "TiffString: cannot read " << state.count << " bytes at offset "
+                << state.position << " of file " << state.filePath;
+        }
+        // stops at the first zero as libtiff does
+        const size_t length = value.find('\0');
+        if (length != std::string::npos) {
+            value.resize(length);
+        }
+        state.value.swap(value);
+        state.loaded = true;
+    }
+    return state.value;
+}
+
+void TiffString::clear()
+{
+    m_state.reset();
+}
+
+bool TiffString::isLoaded() const
+{
+    if (!m_state) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->loaded;
+}
+
+const std::string& TiffString::getFilePath() const
+{
+    return m_state ? m_state->filePath : emptyString;
+}
+
+uint64_t TiffString::getPosition() const
+{
+    return m_state ? m_state->position : 0;
+}
+
+uint64_t TiffString::getCount() const
+{
+    return m_state ? m_state->count : 0;
+}
+
+bool slideio::operator==(const TiffString& left, const TiffString& right)
+{
+    return left.str() == right.str();
+}
+
+bool slideio::operator!=(const TiffString& left, const TiffString& right)
+{
+    return !(left == right);
+}
+
+std::ostream& slideio::operator<<(std::ostream& os, const TiffString& value)
+{
+    return os << value.str();
+}
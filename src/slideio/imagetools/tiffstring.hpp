@@ -0,0 +1,67 @@
+// This file is part of slideio project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://slideio.com/license.html.
+#pragma once
+#include "slideio/imagetools/slideio_imagetools_def.hpp"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#if defined(_MSC_VER)
+#pragma warning( push )
+#pragma warning(disable: 4251)
+#endif
+
+namespace slideio
+{
+    /**@brief String value of a tiff tag that may be read from the file on first access.
+     *
+     * Directory scanners keep big ASCII tags (e.g. image descriptions) as a file position
+     * and a byte count: the value is read when the string is requested for the first time.
+     * Copies share the loaded value. The class is thread safe for reading.
+     */
+    class SLIDEIO_IMAGETOOLS_EXPORTS TiffString
+    {
+    public:
+        TiffString() = default;
+        TiffString(const std::string& value);
+        TiffString(const char* value);
+        // deferred value: count bytes at the file position up to the first zero
+        TiffString(const std::string& filePath, uint64_t position, uint64_t count);
+        TiffString& operator=(const std::string& value);
+        TiffString& operator=(const char* value);
+        const std::string& str() const;
+        operator const std::string&() const {
+            return str();
+        }
+        const char* c_str() const {
+            return str().c_str();
+        }
+        bool empty() const {
+            return str().empty();
+        }
+        size_t size() const {
+            return str().size();
+        }
+        size_t find(const std::string& value, size_t pos = 0) const {
+            return str().find(value, pos);
+        }
+        void clear();
+        bool isLoaded() const;
+        const std::string& getFilePath() const;
+        uint64_t getPosition() const;
+        uint64_t getCount() const;
+    private:
+        struct State;
+        std::shared_ptr<State> m_state;
+    };
+
+    SLIDEIO_IMAGETOOLS_EXPORTS bool operator==(const TiffString& left, const TiffString& right);
+    SLIDEIO_IMAGETOOLS_EXPORTS bool operator!=(const TiffString& left, const TiffString& right);
+    SLIDEIO_IMAGETOOLS_EXPORTS std::ostream& operator<<(std::ostream& os, const TiffString& value);
+}
+
+#if defined(_MSC_VER)
+#pragma warning( pop )
+#endif
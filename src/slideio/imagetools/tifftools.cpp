@@ -8,6 +8,9 @@
 
 #include "slideio/imagetools/imagetools.hpp"
 #include "slideio/imagetools/cvtools.hpp"
+#include "slideio/imagetools/tiffifdparser.hpp"
+#include "slideio/imagetools/tiffdirectorytracker.hpp"
+#include "slideio/base/scratchbuffer.hpp"
 #include <opencv2/core.hpp>
 #include <boost/format.hpp>
 #include "slideio/imagetools/libtiff.hpp"
@@ -283,6 +286,8 @@ libtiff::TIFF* TiffTools::openTiffFile(const std::string& path, bool readOnly)
 {
     namespace fs = boost::filesystem;
     libtiff::TIFF* hfile(nullptr);
+    // "O": tile and strip offsets are loaded on demand instead of whole arrays per directory
+    const char* mode = readOnly ? "rO" : "w";
 #if defined(WIN32)
     std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> converter;
     std::wstring wsPath = converter.from_bytes(path);
@@ -290,13 +295,13 @@ libtiff::TIFF* TiffTools::openTiffFile(const std::string& path, bool readOnly)
     if (readOnly && !fs::exists(wsPath)) {
         RAISE_RUNTIME_ERROR << "File " << path << " does not exist";
     }
-    hfile = libtiff::TIFFOpenW(wsPath.c_str(), readOnly ? "r" : "w");
+    hfile = libtiff::TIFFOpenW(wsPath.c_str(), mode);
 #else
     boost::filesystem::path filePath(path);
     if (readOnly && !fs::exists(filePath)) {
         RAISE_RUNTIME_ERROR << "File " << path << " does not exist";
     }
-    hfile = libtiff::TIFFOpen(path.c_str(),  readOnly ? "r" : "w");
+    hfile = libtiff::TIFFOpen(path.c_str(), mode);
 #endif
     if(!hfile) {
         RAISE_RUNTIME_ERROR << "Cannot open file " << path << " for " << (readOnly ? "reading" : "writing.");
@@ -307,24 +312,16 @@ libtiff::TIFF* TiffTools::openTiffFile(const std::string& path, bool readOnly)
 
 void TiffTools::closeTiffFile(libtiff::TIFF* file)
 {
-    if(file)
+    if(file) {
+        TIFFDirectoryTracker::forget(file);
         libtiff::TIFFClose(file);
+    }
 }
 
 
-static DataType retrieveTiffDataType(libtiff::TIFF* tiff)
+DataType TiffTools::tiffDataType(int bitsPerSample, int sampleFormat)
 {
-    int bitsPerSample = 0;
-    int sampleFormat = 0;
-
     DataType dataType = DataType::DT_Unknown;
-    if (!libtiff::TIFFGetField(tiff, TIFFTAG_BITSPERSAMPLE, &bitsPerSample)) {
-        RAISE_RUNTIME_ERROR << "Cannot retrieve bits per sample from tiff image";
-    }
-    if (!libtiff::TIFFGetField(tiff, TIFFTAG_SAMPLEFORMAT, &sampleFormat)) {
-        sampleFormat = SAMPLEFORMAT_UINT;
-    }
-
     if (bitsPerSample == 8) {
         if(sampleFormat == SAMPLEFORMAT_UINT) {
             dataType = DataType::DT_Byte;
@@ -375,6 +372,38 @@ static DataType retrieveTiffDataType(libtiff::TIFF* tiff)
     return dataType;
 }
 
+DataType TiffTools::retrieveTiffDataType(libtiff::TIFF* tiff)
+{
+    int bitsPerSample = 0;
+    int sampleFormat = 0;
+
+    if (!libtiff::TIFFGetField(tiff, TIFFTAG_BITSPERSAMPLE, &bitsPerSample)) {
+        RAISE_RUNTIME_ERROR << "Cannot retrieve bits per sample from tiff image";
+    }
+    if (!libtiff::TIFFGetField(tiff, TIFFTAG_SAMPLEFORMAT, &sampleFormat)) {
+        sampleFormat = SAMPLEFORMAT_UINT;
+    }
+    return tiffDataType(bitsPerSample, sampleFormat);
+}
+
+Resolution TiffTools::tiffResolution(uint16_t units, float resx, float resy)
+{
+    Resolution res;
+    if (units == RESUNIT_INCH && resx > 0 && resy > 0) {
+        res.x = 0.01 / resx;
+        res.y = 0.01 / resy;
+    }
+    else if (units == RESUNIT_CENTIMETER && resx > 0 && resy > 0) {
+        res.x = 0.01 / resx;
+        res.y = 0.01 / resy;
+    }
+    else {
+        res.x = resx;
+        res.y = resy;
+    }
+    return res;
+}
+
 static void setTiffDataType(libtiff::TIFF* tiff, DataType dataType)
 {
     int sampleFormat = 0;
@@ -468,26 +497,11 @@ void  TiffTools::scanTiffDirTags(libtiff::TIFF* tiff, int dirIndex, int64_t dirO
     dir.stripSize = (int)libtiff::TIFFStripSize(tiff);
     dir.dataType = retrieveTiffDataType(tiff);
     short YCbCrSubsampling[2] = { 2,2 };
-    libtiff::TIFFGetField(tiff, TIFFTAG_YCBCRSUBSAMPLING, &YCbCrSubsampling[0], &YCbCrSubsampling[0]);
+    libtiff::TIFFGetField(tiff, TIFFTAG_YCBCRSUBSAMPLING, &YCbCrSubsampling[0], &YCbCrSubsampling[1]);
     dir.YCbCrSubsampling[0] = YCbCrSubsampling[0];
     dir.YCbCrSubsampling[1] = YCbCrSubsampling[1];
 
-    if(units==RESUNIT_INCH && resx>0 && resy>0){
-        dir.res.x = 0.01/resx;
-        dir.res.y = 0.01/resy;
-    }
-    else if(units==RESUNIT_INCH && resx>0 && resy>0){
-        dir.res.x = 0.0254/resx;
-        dir.res.y = 0.0254/resy;
-    }
-    else if (units == RESUNIT_CENTIMETER && resx > 0 && resy > 0) {
-        dir.res.x = 0.01 / resx;
-        dir.res.y = 0.01 / resy;
-    }
-    else {
-        dir.res.x = resx;
-        dir.res.y = resy;
-    }
+    dir.res = tiffResolution(units, resx, resy);
     dir.position = {posx, posy};
     bool tiled = libtiff::TIFFIsTiled(tiff);
     if(description)
@@ -533,12 +547,85 @@ void TiffTools::scanTiffDir(libtiff::TIFF* tiff, int dirIndex, int64_t dirOffset
         {
             if(libtiff::TIFFSetSubDirectory(tiff, offsets[subdir]))
             {
-                scanTiffDirTags(tiff, dirIndex, dir.subdirectories[subdir].offset, dir.subdirectories[subdir]);
+                scanTiffDirTags(tiff, dirIndex, offsets[subdir], dir.subdirectories[subdir]);
             }
         }
     }
 }
 
+void TiffTools::scanTiffDirTags(const TiffIFDParser& parser, const TiffIFD& ifd, int dirIndex, int64_t dirOffset,
+    TiffDirectory& dir)
+{
+    dir.dirIndex = dirIndex;
+    dir.offset = dirOffset;
+
+    uint64_t value = 0;
+    double number = 0;
+    auto getInt = [&parser, &ifd, &value](uint16_t tag, int defaultValue) {
+        return parser.getUInt(ifd, tag, value) ? static_cast<int>(value) : defaultValue;
+    };
+    auto getFloat = [&parser, &ifd, &number](uint16_t tag) {
+        return parser.getDouble(ifd, tag, number) ? static_cast<float>(number) : 0.f;
+    };
+    // defaults of absent tags follow the libtiff based scanning
+    dir.channels = getInt(TIFFTAG_SAMPLESPERPIXEL, 0);
+    dir.bitsPerSample = getInt(TIFFTAG_BITSPERSAMPLE, 0);
+    dir.compression = static_cast<uint32_t>(getInt(TIFFTAG_COMPRESSION, COMPRESSION_NONE));
+    dir.width = getInt(TIFFTAG_IMAGEWIDTH, 0);
+    dir.height = getInt(TIFFTAG_IMAGELENGTH, 0);
+    dir.tiled = ifd.findEntry(TIFFTAG_TILEWIDTH) != nullptr;
+    dir.tileWidth = getInt(TIFFTAG_TILEWIDTH, 0);
+    dir.tileHeight = getInt(TIFFTAG_TILELENGTH, 0);
+    dir.interleaved = getInt(TIFFTAG_PLANARCONFIG, 0) == PLANARCONFIG_CONTIG;
+    dir.photometric = getInt(TIFFTAG_PHOTOMETRIC, 0);
+    dir.rowsPerStrip = getInt(TIFFTAG_ROWSPERSTRIP, dir.tiled ? 0 : dir.height);
+    dir.YCbCrSubsampling[0] = 2;
+    dir.YCbCrSubsampling[1] = 2;
+    if (parser.getUInt(ifd, TIFFTAG_YCBCRSUBSAMPLING, value, 0)) {
+        dir.YCbCrSubsampling[0] = static_cast<int>(value);
+    }
+    if (parser.getUInt(ifd, TIFFTAG_YCBCRSUBSAMPLING, value, 1)) {
+        dir.YCbCrSubsampling[1] = static_cast<int>(value);
+    }
+    dir.dataType = tiffDataType(dir.bitsPerSample, getInt(TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_UINT));
+    dir.slideioCompression = compressTiffToSlideio(dir.compression);
+    // the pseudo-tag is reported by the libtiff jpeg codec with its default value
+    dir.compressionQuality = dir.compression == COMPRESSION_JPEG ? 75 : 0;
+    const uint16_t units = static_cast<uint16_t>(getInt(TIFFTAG_RESOLUTIONUNIT, 0));
+    dir.res = tiffResolution(units, getFloat(TIFFTAG_XRESOLUTION), getFloat(TIFFTAG_YRESOLUTION));
+    const float posx = getFloat(TIFFTAG_XPOSITION);
+    const float posy = getFloat(TIFFTAG_YPOSITION);
+    dir.position = {posx, posy};
+    dir.description.clear();
+    // descriptions of some formats are megabytes long: they are read on first access
+    parser.getLazyString(ifd, TIFFTAG_IMAGEDESCRIPTION, dir.description);
+    computeStripLayout(dir);
+}
+
+void TiffTools::scanTiffDir(const TiffIFDParser& parser, int dirIndex, TiffDirectory& dir)
+{
+    const TiffIFD& ifd = parser.getDirectory(dirIndex);
+    scanTiffDirTags(parser, ifd, dirIndex, 0, dir);
+    dir.subdirectories.clear();
+    std::vector<uint64_t> offsets;
+    if (parser.getUInts(ifd, TIFFTAG_SUBIFD, offsets) && !offsets.empty()) {
+        dir.subdirectories.resize(offsets.size());
+        for (size_t subdir = 0; subdir < offsets.size(); ++subdir) {
+            const int64_t offset = static_cast<int64_t>(offsets[subdir]);
+            scanTiffDirTags(parser, parser.readDirectory(offset), dirIndex, offset, dir.subdirectories[subdir]);
+        }
+    }
+}
+
+void TiffTools::scanFile(const TiffIFDParser& parser, std::vector<TiffDirectory>& directories)
+{
+    const int dirs = parser.getNumberOfDirectories();
+    directories.resize(dirs);
+    for (int dir = 0; dir < dirs; dir++) {
+        scanTiffDir(parser, dir, directories[dir]);
+    }
+}
+
 void TiffTools::scanFile(libtiff::TIFF* tiff, std::vector<TiffDirectory>& directories)
 {
     int dirs = libtiff::TIFFNumberOfDirectories(tiff);
@@ -552,6 +639,18 @@ void TiffTools::scanFile(libtiff::TIFF* tiff, std::vector<TiffDirectory>& direct
 
 void TiffTools::scanFile(const std::string& filePath, std::vector<TiffDirectory>& directories)
 {
+    try
+    {
+        TiffIFDParser parser(filePath);
+        scanFile(parser, directories);
+        return;
+    }
+    catch(std::exception& ex)
+    {
+        SLIDEIO_LOG(WARNING) << "TiffTools: fast scanning of file " << filePath
+            << " failed, falling back to libtiff: " << ex.what();
+        directories.clear();
+    }
     libtiff::TIFF* file(nullptr);
     try
     {
@@ -570,49 +669,107 @@ void TiffTools::scanFile(const std::string& filePath, std::vector<TiffDirectory>
         closeTiffFile(file);
 }
 
-void TiffTools::readNotRGBStripedDir(libtiff::TIFF* file, const TiffDirectory& dir, cv::_OutputArray output)
+static bool isNotRGB(const TiffDirectory& dir)
 {
-    std::vector<uint8_t> rgbaRaster(4 * dir.rowsPerStrip * dir.width);
+    return dir.photometric == PHOTOMETRIC_YCBCR || dir.photometric == PHOTOMETRIC_CIELAB
+        || dir.photometric == PHOTOMETRIC_ICCLAB || dir.photometric == PHOTOMETRIC_ITULAB;
+}
 
-    int buff_size = dir.width * dir.height * dir.channels * ImageTools::dataTypeSize(dir.dataType);
-    cv::Size sizeImage = { dir.width, dir.height };
-    DataType dt = dir.dataType;
-    output.create(sizeImage, CV_MAKETYPE(CVTools::toOpencvType(dt), dir.channels));
-    cv::Mat imageRaster = output.getMat();
-    setCurrentDirectory(file, dir);
-    if (dir.offset > 0) {
-        libtiff::TIFFSetSubDirectory(file, dir.offset);
+// reads a tile or a strip of a YCbCr directory into a RGB raster of the block size
+static void readYCbCrBlock(libtiff::TIFF* hFile, const TiffDirectory& dir, int block, cv::Mat& rgbRaster)
+{
+    libtiff::tmsize_t readBytes = 0;
+    if (dir.compression == COMPRESSION_JPEG) {
+        // libjpeg upsamples the chroma and converts the colors while decoding
+        if (!libtiff::TIFFSetField(hFile, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB)) {
+            RAISE_RUNTIME_ERROR << "TiffTools: cannot set RGB color mode for directory " << dir.dirIndex;
+        }
+        ScratchBuffer buffer;
+        uint8_t* target = rgbRaster.data;
+        const size_t size = rgbRaster.total() * rgbRaster.elemSize();
+        if (!rgbRaster.isContinuous()) {
+            buffer.resize(size);
+            target = buffer.data();
+        }
+        readBytes = dir.tiled
+            ? libtiff::TIFFReadEncodedTile(hFile, block, target, static_cast<libtiff::tmsize_t>(size))
+            : libtiff::TIFFReadEncodedStrip(hFile, block, target, static_cast<libtiff::tmsize_t>(size));
+        if (readBytes > 0 && target != rgbRaster.data) {
+            cv::Mat(rgbRaster.size(), rgbRaster.type(), target).copyTo(rgbRaster);
+        }
     }
-    uint8_t* buffBegin = imageRaster.data;
-    int stripBuffSize = dir.stripSize;
-    const int imageWidth3 = dir.width * 3;
-    const int imageWidth4 = dir.width * 4;
+    else {
+        const libtiff::tmsize_t size = dir.tiled ? libtiff::TIFFTileSize(hFile) : libtiff::TIFFStripSize(hFile);
+        ScratchBuffer buffer(static_cast<size_t>(size));
+        readBytes = dir.tiled
+            ? libtiff::TIFFReadEncodedTile(hFile, block, buffer.data(), size)
+            : libtiff::TIFFReadEncodedStrip(hFile, block, buffer.data(), size);
+        if (readBytes > 0) {
+            ImageTools::convertYCbCrToRGB(buffer.data(), rgbRaster.cols, rgbRaster.rows,
+                dir.YCbCrSubsampling[0], dir.YCbCrSubsampling[1], rgbRaster);
+        }
+    }
+    if (readBytes <= 0) {
+        RAISE_RUNTIME_ERROR << "TiffTools: error reading block " << block << " of directory " << dir.dirIndex
+            << ". Compression: " << dir.compression;
+    }
+}
 
-    for (int strip = 0, row = 0; row < dir.height; strip++, row += dir.rowsPerStrip, buffBegin += stripBuffSize)
-    {
-        if ((strip + stripBuffSize) > buff_size)
-            stripBuffSize = buff_size - strip;
+// reads a tile or a strip through the libtiff RGBA interface that delivers bottom-up rows
+static void readRGBABlock(libtiff::TIFF* hFile, const TiffDirectory& dir, int block, cv::Mat& rgbRaster)
+{
+    const int width = rgbRaster.cols;
+    const int height = rgbRaster.rows;
+    ScratchBuffer buffer(static_cast<size_t>(width) * height * 4);
+    uint32_t* rgba = reinterpret_cast<uint32_t*>(buffer.data());
+    int read = 0;
+    if (dir.tiled) {
+        const int cols = (dir.width - 1) / dir.tileWidth + 1;
+        const int row = block / cols;
+        const int col = block - row * cols;
+        read = libtiff::TIFFReadRGBATile(hFile, col * dir.tileWidth, row * dir.tileHeight, rgba);
+    }
+    else {
+        read = libtiff::TIFFReadRGBAStrip(hFile, block * dir.rowsPerStrip, rgba);
+    }
+    if (read != 1) {
+        RAISE_RUNTIME_ERROR << "TiffTools: error reading block " << block << " of directory " << dir.dirIndex
+            << ". Compression: " << dir.compression;
+    }
+    // one pass: flips the rows and drops the alpha
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* pixel = buffer.data() + static_cast<size_t>(height - 1 - row) * width * 4;
+        uint8_t* rgb = rgbRaster.ptr(row);
+        for (int column = 0; column < width; ++column, pixel += 4, rgb += 3) {
+            rgb[0] = pixel[0];
+            rgb[1] = pixel[1];
+            rgb[2] = pixel[2];
+        }
+    }
+}
 
-            int stripeRows = dir.rowsPerStrip;
-            if (row + stripeRows > dir.height) {
-                stripeRows = dir.height - row;
-            }
+// decodes a tile or a strip of a directory with not RGB photometric interpretation to top-down RGB
+static void readNotRGBBlock(libtiff::TIFF* hFile, const TiffDirectory& dir, int block, cv::Mat& rgbRaster)
+{
+    if (dir.photometric == PHOTOMETRIC_YCBCR && dir.bitsPerSample == 8 && dir.interleaved) {
+        readYCbCrBlock(hFile, dir, block, rgbRaster);
+    }
+    else {
+        readRGBABlock(hFile, dir, block, rgbRaster);
+    }
+}
 
-            int read = libtiff::TIFFReadRGBAStrip(file, row, (uint32_t*)rgbaRaster.data());
-            if (read != 1) {
-                throw std::runtime_error("TiffTools: Error by reading of tif strip");
-            }
-            uint8_t* lineBegin = buffBegin;
-            uint8_t* stripeLineBegin = rgbaRaster.data();
-            for (int stripeRow = 0; stripeRow < stripeRows; ++stripeRow) {
-                uint8_t* pixelBegin = lineBegin;
-                uint8_t* stripePixelBegin = stripeLineBegin;
-                for (int column = 0; column < dir.width; ++column, pixelBegin += 3, stripePixelBegin += 4) {
-                    memcpy(pixelBegin, stripePixelBegin, 3);
-                }
-                lineBegin += imageWidth3;
-                stripeLineBegin += imageWidth4;
-            }
+void TiffTools::readNotRGBStripedDir(libtiff::TIFF* file, const TiffDirectory& dir, cv::_OutputArray output)
+{
+    output.create(dir.height, dir.width, CV_8UC3);
+    cv::Mat imageRaster = output.getMat();
+    setCurrentDirectory(file, dir);
+    const int rowsPerStrip = (dir.rowsPerStrip > 0) ? std::min(dir.rowsPerStrip, dir.height) : dir.height;
+    for (int strip = 0, row = 0; row < dir.height; strip++, row += rowsPerStrip)
+    {
+        const int stripRows = std::min(rowsPerStrip, dir.height - row);
+        cv::Mat stripRaster = imageRaster.rowRange(row, row + stripRows);
+        readNotRGBBlock(file, dir, strip, stripRaster);
     }
 }
 
@@ -625,9 +782,6 @@ void TiffTools::readRegularStripedDir(libtiff::TIFF* file, const TiffDirectory&
     output.create(sizeImage, CV_MAKETYPE(CVTools::toOpencvType(dt), dir.channels));
     cv::Mat imageRaster = output.getMat();
     setCurrentDirectory(file, dir);
-    if (dir.offset > 0) {
-        libtiff::TIFFSetSubDirectory(file, dir.offset);
-    }
     uint8_t* buffBegin = imageRaster.data;
     int stripBuffSize = dir.stripSize;
 
@@ -650,9 +804,7 @@ void TiffTools::readStripedDir(libtiff::TIFF* file, const TiffDirectory& dir, cv
     if(!dir.interleaved)
         throw std::runtime_error("Planar striped images are not supported");
 
-    std::vector<uint8_t> rgbaRaster;
-    bool notRGB = dir.photometric == 6 || dir.photometric == 8 || dir.photometric == 9 || dir.photometric == 10;
-    if (notRGB) {
+    if (isNotRGB(dir)) {
         readNotRGBStripedDir(file, dir, output);
     }
     else {
@@ -663,6 +815,61 @@ void TiffTools::readStripedDir(libtiff::TIFF* file, const TiffDirectory& dir, cv
 }
 
 
+void TiffTools::readStripedDirRegion(libtiff::TIFF* file, const TiffDirectory& dir, const cv::Rect& region,
+    int rowStep, cv::OutputArray output)
+{
+    if(!dir.interleaved)
+        throw std::runtime_error("Planar striped images are not supported");
+
+    const cv::Rect dirRect(0, 0, dir.width, dir.height);
+    if (region.empty() || (region & dirRect) != region) {
+        RAISE_RUNTIME_ERROR << "TiffTools: region (" << region.x << "," << region.y << ","
+            << region.width << "," << region.height << ") is outside of the directory "
+            << dir.width << "x" << dir.height;
+    }
+    rowStep = std::max(1, rowStep);
+    if (region == dirRect && rowStep == 1) {
+        // strips are decoded directly to the output raster
+        readStripedDir(file, dir, output);
+        return;
+    }
+
+    const bool notRGB = isNotRGB(dir);
+    const int rows = (region.height + rowStep - 1) / rowStep;
+    output.create(rows, region.width, notRGB ? CV_8UC3 : CV_MAKETYPE(CVTools::toOpencvType(dir.dataType), dir.channels));
+    cv::Mat raster = output.getMat();
+    const size_t pixelSize = raster.elemSize();
+    const int rowsPerStrip = (dir.rowsPerStrip > 0) ? std::min(dir.rowsPerStrip, dir.height) : dir.height;
+    const size_t stripLineSize = pixelSize * dir.width;
+    ScratchBuffer stripBuffer(stripLineSize * rowsPerStrip);
+    setCurrentDirectory(file, dir);
+
+    int decodedStrip = -1;
+    for (int row = 0; row < rows; ++row) {
+        const int dirRow = region.y + std::min(row * rowStep + rowStep / 2, region.height - 1);
+        const int strip = dirRow / rowsPerStrip;
+        if (strip != decodedStrip) {
+            const int stripRows = std::min(rowsPerStrip, dir.height - strip * rowsPerStrip);
+            if (notRGB) {
+                cv::Mat stripRaster(stripRows, dir.width, CV_8UC3, stripBuffer.data());
+                readNotRGBBlock(file, dir, strip, stripRaster);
+            }
+            else {
+                const auto read = libtiff::TIFFReadEncodedStrip(file, strip, stripBuffer.data(),
+                    static_cast<libtiff::tmsize_t>(stripRows * stripLineSize));
+                if (read <= 0) {
+                    throw std::runtime_error("TiffTools: Error by reading of tif strip");
+                }
+            }
+            decodedStrip = strip;
+        }
+        const uint8_t* stripLine = stripBuffer.data() + (dirRow - strip * rowsPerStrip) * stripLineSize
+            + region.x * pixelSize;
+        std::memcpy(raster.ptr(row), stripLine, region.width * pixelSize);
+    }
+}
+
+
 void TiffTools::readTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int tile,
     const std::vector<int>& channelIndices, cv::OutputArray output)
 {
@@ -675,7 +882,7 @@ void TiffTools::readTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int til
     {
         readJ2KTile(hFile, dir, tile, channelIndices, output);
     }
-    else if(dir.photometric==6 || dir.photometric==8 || dir.photometric==9 || dir.photometric==10)
+    else if(isNotRGB(dir))
     {
         readNotRGBTile(hFile, dir, tile, channelIndices, output);
     }
@@ -685,24 +892,141 @@ void TiffTools::readTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int til
     }
 }
 
+bool TiffTools::getTileDataRange(libtiff::TIFF* hFile, const TiffDirectory& dir, int tile,
+    int64_t& offset, int64_t& size)
+{
+    if(!dir.tiled){
+        return false;
+    }
+    setCurrentDirectory(hFile, dir);
+    const int tileCount = static_cast<int>(libtiff::TIFFNumberOfTiles(hFile));
+    if(tile < 0 || tile >= tileCount) {
+        return false;
+    }
+    uint64_t* offsets = nullptr;
+    uint64_t* byteCounts = nullptr;
+    if(!libtiff::TIFFGetField(hFile, TIFFTAG_TILEOFFSETS, &offsets) || offsets == nullptr
+        || !libtiff::TIFFGetField(hFile, TIFFTAG_TILEBYTECOUNTS, &byteCounts) || byteCounts == nullptr) {
+        return false;
+    }
+    if(offsets[tile] == 0 || byteCounts[tile] == 0) {
+        return false;
+    }
+    offset = static_cast<int64_t>(offsets[tile]);
+    size = static_cast<int64_t>(byteCounts[tile]);
+    return true;
+}
+
+Compression TiffTools::readRawTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int tile, std::vector<uint8_t>& data)
+{
+    if(!dir.tiled){
+        throw std::runtime_error("TiffTools: Expected tiled configuration, received striped");
+    }
+    setCurrentDirectory(hFile, dir);
+    const int tileCount = static_cast<int>(libtiff::TIFFNumberOfTiles(hFile));
+    if(tile < 0 || tile >= tileCount) {
+        RAISE_RUNTIME_ERROR << "TiffTools: invalid tile index " << tile << " of directory " << dir.dirIndex
+            << ". Expected range: [0," << tileCount << ")";
+    }
+    uint64_t* byteCounts = nullptr;
+    if(!libtiff::TIFFGetField(hFile, TIFFTAG_TILEBYTECOUNTS, &byteCounts) || byteCounts == nullptr) {
+        RAISE_RUNTIME_ERROR << "TiffTools: cannot read tile byte counts of directory " << dir.dirIndex;
+    }
+    std::vector<uint8_t> rawTile(static_cast<size_t>(byteCounts[tile]));
+    const libtiff::tmsize_t readBytes = libtiff::TIFFReadRawTile(hFile, tile, rawTile.data(),
+        static_cast<libtiff::tmsize_t>(rawTile.size()));
+    if(readBytes <= 0) {
+        RAISE_RUNTIME_ERROR << "TiffTools: error reading raw tile " << tile << " of directory " << dir.dirIndex;
+    }
+    rawTile.resize(static_cast<size_t>(readBytes));
+    if(dir.compression == 7) {
+        // abbreviated stream: tables are stored once per directory
+        uint32_t tablesSize = 0;
+        uint8_t* tables = nullptr;
+        if(!libtiff::TIFFGetField(hFile, TIFFTAG_JPEGTABLES, &tablesSize, &tables)) {
+            tablesSize = 0;
+            tables = nullptr;
+        }
+        ImageTools::makeStandaloneJpeg(tables, tablesSize, rawTile.data(), rawTile.size(), dir.photometric == 2, data);
+        return Compression::Jpeg;
+    }
+    data.swap(rawTile);
+    if(dir.compression == 34712 || dir.compression == 33003 || dir.compression == 33005) {
+        return Compression::Jpeg2000;
+    }
+    return dir.slideioCompression;
+}
+
+bool TiffTools::readTileRegion(libtiff::TIFF* hFile, const TiffDirectory& dir, int tile,
+    const std::vector<int>& channelIndices, const cv::Rect& region, int reduction, cv::OutputArray output)
+{
+    const bool jpeg = dir.compression == COMPRESSION_JPEG && dir.dataType == DataType::DT_Byte;
+    const bool jpeg2000 = dir.compression == 34712 || dir.compression == 33003 || dir.compression == 33005;
+    if(!(jpeg || jpeg2000) || (!dir.interleaved && dir.channels > 1) || reduction < 1) {
+        return false;
+    }
+    const cv::Rect tileRect(0, 0, dir.tileWidth, dir.tileHeight);
+    const cv::Rect tileRegion = region.empty() ? tileRect : (region & tileRect);
+    if(tileRegion.empty()) {
+        return false;
+    }
+    std::vector<uint8_t> stream;
+    readRawTile(hFile, dir, tile, stream);
+    if(jpeg2000) {
+        int levels = 0;
+        while((2 << levels) <= reduction) {
+            ++levels;
+        }
+        const bool yuv = dir.channels == 3 && dir.compression == 33003;
+        ImageTools::decodeJp2KStream(stream.data(), stream.size(), output, channelIndices, yuv, levels,
+            tileRegion == tileRect ? cv::Rect() : tileRegion);
+        return true;
+    }
+    cv::Mat tileRaster;
+    ImageTools::decodeJpegStream(stream.data(), stream.size(), tileRaster, reduction);
+    if(tileRaster.channels() != dir.channels) {
+        return false;
+    }
+    if(tileRegion != tileRect) {
+        // the region of the reduced raster: the corners are rounded outwards
+        const int left = tileRegion.x / reduction;
+        const int top = tileRegion.y / reduction;
+        const int right = (tileRegion.x + tileRegion.width + reduction - 1) / reduction;
+        const int bottom = (tileRegion.y + tileRegion.height + reduction - 1) / reduction;
+        const cv::Rect part(left, top, right - left, bottom - top);
+        tileRaster = tileRaster(part & cv::Rect(0, 0, tileRaster.cols, tileRaster.rows));
+    }
+    CVTools::extractChannels(tileRaster, channelIndices, output);
+    return true;
+}
+
 void TiffTools::readRegularTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int tile,
             const std::vector<int>& channelIndices, cv::OutputArray output)
 {
     cv::Size tileSize = { dir.tileWidth, dir.tileHeight };
     DataType dt = dir.dataType;
+    const int tileType = CV_MAKETYPE(CVTools::toOpencvType(dt), dir.channels);
+    const bool allChannels = channelIndices.empty() || (channelIndices.size() == 1 && dir.channels == 1);
+    ScratchBuffer tileBuffer;
     cv::Mat tileRaster;
-    tileRaster.create(tileSize, CV_MAKETYPE(CVTools::toOpencvType(dt), dir.channels));
-    setCurrentDirectory(hFile, dir);
-    if (dir.offset > 0) {
-        libtiff::TIFFSetSubDirectory(hFile, dir.offset);
+    if(allChannels)
+    {
+        // decode straight into the caller raster if libtiff can write it as a continuous buffer
+        output.create(tileSize, tileType);
+        tileRaster = output.getMat();
     }
+    if(tileRaster.empty() || !tileRaster.isContinuous())
+    {
+        tileBuffer.resize(static_cast<size_t>(tileSize.area()) * CV_ELEM_SIZE(tileType));
+        tileRaster = cv::Mat(tileSize, tileType, tileBuffer.data());
+    }
+    setCurrentDirectory(hFile, dir);
     // if(dir.compression==7) {
     //     std::vector<uint8_t> buff(libtiff::TIFFTileSize(hFile));
     //     int64_t size = libtiff::TIFFReadRawTile(hFile, tile, buff.data(), buff.size());
     //     buff.resize(size);
     //     ImageTools::decodeJpegStream(buff.data(), buff.size(), tileRaster);
     // }
-    else 
     {
         uint8_t* buff_begin = tileRaster.data;
         auto buf_size = tileRaster.total() * tileRaster.elemSize();
@@ -713,23 +1037,15 @@ void TiffTools::readRegularTile(libtiff::TIFF* hFile, const TiffDirectory& dir,
                     "TiffTools: error reading encoded tiff tile %1% of directory %2%."
                     "Compression: %3%") % tile % dir.dirIndex % dir.compression).str());
     }
-    if(channelIndices.empty() || (channelIndices.size() == 1 && dir.channels==1))
+    if(allChannels)
     {
-        tileRaster.copyTo(output);
-    }
-    else if(channelIndices.size()==1)
-    {
-        cv::extractChannel(tileRaster, output, channelIndices[0]);
+        if(tileRaster.data != output.getMat().data) {
+            tileRaster.copyTo(output);
+        }
     }
     else
     {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(channelIndices.size());
-        for(int channelIndex : channelIndices)
-        {
-            cv::extractChannel(tileRaster, channelRasters[channelIndex], channelIndices[channelIndex]);
-        }
-        cv::merge(channelRasters, output);
+        CVTools::extractChannels(tileRaster, channelIndices, output);
     }
 }
 
@@ -738,7 +1054,7 @@ void TiffTools::readJ2KTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int
                                      const std::vector<int>& channelIndices, cv::OutputArray output)
 {
     const auto tileSize = libtiff::TIFFTileSize(hFile);
-    std::vector<uint8_t> rawTile(tileSize);
+    ScratchBuffer rawTile(tileSize);
     if(dir.interleaved || dir.channels == 1)
     {
         // process interleaved channels
@@ -747,7 +1063,7 @@ void TiffTools::readJ2KTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int
             throw std::runtime_error("TiffTools: Error reading raw tile");
         }
         bool yuv = dir.channels==3 && dir.compression==33003;
-        ImageTools::decodeJp2KStream(rawTile, output, channelIndices, yuv);
+        ImageTools::decodeJp2KStream(rawTile.data(), static_cast<size_t>(readBytes), output, channelIndices, yuv);
     }
     else
     {
@@ -758,52 +1074,19 @@ void TiffTools::readJ2KTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int
 void TiffTools::readNotRGBTile(libtiff::TIFF* hFile, const TiffDirectory& dir, int tile,
     const std::vector<int>& channelIndices, cv::OutputArray output)
 {
-    cv::Size tileSize = { dir.tileWidth, dir.tileHeight };
-    DataType dt = dir.dataType;
-    cv::Mat tileRaster;
-    tileRaster.create(tileSize, CV_MAKETYPE(CVTools::toOpencvType(dt), 4));
+    const cv::Size tileSize = { dir.tileWidth, dir.tileHeight };
     setCurrentDirectory(hFile, dir);
-    uint32_t* buffBegin = reinterpret_cast<uint32_t*>(tileRaster.data);
-
-    int cols = (dir.width - 1) / dir.tileWidth + 1;
-    int rows = (dir.height - 1) / dir.tileHeight + 1;
-    int row = tile / cols;
-    int col = tile - row * cols;
-    int tileX = col * dir.tileWidth;
-    int tileY = row * dir.tileHeight;
-    auto readBytes = libtiff::TIFFReadRGBATile(hFile, tileX, tileY, buffBegin);
-    if (readBytes <= 0)
-        throw std::runtime_error(
-            (boost::format(
-                "TiffTools: error reading encoded tiff tile %1% of directory %2%."
-                "Compression: %3%") % tile % dir.dirIndex % dir.compression).str());
-
-    cv::Mat flipped;
     if (channelIndices.empty())
     {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(3);
-        for (int channelIndex=0; channelIndex<3; ++channelIndex)
-        {
-            cv::extractChannel(tileRaster, channelRasters[channelIndex], channelIndex);
-        }
-        cv::merge(channelRasters, flipped);
-    }
-    else if (channelIndices.size() == 1)
-    {
-        cv::extractChannel(tileRaster, flipped, channelIndices[0]);
-    }
-    else
-    {
-        std::vector<cv::Mat> channelRasters;
-        channelRasters.resize(channelIndices.size());
-        for (int channelIndex : channelIndices)
-        {
-            cv::extractChannel(tileRaster, channelRasters[channelIndex], channelIndices[channelIndex]);
-        }
-        cv::merge(channelRasters, flipped);
+        output.create(tileSize, CV_8UC3);
+        cv::Mat tileRaster = output.getMat();
+        readNotRGBBlock(hFile, dir, tile, tileRaster);
+        return;
     }
-    cv::flip(flipped, output, 0);
+    ScratchBuffer tileBuffer(static_cast<size_t>(tileSize.area()) * 3);
+    cv::Mat tileRaster(tileSize, CV_8UC3, tileBuffer.data());
+    readNotRGBBlock(hFile, dir, tile, tileRaster);
+    CVTools::extractChannels(tileRaster, channelIndices, output);
 }
 
 void TiffTools::writeDirectory(libtiff::TIFF* tiff)
@@ -915,16 +1198,23 @@ int TiffTools::getNumberOfDirectories(libtiff::TIFF* tiff) {
 
 void TiffTools::setCurrentDirectory(libtiff::TIFF* hFile, const TiffDirectory& dir)
 {
-    if(libtiff::TIFFCurrentDirectory(hFile) != static_cast<uint16_t>(dir.dirIndex)) {
-        if (!libtiff::TIFFSetDirectory(hFile, static_cast<uint16_t>(dir.dirIndex))) {
-            throw std::runtime_error("TiffTools: error by setting current directory");
-        }
+    // the directory index stays unchanged when a sub-directory is loaded:
+    // a switch is skipped only if the handle is still on the IFD loaded for the same (index, offset)
+    if(TIFFDirectoryTracker::isCurrent(hFile, dir.dirIndex, dir.offset, libtiff::TIFFCurrentDirOffset(hFile))) {
+        return;
     }
+    TIFFDirectoryTracker::forget(hFile);
     if(dir.offset>0){
         if(!libtiff::TIFFSetSubDirectory(hFile, dir.offset)){
             throw std::runtime_error("TiffTools: error by setting current sub-directory");
         }
     }
+    else {
+        if (!libtiff::TIFFSetDirectory(hFile, static_cast<uint16_t>(dir.dirIndex))) {
+            throw std::runtime_error("TiffTools: error by setting current directory");
+        }
+    }
+    TIFFDirectoryTracker::setCurrent(hFile, dir.dirIndex, dir.offset, libtiff::TIFFCurrentDirOffset(hFile));
 }
 
 void TiffTools::scaleBlockToDirectory(const TiffDirectory& basisDir,  const TiffDirectory& dir, const cv::Rect& basisDirRect, cv::Rect& dirBlockRect)
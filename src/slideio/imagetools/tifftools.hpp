@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "imagetools.hpp"
+#include "slideio/imagetools/tiffstring.hpp"
 
 namespace libtiff
 {
@@ -22,6 +23,9 @@ namespace libtiff
 
 namespace slideio
 {
+    class TiffIFDParser;
+    struct TiffIFD;
+
     struct TiffDirectory
     {
         int width;
@@ -37,7 +41,7 @@ namespace slideio
         Compression slideioCompression;
         int dirIndex;
         int64 offset;
-        std::string description;
+        TiffString description;
         std::vector<TiffDirectory> subdirectories;
         Resolution res;
         cv::Point2d position;
@@ -57,12 +61,32 @@ namespace slideio
         static void scanTiffDirTags(libtiff::TIFF* tiff, int dirIndex, int64_t dirOffset, slideio::TiffDirectory& dir);
         static void scanTiffDir(libtiff::TIFF* tiff, int dirIndex, int64_t dirOffset, slideio::TiffDirectory& dir);
         static void scanFile(libtiff::TIFF* file, std::vector<TiffDirectory>& directories);
+        // scans the directories from a memory mapped file without libtiff, falls back to libtiff on failure
         static void scanFile(const std::string& filePath, std::vector<TiffDirectory>& directories);
+        static void scanTiffDirTags(const TiffIFDParser& parser, const TiffIFD& ifd, int dirIndex, int64_t dirOffset,
+            slideio::TiffDirectory& dir);
+        static void scanTiffDir(const TiffIFDParser& parser, int dirIndex, slideio::TiffDirectory& dir);
+        static void scanFile(const TiffIFDParser& parser, std::vector<TiffDirectory>& directories);
         static void readNotRGBStripedDir(libtiff::TIFF* tiff, const TiffDirectory& dir, cv::_OutputArray output);
         static void readRegularStripedDir(libtiff::TIFF* file, const slideio::TiffDirectory& dir, cv::OutputArray output);
         static void readStripedDir(libtiff::TIFF* file, const slideio::TiffDirectory& dir, cv::OutputArray output);
+        // decodes only the strips intersecting the region. rowStep > 1 keeps every rowStep-th row
+        // of the region (nearest row in the middle of the step): strips without the kept rows are skipped.
+        static void readStripedDirRegion(libtiff::TIFF* file, const slideio::TiffDirectory& dir, const cv::Rect& region,
+            int rowStep, cv::OutputArray output);
         static void readTile(libtiff::TIFF* hFile, const slideio::TiffDirectory& dir, int tile,
             const std::vector<int>& channelIndices, cv::OutputArray output);
+        // reads encoded tile data without decoding. Jpeg tiles are completed with the directory tables.
+        static Compression readRawTile(libtiff::TIFF* hFile, const slideio::TiffDirectory& dir, int tile,
+            std::vector<uint8_t>& data);
+        // decodes a region of a tile (empty region - the whole tile) reduced by the factor 1, 2, 4 or 8.
+        // Jpeg tiles are reduced in the inverse DCT and cropped, jpeg 2000 tiles skip the resolution
+        // levels and the code blocks outside of the region. Returns false for other compressions.
+        static bool readTileRegion(libtiff::TIFF* hFile, const slideio::TiffDirectory& dir, int tile,
+            const std::vector<int>& channelIndices, const cv::Rect& region, int reduction, cv::OutputArray output);
+        // file offset and size of the encoded tile data. Returns false if the tile is not stored.
+        static bool getTileDataRange(libtiff::TIFF* hFile, const slideio::TiffDirectory& dir, int tile,
+            int64_t& offset, int64_t& size);
         static void setCurrentDirectory(libtiff::TIFF* hFile, const slideio::TiffDirectory& dir);
         static void scaleBlockToDirectory(const TiffDirectory& basisDir, const TiffDirectory& dir,
                                    const cv::Rect& basisDirRect, cv::Rect& dirBlockRect);
@@ -79,7 +103,69 @@ namespace slideio
             uint8_t* buffer=nullptr, int bufferSize=0);
         static std::string readStringTag(libtiff::TIFF* tiff, uint16_t tag);
         static int getNumberOfDirectories(libtiff::TIFF* tiff);
+        // slideio data type of tiff samples. Throws for unsupported sample formats.
+        static DataType tiffDataType(int bitsPerSample, int sampleFormat);
+        static DataType retrieveTiffDataType(libtiff::TIFF* tiff);
+        // pixel size in meters from the resolution tags
+        static Resolution tiffResolution(uint16_t units, float resx, float resy);
+        // strip layout as libtiff exposes it: TIFFStripSize and chopping of single uncompressed strips
+        // into virtual strips of ~8K. Works for any directory structure with TiffDirectory fields.
+        template <typename Directory>
+        static void computeStripLayout(Directory& dir);
+    private:
+        template <typename Directory>
+        static uint64_t rowBlockSize(const Directory& dir, int& rowBlock);
     };
+
+    // size of a row block: one scanline or, for subsampled YCbCr data, a row of sampling blocks
+    template <typename Directory>
+    uint64_t TiffTools::rowBlockSize(const Directory& dir, int& rowBlock)
+    {
+        const int photometricYCbCr = 6;
+        rowBlock = 1;
+        const uint64_t width = static_cast<uint64_t>(dir.width);
+        if (dir.interleaved && dir.photometric == photometricYCbCr && dir.channels == 3
+            && dir.YCbCrSubsampling[0] > 0 && dir.YCbCrSubsampling[1] > 0) {
+            const uint64_t horizontal = dir.YCbCrSubsampling[0];
+            const uint64_t vertical = dir.YCbCrSubsampling[1];
+            const uint64_t blocks = (width + horizontal - 1) / horizontal;
+            const uint64_t samples = blocks * (horizontal * vertical + 2);
+            rowBlock = static_cast<int>(vertical);
+            return (samples * dir.bitsPerSample + 7) / 8;
+        }
+        const uint64_t samples = dir.interleaved ? width * dir.channels : width;
+        return (samples * dir.bitsPerSample + 7) / 8;
+    }
+
+    template <typename Directory>
+    void TiffTools::computeStripLayout(Directory& dir)
+    {
+        const uint32_t compressionNone = 1;
+        const uint64_t defaultStripSize = 8192;
+        if (dir.height <= 0) {
+            dir.stripSize = 0;
+            return;
+        }
+        int rowBlock = 1;
+        const uint64_t blockSize = rowBlockSize(dir, rowBlock);
+        const bool singleStrip = dir.rowsPerStrip <= 0 || dir.rowsPerStrip >= dir.height;
+        if (!dir.tiled && singleStrip && dir.interleaved && dir.compression == compressionNone && blockSize > 0) {
+            int rowsPerStrip = rowBlock;
+            if (blockSize <= defaultStripSize) {
+                rowsPerStrip = static_cast<int>(defaultStripSize / blockSize) * rowBlock;
+            }
+            const int currentRows = dir.rowsPerStrip > 0 ? dir.rowsPerStrip : dir.height;
+            if (rowsPerStrip < currentRows) {
+                dir.rowsPerStrip = rowsPerStrip;
+            }
+        }
+        int rows = dir.rowsPerStrip;
+        if (rows <= 0 || rows > dir.height) {
+            rows = dir.height;
+        }
+        const uint64_t blocks = (static_cast<uint64_t>(rows) + rowBlock - 1) / rowBlock;
+        dir.stripSize = static_cast<int>(blocks * blockSize);
+    }
 }
 
 //boost::log::basic_formatting_ostream& operator << (boost::log::basic_formatting_ostream& os, const slideio::TiffDirectory& dir);
@@ -9,6 +9,7 @@
 #include "slideio/base/log.hpp"
 
 #include "slideio/base/exceptions.hpp"
+#include <algorithm>
 
 using namespace slideio;
 
@@ -243,37 +244,25 @@ void Scene::readResampled4DBlockChannels(const std::tuple<int, int, int, int>& r
         }
     }
     else {
-        cv::Mat mdRaster;
-        std::vector<int> indices;
-        int sliceIndex(-1), frameIndex(-1);
-
-        if(numSlices > 1) {
-            sliceIndex = 0;
-            indices.push_back(0);
-        }
-        if( numFrames > 1) {
-            frameIndex = sliceIndex + 1;
-            indices.push_back(0);
-        }
-        int planeNum(0);
+        // planes are stored one after another (time frames, then slices):
+        // every plane is read through the 4D entry point of the scene straight into its part of the buffer
         uint8_t* planeBegin = static_cast<uint8_t*>(buffer);
-        m_scene->readResampled4DBlockChannels(blockRect, blockSize, channelIndices, sliceRange, frameRange, mdRaster);
+        const int planeType = CV_MAKETYPE(CVTools::cvTypeFromDataType(cvType), numChannels);
         for (int tfIndex = frameRange.start; tfIndex < frameRange.end; ++tfIndex)
         {
-            if(frameIndex>=0) {
-                indices[frameIndex] = tfIndex - frameRange.start;
-            }
-            for (int zSlieceIndex = sliceRange.start; zSlieceIndex < sliceRange.end; ++zSlieceIndex, ++planeNum, planeBegin+=planeMemSize)
+            for (int zSlieceIndex = sliceRange.start; zSlieceIndex < sliceRange.end; ++zSlieceIndex, planeBegin+=planeMemSize)
             {
-                if (sliceIndex >= 0) {
-                    indices[sliceIndex] = zSlieceIndex - sliceRange.start;
-                }
-                cv::Mat sliceRaster;
-                CVTools::extractSliceFromMultidimMatrix(mdRaster, indices , sliceRaster);
-                if( !sliceRaster.isContinuous()) {
-                    throw std::runtime_error("Unexpected non-continuous matrix");
+                cv::Mat planeRaster(blockSize.height, blockSize.width, planeType, planeBegin);
+                m_scene->readResampled4DBlockChannels(blockRect, blockSize, channelIndices,
+                    cv::Range(zSlieceIndex, zSlieceIndex + 1), cv::Range(tfIndex, tfIndex + 1), planeRaster);
+                if (planeBegin != planeRaster.data) {
+                    // the driver allocated its own raster: copy it to the buffer
+                    if (planeRaster.rows != blockSize.height || planeRaster.cols != blockSize.width
+                        || planeRaster.type() != planeType) {
+                        throw std::runtime_error("Unexpected size or type of a plane raster");
+                    }
+                    planeRaster.copyTo(cv::Mat(blockSize.height, blockSize.width, planeType, planeBegin));
                 }
-                memcpy(planeBegin, sliceRaster.data, planeMemSize);
             }
         }
     }
@@ -314,6 +303,81 @@ const LevelInfo* Scene::getLevelInfo(int level) const {
 	return m_scene->getZoomLevelInfo(level);
 }
 
+Compression Scene::readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data) {
+    SLIDEIO_LOG(INFO) << "Scene::readRawTile " << zoomLevel << ", " << tileIndex;
+    return m_scene->readRawTile(zoomLevel, tileIndex, data);
+}
+
+std::tuple<int, int, int, int> Scene::getLevelTileRect(int zoomLevel, int tileX, int tileY) const
+{
+    const cv::Rect rect = m_scene->getLevelTileRect(zoomLevel, tileX, tileY);
+    return std::tuple<int, int, int, int>(rect.x, rect.y, rect.width, rect.height);
+}
+
+void Scene::readLevelBlockChannels(int zoomLevel, const std::tuple<int, int, int, int>& levelRect,
+    const std::vector<int>& channelIndices, int zSliceIndex, int tFrameIndex, void* buffer, size_t bufferSize)
+{
+    SLIDEIO_LOG(INFO) << "Scene::readLevelBlockChannels " << zoomLevel;
+    const cv::Rect blockRect = tupleToRect(levelRect);
+    const int numChannels = (channelIndices.empty()?m_scene->getNumChannels():static_cast<int>(channelIndices.size()));
+    const int refChannel = (channelIndices.empty()?0:channelIndices[0]);
+    const std::tuple<int, int> size(blockRect.width, blockRect.height);
+    const int blockMemSize = getBlockSize(size, refChannel, numChannels, 1, 1);
+    const auto dt = m_scene->getChannelDataType(refChannel);
+    const int cvType = CVTools::cvTypeFromDataType(dt);
+
+    if(blockMemSize>bufferSize)
+    {
+        throw std::runtime_error("Supplied memory buffer is too small");
+    }
+    cv::Mat raster(blockRect.height, blockRect.width, CV_MAKETYPE(cvType, numChannels), buffer);
+    m_scene->readLevelBlockChannels(zoomLevel, blockRect, channelIndices, zSliceIndex, tFrameIndex, raster);
+
+    if(buffer!=raster.data)
+    {
+        RAISE_RUNTIME_ERROR << "Unexpected data reallocation by reading of file " << getFilePath();
+    }
+}
+
+void Scene::readLevelTile(int zoomLevel, int tileX, int tileY, const std::vector<int>& channelIndices,
+    int zSliceIndex, int tFrameIndex, void* buffer, size_t bufferSize)
+{
+    SLIDEIO_LOG(INFO) << "Scene::readLevelTile " << zoomLevel << ", " << tileX << ", " << tileY;
+    readLevelBlockChannels(zoomLevel, getLevelTileRect(zoomLevel, tileX, tileY), channelIndices,
+        zSliceIndex, tFrameIndex, buffer, bufferSize);
+}
+
+void Scene::readBlocks(const std::vector<std::tuple<int, int, int, int>>& blockRects,
+    const std::tuple<int, int>& blockSize, const std::vector<int>& channelIndices, void* buffer, size_t bufferSize)
+{
+    SLIDEIO_LOG(INFO) << "Scene::readBlocks " << blockRects.size();
+    if(blockRects.empty())
+    {
+        return;
+    }
+    std::vector<cv::Rect> rects(blockRects.size());
+    std::transform(blockRects.begin(), blockRects.end(), rects.begin(), tupleToRect);
+    const cv::Size size = tupleToSize(blockSize);
+    const int numChannels = (channelIndices.empty()?m_scene->getNumChannels():static_cast<int>(channelIndices.size()));
+    const int refChannel = (channelIndices.empty()?0:channelIndices[0]);
+    const size_t blockMemSize = static_cast<size_t>(getBlockSize(blockSize, refChannel, numChannels, 1, 1));
+    const auto dt = m_scene->getChannelDataType(refChannel);
+    const int cvType = CVTools::cvTypeFromDataType(dt);
+
+    if(blockMemSize*rects.size()>bufferSize)
+    {
+        throw std::runtime_error("Supplied memory buffer is too small");
+    }
+    const int dims[] = { static_cast<int>(rects.size()), size.height, size.width };
+    cv::Mat raster(3, dims, CV_MAKETYPE(cvType, numChannels), buffer);
+    m_scene->readBlocks(rects, size, channelIndices, raster);
+
+    if(buffer!=raster.data)
+    {
+        RAISE_RUNTIME_ERROR << "Unexpected data reallocation by reading of file " << getFilePath();
+    }
+}
+
 std::string Scene::toString() const {
     return m_scene->toString();
 }
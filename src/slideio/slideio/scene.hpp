@@ -270,6 +270,55 @@ namespace slideio
         std::shared_ptr<CVScene> getCVScene() { return m_scene; }
         int getNumZoomLevels() const;
         const LevelInfo* getLevelInfo(int level) const;
+        /**@brief reads encoded data of a tile of a zoom level without decoding.
+         * @param zoomLevel : index of the zoom level.
+         * @param tileIndex : index of the tile in the row-major grid of level tiles.
+         * @param data : receives compressed tile data. JPEG tiles are returned as standalone streams.
+         * The method returns compression of the data. It throws an exception if the image format does not support raw tiles.
+         */
+        Compression readRawTile(int zoomLevel, int tileIndex, std::vector<uint8_t>& data);
+        /**@brief returns rectangle (x,y,width,height) of a tile of a zoom level in the level coordinates.
+         * @param zoomLevel : index of the zoom level.
+         * @param tileX : column of the tile in the level tile grid.
+         * @param tileY : row of the tile in the level tile grid.
+         * Tiles of the last row and column are clipped by the level size.
+         */
+        std::tuple<int,int,int,int> getLevelTileRect(int zoomLevel, int tileX, int tileY) const;
+        /**@brief reads selected channels of a rectangle of a zoom level in native resolution of the level to a memory buffer.
+         *
+         * No zoom level selection and resizing is performed.
+         * @param zoomLevel : index of the zoom level.
+         * @param levelRect : rectangle of the block in the level coordinates represented by std::tuple(x,y,with,height).
+         * @param channelIndices : vector of indices of channels to be extracted. Empty vector for all channels.
+         * @param zSliceIndex : index of z-slice.
+         * @param tFrameIndex : index of time frame.
+         * @param buffer : pointer to an allocated memory buffer for the raster block. Size of the block can be computed with the method getBlockSize;
+         * @param bufferSize : size of the memory buffer in bytes.
+         * Memory layout of the buffer is described in the #readBlock method.
+         */
+        void readLevelBlockChannels(int zoomLevel, const std::tuple<int,int,int,int>& levelRect, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, void* buffer, size_t bufferSize);
+        /**@brief reads selected channels of a tile of a zoom level in native resolution of the level to a memory buffer.
+         *
+         * The tile rectangle is defined by #getLevelTileRect. Other parameters are the same as in #readLevelBlockChannels.
+         */
+        void readLevelTile(int zoomLevel, int tileX, int tileY, const std::vector<int>& channelIndices,
+            int zSliceIndex, int tFrameIndex, void* buffer, size_t bufferSize);
+        /**@brief reads a batch of rectangles of a plane image resized to the same size to a memory buffer.
+         *
+         * @param blockRects : rectangles of the blocks represented by std::tuple(x,y,with,height).
+         * @param blockSize : size of every block after resizing. The size is set as a @b std::tuple<width,height>;
+         * @param channelIndices : vector of indices of channels to be extracted. Empty vector for all channels.
+         * @param buffer : pointer to an allocated memory buffer for the blocks. Size of the buffer is the number of
+         * blocks multiplied by the block size computed with the method getBlockSize;
+         * @param bufferSize : size of the memory buffer in bytes.
+         *
+         * Blocks are placed one after another in the order of the rectangles.
+         * Memory layout of a block is described in the #readBlock method.
+         * Tiles shared by several blocks are decoded once.
+         */
+        void readBlocks(const std::vector<std::tuple<int,int,int,int>>& blockRects, const std::tuple<int,int>& blockSize,
+            const std::vector<int>& channelIndices, void* buffer, size_t bufferSize);
         std::string toString() const;
     private:
         std::shared_ptr<CVScene> m_scene;
@@ -3,6 +3,7 @@
 // of this distribution and at http://slideio.org/license.html.
 #include "slideio/slideio/slideio.hpp"
 #include "slideio/slideio/imagedrivermanager.hpp"
+#include "slideio/drivers/ndpi/ndpiindex.hpp"
 
 using namespace slideio;
 
@@ -18,3 +19,23 @@ std::vector<std::string> slideio::getDriverIDs()
 {
     return ImageDriverManager::getDriverIDs();
 }
+
+void slideio::setNDPIIndexEnabled(bool enable)
+{
+    NDPIIndex::setEnabled(enable);
+}
+
+bool slideio::isNDPIIndexEnabled()
+{
+    return NDPIIndex::isEnabled();
+}
+
+void slideio::setNDPIIndexDirectory(const std::string& directory)
+{
+    NDPIIndex::setCacheDirectory(directory);
+}
+
+std::string slideio::getNDPIIndexDirectory()
+{
+    return NDPIIndex::getCacheDirectory();
+}
@@ -91,4 +91,19 @@ namespace  slideio
     SLIDEIO_EXPORTS std::shared_ptr<Slide> openSlide(const std::string& path, const std::string& driver= "");
     /**@brief Returns a list of available driver ids. */
     SLIDEIO_EXPORTS std::vector<std::string> getDriverIDs();
+    /**@brief Enables or disables sidecar index files of NDPI slides.
+    @param enable : if true, directories scanned at opening of a NDPI slide are saved to an index file
+    and loaded from it when the slide is opened again.
+    Initial value is taken from the environment variable SLIDEIO_NDPI_INDEX (1, true, on, yes). Indexing is disabled by default.
+    */
+    SLIDEIO_EXPORTS void setNDPIIndexEnabled(bool enable);
+    /**@brief Returns true if sidecar index files of NDPI slides are enabled. */
+    SLIDEIO_EXPORTS bool isNDPIIndexEnabled();
+    /**@brief Sets directory for NDPI index files.
+    @param directory : directory for index files. Empty string puts index files next to the slides.
+    Initial value is taken from the environment variable SLIDEIO_NDPI_INDEX_DIR.
+    */
+    SLIDEIO_EXPORTS void setNDPIIndexDirectory(const std::string& directory);
+    /**@brief Returns directory of NDPI index files. Empty string means the slide directories. */
+    SLIDEIO_EXPORTS std::string getNDPIIndexDirectory();
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "transformation.hpp"
 #include "transformertools.hpp"
+#include "slideio/core/tools/tools.hpp"
 
 using namespace slideio;
 
@@ -112,14 +113,7 @@ void TransformerScene::readResampledBlockChannelsEx(const cv::Rect& blockRect, c
         block.copyTo(output);
     }
     else {
-        std::vector<cv::Mat> channels;
-        cv::split(block, channels);
-        std::vector<cv::Mat> selectedChannels;
-        selectedChannels.reserve(componentIndices.size());
-        for (const auto index : componentIndices) {
-            selectedChannels.push_back(channels[index]);
-        }
-        cv::merge(selectedChannels, output);
+        Tools::extractChannels(block, componentIndices, output);
     }
 }
 
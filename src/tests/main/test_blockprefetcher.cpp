@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+#include "slideio/core/tools/blockprefetcher.hpp"
+#include "slideio/core/cvscene.hpp"
+#include "slideio/drivers/svs/svsimagedriver.hpp"
+#include "tests/testlib/testtools.hpp"
+
+using namespace slideio;
+
+TEST(BlockPrefetcher, makeLevelScanOrder)
+{
+    slideio::SVSImageDriver driver;
+    const std::string path = TestTools::getTestImagePath("svs", "CMU-1-Small-Region.svs");
+    std::shared_ptr<CVSlide> slide = driver.openFile(path);
+    std::shared_ptr<CVScene> scene = slide->getScene(0);
+    const std::vector<BlockRequest> blocks = BlockPrefetcher::makeLevelScanOrder(*scene, 0, { 1000, 1000 });
+    // 2220x2967 level: 3 columns and 3 rows of blocks
+    ASSERT_EQ(blocks.size(), 9);
+    EXPECT_EQ(blocks[0].rect, cv::Rect(0, 0, 1000, 1000));
+    EXPECT_EQ(blocks[1].rect, cv::Rect(1000, 0, 1000, 1000));
+    EXPECT_EQ(blocks[2].rect, cv::Rect(2000, 0, 220, 1000));
+    EXPECT_EQ(blocks[8].rect, cv::Rect(2000, 2000, 220, 967));
+    for (const auto& block : blocks) {
+        EXPECT_EQ(block.zoomLevel, 0);
+    }
+}
+
+TEST(BlockPrefetcher, readLevelInScanOrder)
+{
+    slideio::SVSImageDriver driver;
+    const std::string path = TestTools::getTestImagePath("svs", "CMU-1-Small-Region.svs");
+    std::shared_ptr<CVSlide> slide = driver.openFile(path);
+    std::shared_ptr<CVScene> scene = slide->getScene(0);
+    const std::vector<BlockRequest> blocks = BlockPrefetcher::makeLevelScanOrder(*scene, 0, { 700, 500 });
+    std::vector<FileRange> ranges;
+    EXPECT_TRUE(scene->getBlockDataRanges(blocks.front(), ranges));
+    EXPECT_FALSE(ranges.empty());
+
+    BlockPrefetcher prefetcher(scene, blocks, 3, 2);
+    BlockRequest block;
+    cv::Mat raster;
+    size_t count = 0;
+    while (prefetcher.next(block, raster)) {
+        ASSERT_LT(count, blocks.size());
+        EXPECT_EQ(block.rect, blocks[count].rect);
+        cv::Mat expected;
+        scene->readLevelBlock(0, block.rect, expected);
+        ASSERT_EQ(raster.size(), expected.size());
+        EXPECT_EQ(cv::norm(raster, expected, cv::NORM_INF), 0);
+        ++count;
+    }
+    EXPECT_EQ(count, blocks.size());
+}
+
+TEST(BlockPrefetcher, stopBeforeEnd)
+{
+    slideio::SVSImageDriver driver;
+    const std::string path = TestTools::getTestImagePath("svs", "CMU-1-Small-Region.svs");
+    std::shared_ptr<CVSlide> slide = driver.openFile(path);
+    std::shared_ptr<CVScene> scene = slide->getScene(0);
+    BlockPrefetcher prefetcher(scene, BlockPrefetcher::makeLevelScanOrder(*scene, 0), 4, 2);
+    BlockRequest block;
+    cv::Mat raster;
+    ASSERT_TRUE(prefetcher.next(block, raster));
+    EXPECT_FALSE(raster.empty());
+    // the destructor stops the workers with blocks still in flight
+}
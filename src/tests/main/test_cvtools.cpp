@@ -3,6 +3,7 @@
 // of this distribution and at http://slideio.com/license.html.
 #include <gtest/gtest.h>
 #include "slideio/imagetools/cvtools.hpp"
+#include "slideio/base/exceptions.hpp"
 #include <opencv2/opencv.hpp>
 
 
@@ -76,3 +77,48 @@ TEST(CVTools, insertSliceInMultidimMatrix)
     EXPECT_TRUE(areEqual);
 
 }
+
+TEST(CVTools, extractChannels)
+{
+    const int numChannels = 12;
+    cv::Mat source(40, 50, CV_16UC(numChannels));
+    cv::randu(source, cv::Scalar::all(0), cv::Scalar::all(65535));
+    // not continuous region of the raster
+    const cv::Mat region = source(cv::Rect(5, 3, 31, 27));
+    for (const std::vector<int>& channelIndices : std::vector<std::vector<int>>{ {7}, {11, 0, 5}, {11, 3, 3, 0, 7} }) {
+        cv::Mat output;
+        CVTools::extractChannels(region, channelIndices, output);
+        ASSERT_EQ(region.size(), output.size());
+        ASSERT_EQ(CV_MAKETYPE(CV_16U, static_cast<int>(channelIndices.size())), output.type());
+        for (int index = 0; index < static_cast<int>(channelIndices.size()); ++index) {
+            cv::Mat expected, received;
+            cv::extractChannel(region, expected, channelIndices[index]);
+            cv::extractChannel(output, received, index);
+            EXPECT_EQ(cv::norm(expected, received, cv::NORM_INF), 0);
+        }
+    }
+    cv::Mat all;
+    CVTools::extractChannels(region, {}, all);
+    EXPECT_EQ(cv::norm(region, all, cv::NORM_INF), 0);
+    EXPECT_THROW(CVTools::extractChannels(region, { 0, numChannels }, all), slideio::RuntimeError);
+}
+
+TEST(CVTools, extractChannelsInPlace)
+{
+    cv::Mat raster(10, 20, CV_8UC3, cv::Scalar(1, 2, 3));
+    CVTools::extractChannels(raster, { 2, 1, 0 }, raster);
+    ASSERT_EQ(CV_8UC3, raster.type());
+    EXPECT_EQ(cv::Vec3b(3, 2, 1), raster.at<cv::Vec3b>(5, 7));
+}
+
+TEST(CVTools, extractChannelsInPlaceReduced)
+{
+    cv::Mat raster(10, 20, CV_8UC3, cv::Scalar(1, 2, 3));
+    raster.at<cv::Vec3b>(5, 7) = cv::Vec3b(4, 5, 6);
+    CVTools::extractChannels(raster, { 1 }, raster);
+    ASSERT_EQ(CV_8UC1, raster.type());
+    ASSERT_EQ(cv::Size(20, 10), raster.size());
+    EXPECT_EQ(2, raster.at<uint8_t>(0, 0));
+    EXPECT_EQ(5, raster.at<uint8_t>(5, 7));
+    EXPECT_EQ(2, raster.at<uint8_t>(9, 19));
+}
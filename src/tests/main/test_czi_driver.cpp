@@ -5,6 +5,7 @@
 #include "slideio/slideio/imagedrivermanager.hpp"
 #include "slideio/drivers/czi/cziimagedriver.hpp"
 #include "slideio/drivers/czi/czislide.hpp"
+#include "slideio/core/tools/tilecomposer.hpp"
 #include "tests/testlib/testtools.hpp"
 #include <opencv2/imgcodecs.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -123,6 +124,35 @@ TEST(CZIImageDriver, readBlock)
     }
 }
 
+TEST(CZIImageDriver, readBlockParallelSubBlocks)
+{
+    slideio::CZIImageDriver driver;
+    std::string filePath = TestTools::getTestImagePath("czi","pJP31mCherry.czi");
+    std::shared_ptr<slideio::CVSlide> slide = driver.openFile(filePath);
+    ASSERT_TRUE(slide!=nullptr);
+    auto scene = slide->getScene(0);
+    ASSERT_FALSE(scene == nullptr);
+    auto sceneRect = scene->getRect();
+    // every channel is stored in its own sub-block
+    const bool parallelReading = slideio::TileComposer::isParallelReadingEnabled();
+    slideio::TileComposer::setParallelReading(false);
+    cv::Mat sequentialRaster;
+    scene->readBlock(sceneRect, sequentialRaster);
+    slideio::TileComposer::setParallelReading(true);
+    cv::Mat parallelRaster;
+    scene->readBlock(sceneRect, parallelRaster);
+    slideio::TileComposer::setParallelReading(parallelReading);
+    ASSERT_EQ(parallelRaster.size(), sequentialRaster.size());
+    ASSERT_EQ(parallelRaster.type(), sequentialRaster.type());
+    EXPECT_EQ(parallelRaster.channels(), 3);
+    EXPECT_EQ(cv::norm(parallelRaster, sequentialRaster, cv::NORM_INF), 0.);
+    std::vector<cv::Mat> channelRasters;
+    cv::split(parallelRaster, channelRasters);
+    cv::Mat bmpImage = cv::imread(TestTools::getTestImagePath("czi",
+        "pJP31mCherry.grey/pJP31mCherry_b0t0z0c2x0-512y0-512.bmp"), cv::IMREAD_GRAYSCALE);
+    EXPECT_EQ(cv::norm(channelRasters[2], bmpImage, cv::NORM_INF), 0.);
+}
+
 TEST(CZIImageDriver, readBlockStrongDownscaleNotThrowing)
 {
     slideio::CZIImageDriver driver;
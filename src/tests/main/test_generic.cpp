@@ -30,3 +30,17 @@ TEST(GenericAPI, openSlide)
     std::vector<uint8_t> rasterData(memSize);
     scene->readBlock(blockRect, rasterData.data(), rasterData.size());
 }
+
+TEST(GenericAPI, ndpiIndexSettings)
+{
+    const bool enabled = slideio::isNDPIIndexEnabled();
+    const std::string directory = slideio::getNDPIIndexDirectory();
+    slideio::setNDPIIndexEnabled(!enabled);
+    EXPECT_EQ(!enabled, slideio::isNDPIIndexEnabled());
+    slideio::setNDPIIndexDirectory("/ndpi-index");
+    EXPECT_EQ(std::string("/ndpi-index"), slideio::getNDPIIndexDirectory());
+    slideio::setNDPIIndexEnabled(enabled);
+    slideio::setNDPIIndexDirectory(directory);
+    EXPECT_EQ(enabled, slideio::isNDPIIndexEnabled());
+    EXPECT_EQ(directory, slideio::getNDPIIndexDirectory());
+}
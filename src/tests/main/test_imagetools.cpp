@@ -6,8 +6,10 @@
 #include "slideio/drivers/gdal/gdalimagedriver.hpp"
 #include "tests/testlib/testtools.hpp"
 #include <fstream>
+#include <cstring>
 
 #include "slideio/core/tools/tempfile.hpp"
+#include "slideio/base/exceptions.hpp"
 
 TEST(ImageTools, readJp2KFile)
 {
@@ -30,6 +32,45 @@ TEST(ImageTools, readJp2KFile)
     ASSERT_LT(0.99, minScore);
 }
 
+TEST(ImageTools, decodeJp2KStreamReduced)
+{
+    std::string filePath = TestTools::getTestImagePath("jp2K", "relax.jp2");
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    ASSERT_TRUE(file.is_open());
+    std::vector<uint8_t> stream(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(stream.data()), stream.size());
+    file.close();
+    cv::Mat fullImage;
+    slideio::ImageTools::decodeJp2KStream(stream.data(), stream.size(), fullImage);
+    ASSERT_EQ(fullImage.size(), cv::Size(400, 300));
+    // one resolution level less
+    cv::Mat reducedImage;
+    slideio::ImageTools::decodeJp2KStream(stream.data(), stream.size(), reducedImage, {}, false, 1);
+    ASSERT_EQ(reducedImage.size(), cv::Size(200, 150));
+    cv::Mat resizedImage;
+    cv::resize(fullImage, resizedImage, reducedImage.size(), 0, 0, cv::INTER_AREA);
+    EXPECT_GE(slideio::ImageTools::computeSimilarity(resizedImage, reducedImage), 0.95);
+    // a window of the image
+    const cv::Rect region(100, 50, 200, 100);
+    cv::Mat regionImage;
+    slideio::ImageTools::decodeJp2KStream(stream.data(), stream.size(), regionImage, {}, false, 0, region);
+    ASSERT_EQ(regionImage.size(), region.size());
+    cv::Mat expectedRegion = fullImage(region).clone();
+    EXPECT_GE(slideio::ImageTools::computeSimilarity(expectedRegion, regionImage), 0.99);
+    // both, with a channel subset
+    cv::Mat reducedRegion;
+    slideio::ImageTools::decodeJp2KStream(stream.data(), stream.size(), reducedRegion, { 1 }, false, 1, region);
+    ASSERT_EQ(reducedRegion.size(), cv::Size(100, 50));
+    EXPECT_EQ(reducedRegion.channels(), 1);
+    // multithreaded decoder gives the same raster
+    slideio::ImageTools::setJp2KDecodingThreads(4);
+    cv::Mat threadedImage;
+    slideio::ImageTools::decodeJp2KStream(stream.data(), stream.size(), threadedImage);
+    slideio::ImageTools::setJp2KDecodingThreads(1);
+    EXPECT_EQ(cv::norm(threadedImage, fullImage, cv::NORM_INF), 0);
+}
+
 TEST(ImageTools, readJp2Header)
 {
     std::string filePath = TestTools::getTestImagePath("jp2K", "relax.jp2");
@@ -251,6 +292,117 @@ TEST(ImageTools, decodeJpegStream2)
     ASSERT_LT(0.999, minScore);
 }
 
+TEST(ImageTools, decodeJpegStreamScaled)
+{
+    std::string pathPng = TestTools::getTestImagePath("gdal", "img_2448x2448_3x8bit_SRC_RGB_ducks.png");
+    cv::Mat source;
+    slideio::ImageTools::readGDALImage(pathPng, source);
+    // odd size checks rounding of the reduced size
+    cv::Mat image(source, cv::Rect(0, 0, 1001, 803));
+    std::vector<uint8_t> stream;
+    slideio::ImageTools::encodeJpeg(image, stream, slideio::JpegEncodeParameters(99));
+    cv::Mat fullImage;
+    slideio::ImageTools::decodeJpegStream(stream.data(), stream.size(), fullImage);
+    ASSERT_EQ(fullImage.size(), image.size());
+    for (const int reduction : { 2, 4, 8 }) {
+        cv::Mat reducedImage;
+        slideio::ImageTools::decodeJpegStream(stream.data(), stream.size(), reducedImage, reduction);
+        const cv::Size expectedSize((image.cols + reduction - 1) / reduction, (image.rows + reduction - 1) / reduction);
+        ASSERT_EQ(reducedImage.size(), expectedSize);
+        ASSERT_EQ(reducedImage.type(), image.type());
+        cv::Mat resizedImage;
+        cv::resize(fullImage, resizedImage, expectedSize, 0, 0, cv::INTER_AREA);
+        double similarity = slideio::ImageTools::computeSimilarity(resizedImage, reducedImage);
+        EXPECT_GE(similarity, 0.95);
+    }
+    cv::Mat raster;
+    EXPECT_THROW(slideio::ImageTools::decodeJpegStream(stream.data(), stream.size(), raster, 3), slideio::RuntimeError);
+}
+
+TEST(ImageTools, decodeJpegRestartRegion)
+{
+    std::string pathPng = TestTools::getTestImagePath("gdal", "img_2448x2448_3x8bit_SRC_RGB_ducks.png");
+    cv::Mat source;
+    slideio::ImageTools::readGDALImage(pathPng, source);
+    cv::Mat image = source(cv::Rect(0, 0, 1001, 803)).clone();
+    const cv::Rect region(333, 211, 402, 317);
+    // 126 MCUs per row: intervals of 14 MCUs are tiles of a row, intervals of 252 MCUs span 2 rows
+    for (const int restartInterval : { 14, 252 }) {
+        slideio::JpegEncodeParameters params(95);
+        params.setRestartInterval(restartInterval);
+        std::vector<uint8_t> stream;
+        slideio::ImageTools::encodeJpeg(image, stream, params);
+        cv::Mat fullImage;
+        slideio::ImageTools::decodeJpegStream(stream.data(), stream.size(), fullImage);
+
+        slideio::ImageTools::JpegRestartLayout layout;
+        ASSERT_TRUE(slideio::ImageTools::parseJpegRestartStream(stream.data(), stream.size(), cv::Size(), layout));
+        EXPECT_EQ(layout.imageSize, image.size());
+        EXPECT_EQ(layout.channels, 3);
+        int reads = 0;
+        auto reader = [&stream, &reads](uint64_t offset, size_t size, uint8_t* buffer) {
+            ASSERT_LE(offset + size, stream.size());
+            std::memcpy(buffer, stream.data() + offset, size);
+            ++reads;
+        };
+        cv::Mat regionRaster;
+        slideio::ImageTools::decodeJpegRestartRegion(layout, reader, region, regionRaster);
+        ASSERT_EQ(regionRaster.size(), region.size());
+        // components are not subsampled: intervals are decoded exactly as the whole stream
+        EXPECT_EQ(cv::norm(regionRaster, fullImage(region), cv::NORM_INF), 0.);
+        // one read per row of intervals
+        const int intervalRows = (region.br().y - 1) / layout.intervalSize.height
+            - region.y / layout.intervalSize.height + 1;
+        EXPECT_EQ(reads, intervalRows);
+
+        cv::Mat imageRaster;
+        slideio::ImageTools::decodeJpegRestartRegion(layout, reader, cv::Rect(cv::Point(0, 0), image.size()), imageRaster);
+        EXPECT_EQ(cv::norm(imageRaster, fullImage, cv::NORM_INF), 0.);
+    }
+    std::vector<uint8_t> stream;
+    slideio::ImageTools::encodeJpeg(image, stream, slideio::JpegEncodeParameters(95));
+    slideio::ImageTools::JpegRestartLayout layout;
+    EXPECT_FALSE(slideio::ImageTools::parseJpegRestartStream(stream.data(), stream.size(), cv::Size(), layout));
+}
+
+TEST(ImageTools, scanJpegRestartMarkers)
+{
+    std::string pathPng = TestTools::getTestImagePath("gdal", "img_2448x2448_3x8bit_SRC_RGB_ducks.png");
+    cv::Mat source;
+    slideio::ImageTools::readGDALImage(pathPng, source);
+    cv::Mat image = source(cv::Rect(0, 0, 1001, 803)).clone();
+    slideio::JpegEncodeParameters params(95);
+    params.setRestartInterval(14);
+    std::vector<uint8_t> stream;
+    slideio::ImageTools::encodeJpeg(image, stream, params);
+    slideio::ImageTools::JpegRestartLayout expected;
+    ASSERT_TRUE(slideio::ImageTools::parseJpegRestartStream(stream.data(), stream.size(), cv::Size(), expected));
+
+    // the stream is stored in a file after some other data
+    const uint64_t streamOffset = 1000;
+    std::vector<uint8_t> file(streamOffset, 0xFF);
+    file.insert(file.end(), stream.begin(), stream.end());
+    auto reader = [&file](uint64_t offset, size_t size, uint8_t* buffer) {
+        ASSERT_LE(offset + size, file.size());
+        std::memcpy(buffer, file.data() + offset, size);
+    };
+    slideio::ImageTools::JpegRestartLayout layout;
+    ASSERT_TRUE(slideio::ImageTools::parseJpegRestartHeader(stream.data(), stream.size(), cv::Size(), layout));
+    ASSERT_TRUE(slideio::ImageTools::scanJpegRestartMarkers(reader, streamOffset + layout.header.size(),
+        file.size(), layout));
+    ASSERT_EQ(layout.intervals.size(), expected.intervals.size());
+    for (size_t index = 0; index < layout.intervals.size(); ++index) {
+        EXPECT_EQ(layout.intervals[index], expected.intervals[index] + streamOffset);
+    }
+    EXPECT_EQ(layout.dataEnd, expected.dataEnd + streamOffset);
+
+    cv::Mat fullImage, regionRaster;
+    slideio::ImageTools::decodeJpegStream(stream.data(), stream.size(), fullImage);
+    const cv::Rect region(500, 700, 300, 103);
+    slideio::ImageTools::decodeJpegRestartRegion(layout, reader, region, regionRaster);
+    EXPECT_EQ(cv::norm(regionRaster, fullImage(region), cv::NORM_INF), 0.);
+}
+
 TEST(ImageTools, computeSimilarityEqual)
 {
     cv::Mat left(100, 200, CV_16SC1, cv::Scalar((short)55));
@@ -407,3 +559,48 @@ TEST(ImageTools, computeSimilarity2Diff)
     double similarity = slideio::ImageTools::computeSimilarity2(left, right);
     EXPECT_DOUBLE_EQ(similarity, 0);
 }
+
+TEST(ImageTools, convertYCbCrToRGB)
+{
+    // 2x2 blocks of a constant color are not altered by chroma subsampling
+    const int width = 37;
+    const int height = 23;
+    cv::Mat rgb(height, width, CV_8UC3);
+    for (int row = 0; row < height; ++row) {
+        for (int column = 0; column < width; ++column) {
+            const int block = (row / 2) * 31 + (column / 2) * 17;
+            rgb.at<cv::Vec3b>(row, column) = cv::Vec3b(
+                static_cast<uint8_t>(block * 7), static_cast<uint8_t>(255 - block * 3), static_cast<uint8_t>(block * 11));
+        }
+    }
+    cv::Mat ycrcb;
+    cv::cvtColor(rgb, ycrcb, cv::COLOR_RGB2YCrCb);
+    for (int subsampling : { 1, 2 }) {
+        const int unitsPerRow = (width + subsampling - 1) / subsampling;
+        const int unitRows = (height + subsampling - 1) / subsampling;
+        const int unitSize = subsampling * subsampling + 2;
+        std::vector<uint8_t> data(static_cast<size_t>(unitsPerRow) * unitRows * unitSize, 0);
+        uint8_t* unit = data.data();
+        for (int unitRow = 0; unitRow < unitRows; ++unitRow) {
+            for (int unitColumn = 0; unitColumn < unitsPerRow; ++unitColumn, unit += unitSize) {
+                const int x = unitColumn * subsampling;
+                const int y = unitRow * subsampling;
+                for (int dy = 0; dy < subsampling; ++dy) {
+                    for (int dx = 0; dx < subsampling; ++dx) {
+                        const int row = std::min(y + dy, height - 1);
+                        const int column = std::min(x + dx, width - 1);
+                        unit[dy * subsampling + dx] = ycrcb.at<cv::Vec3b>(row, column)[0];
+                    }
+                }
+                const cv::Vec3b& pixel = ycrcb.at<cv::Vec3b>(y, x);
+                unit[unitSize - 2] = pixel[2];
+                unit[unitSize - 1] = pixel[1];
+            }
+        }
+        cv::Mat converted;
+        slideio::ImageTools::convertYCbCrToRGB(data.data(), width, height, subsampling, subsampling, converted);
+        ASSERT_EQ(CV_8UC3, converted.type());
+        ASSERT_EQ(rgb.size(), converted.size());
+        EXPECT_LE(cv::norm(rgb, converted, cv::NORM_INF), 2);
+    }
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "slideio/core/tools/positionalfile.hpp"
+#include "slideio/core/tools/tempfile.hpp"
+#include "slideio/base/exceptions.hpp"
+#include <fstream>
+#include <numeric>
+#include <thread>
+
+using namespace slideio;
+
+static void writeTestFile(const std::string& path, std::vector<uint8_t>& content)
+{
+    content.resize(100000);
+    for (size_t index = 0; index < content.size(); ++index) {
+        content[index] = static_cast<uint8_t>(index * 7 + index / 256);
+    }
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(content.data()), content.size());
+}
+
+TEST(PositionalFile, read)
+{
+    TempFile tempFile("bin");
+    const std::string path = tempFile.getPath().string();
+    std::vector<uint8_t> content;
+    writeTestFile(path, content);
+    PositionalFile file(path);
+    EXPECT_EQ(file.getSize(), content.size());
+    std::vector<uint8_t> buffer(1000);
+    file.read(5000, buffer.size(), buffer.data());
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 5000));
+    // reads do not depend on the previous position
+    file.read(0, 10, buffer.data());
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.begin() + 10, content.begin()));
+    // data beyond the end of the file
+    EXPECT_THROW(file.read(content.size() - 10, 20, buffer.data()), slideio::RuntimeError);
+}
+
+TEST(PositionalFile, concurrentReads)
+{
+    TempFile tempFile("bin");
+    const std::string path = tempFile.getPath().string();
+    std::vector<uint8_t> content;
+    writeTestFile(path, content);
+    const PositionalFile file(path);
+    const int numThreads = 4;
+    std::vector<int> mismatches(numThreads, 0);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < numThreads; ++thread) {
+        threads.emplace_back([&file, &content, &mismatches, thread]() {
+            std::vector<uint8_t> buffer(997);
+            for (int index = 0; index < 200; ++index) {
+                const uint64_t offset = (index * 1237 + thread * 331) % (content.size() - buffer.size());
+                file.read(offset, buffer.size(), buffer.data());
+                if (!std::equal(buffer.begin(), buffer.end(), content.begin() + offset)) {
+                    ++mismatches[thread];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(std::accumulate(mismatches.begin(), mismatches.end(), 0), 0);
+}
+
+TEST(PositionalFile, missingFile)
+{
+    TempFile tempFile("bin");
+    EXPECT_THROW(PositionalFile file(tempFile.getPath().string()), slideio::RuntimeError);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "slideio/core/tools/readcoalescer.hpp"
+#include <numeric>
+
+using namespace slideio;
+
+static FileRange makeRange(int64_t offset, int64_t size)
+{
+    FileRange range;
+    range.offset = offset;
+    range.size = size;
+    return range;
+}
+
+TEST(ReadCoalescer, coalesce)
+{
+    const std::vector<FileRange> ranges = {
+        makeRange(500, 10),
+        makeRange(100, 20),
+        makeRange(125, 10),
+        makeRange(130, 30),
+        makeRange(900, 50),
+        makeRange(0, 0)
+    };
+    std::vector<FileRange> reads;
+    ReadCoalescer::coalesce(ranges, 10, 1000, reads);
+    ASSERT_EQ(reads.size(), 3);
+    EXPECT_EQ(reads[0].offset, 100);
+    EXPECT_EQ(reads[0].size, 60);
+    EXPECT_EQ(reads[1].offset, 500);
+    EXPECT_EQ(reads[2].offset, 900);
+    // the read size limit splits adjacent ranges
+    ReadCoalescer::coalesce({ makeRange(0, 10), makeRange(10, 10), makeRange(20, 10) }, 0, 15, reads);
+    EXPECT_EQ(reads.size(), 3);
+    // overlapping ranges are merged regardless of the limit
+    ReadCoalescer::coalesce({ makeRange(0, 10), makeRange(5, 10) }, 0, 8, reads);
+    ASSERT_EQ(reads.size(), 1);
+    EXPECT_EQ(reads[0].size, 15);
+}
+
+TEST(ReadCoalescer, load)
+{
+    std::vector<uint8_t> file(1000);
+    std::iota(file.begin(), file.end(), 0);
+    const std::vector<FileRange> ranges = {
+        makeRange(300, 10),
+        makeRange(100, 20),
+        makeRange(120, 10),
+        makeRange(700, 200)
+    };
+    ReadCoalescer reads(16);
+    int readCount = 0;
+    reads.load(ranges, [&](int64_t offset, int64_t size, uint8_t* data) {
+        ++readCount;
+        std::copy(file.begin() + offset, file.begin() + offset + size, data);
+    });
+    EXPECT_EQ(readCount, 3);
+    EXPECT_EQ(reads.getReadCount(), 3);
+    for (const FileRange& range : ranges) {
+        const uint8_t* data = reads.find(range.offset, range.size);
+        ASSERT_NE(data, nullptr);
+        EXPECT_TRUE(std::equal(data, data + range.size, file.begin() + range.offset));
+    }
+    EXPECT_EQ(reads.find(50, 10), nullptr);
+    EXPECT_EQ(reads.find(125, 10), nullptr);
+    EXPECT_EQ(reads.find(950, 1), nullptr);
+}
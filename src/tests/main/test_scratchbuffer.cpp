@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "slideio/base/scratchbuffer.hpp"
+
+using namespace slideio;
+
+TEST(ScratchBuffer, reuse)
+{
+    // a new thread starts with an empty arena: buffers of other tests do not interfere
+    std::thread thread([]() {
+        uint8_t* data = nullptr;
+        {
+            ScratchBuffer buffer(1000);
+            ASSERT_EQ(1000, buffer.size());
+            data = buffer.data();
+            ASSERT_NE(nullptr, data);
+        }
+        {
+            ScratchBuffer buffer(500);
+            EXPECT_EQ(500, buffer.size());
+            EXPECT_EQ(data, buffer.data());
+            buffer.resize(800);
+            EXPECT_EQ(data, buffer.data());
+        }
+    });
+    thread.join();
+}
+
+TEST(ScratchBuffer, nested)
+{
+    ScratchBuffer outer(100);
+    ScratchBuffer inner(100);
+    EXPECT_NE(outer.data(), inner.data());
+    outer.data()[0] = 1;
+    inner.data()[0] = 2;
+    EXPECT_EQ(1, outer.data()[0]);
+}
+
+TEST(ScratchBuffer, growth)
+{
+    ScratchBuffer buffer(10);
+    buffer.resize(100000);
+    EXPECT_EQ(100000, buffer.size());
+    EXPECT_GE(buffer.capacity(), 100000);
+    buffer.data()[99999] = 1;
+}
+
+TEST(ScratchBuffer, arenaLimits)
+{
+    const size_t maxSize = ScratchBuffer::getMaxArenaBufferSize();
+    std::thread thread([]() {
+        ScratchBuffer::setMaxArenaBufferSize(1000);
+        {
+            ScratchBuffer big(2000);
+        }
+        EXPECT_EQ(0, ScratchBuffer::getArenaBufferCount());
+        {
+            ScratchBuffer small(100);
+        }
+        EXPECT_EQ(1, ScratchBuffer::getArenaBufferCount());
+    });
+    thread.join();
+    ScratchBuffer::setMaxArenaBufferSize(maxSize);
+}
+
+TEST(ScratchBuffer, arenaMemory)
+{
+    const size_t maxMemory = ScratchBuffer::getMaxArenaMemory();
+    std::thread thread([]() {
+        ScratchBuffer::setMaxArenaMemory(ScratchBuffer::getArenaMemory() + 1500);
+        {
+            ScratchBuffer first(1000);
+            ScratchBuffer second(1000);
+        }
+        EXPECT_EQ(1, ScratchBuffer::getArenaBufferCount());
+    });
+    thread.join();
+    ScratchBuffer::setMaxArenaMemory(maxMemory);
+}
+
+TEST(ScratchBuffer, perThread)
+{
+    uint8_t* mainData = nullptr;
+    {
+        ScratchBuffer buffer(100);
+        mainData = buffer.data();
+    }
+    std::thread thread([mainData]() {
+        EXPECT_EQ(0, ScratchBuffer::getArenaBufferCount());
+        ScratchBuffer buffer(100);
+        EXPECT_NE(mainData, buffer.data());
+    });
+    thread.join();
+}
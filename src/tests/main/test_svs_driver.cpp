@@ -548,3 +548,104 @@ TEST(SVSImageDriver, zoomLevels)
 
     }
 }
+
+TEST(SVSImageDriver, readRawTile)
+{
+    slideio::SVSImageDriver driver;
+    std::string path = TestTools::getTestImagePath("svs", "CMU-1-Small-Region.svs");
+    std::shared_ptr<slideio::CVSlide> slide = driver.openFile(path);
+    ASSERT_TRUE(slide != nullptr);
+    std::shared_ptr<slideio::CVScene> scene = slide->getScene(0);
+    ASSERT_TRUE(scene != nullptr);
+    const slideio::LevelInfo* level = scene->getZoomLevelInfo(0);
+    const cv::Size tileSize = level->getTileSize();
+    const int tilesX = (level->getSize().width - 1) / tileSize.width + 1;
+    const int tileX = 2, tileY = 3;
+    std::vector<uint8_t> data;
+    const slideio::Compression compression = scene->readRawTile(0, tileY * tilesX + tileX, data);
+    ASSERT_EQ(compression, slideio::Compression::Jpeg);
+    ASSERT_FALSE(data.empty());
+    cv::Mat tileRaster;
+    slideio::ImageTools::decodeJpegStream(data.data(), data.size(), tileRaster);
+    ASSERT_EQ(tileRaster.size(), tileSize);
+    const cv::Rect tileRect(tileX * tileSize.width, tileY * tileSize.height, tileSize.width, tileSize.height);
+    cv::Mat blockRaster;
+    scene->readBlock(tileRect, blockRaster);
+    cv::Mat score;
+    cv::matchTemplate(tileRaster, blockRaster, score, cv::TM_CCOEFF_NORMED);
+    double minScore(0), maxScore(0);
+    cv::minMaxLoc(score, &minScore, &maxScore);
+    EXPECT_LT(0.99, minScore);
+    EXPECT_THROW(scene->readRawTile(0, -1, data), slideio::RuntimeError);
+}
+
+TEST(SVSImageDriver, readLevelTile)
+{
+    slideio::SVSImageDriver driver;
+    std::string path = TestTools::getTestImagePath("svs", "CMU-1-Small-Region.svs");
+    std::shared_ptr<slideio::CVSlide> slide = driver.openFile(path);
+    ASSERT_TRUE(slide != nullptr);
+    std::shared_ptr<slideio::CVScene> scene = slide->getScene(0);
+    ASSERT_TRUE(scene != nullptr);
+    const slideio::LevelInfo* level = scene->getZoomLevelInfo(0);
+    const cv::Size levelSize = level->getSize();
+    const cv::Size tileSize = level->getTileSize();
+    const int tilesX = (levelSize.width - 1) / tileSize.width + 1;
+    const int tilesY = (levelSize.height - 1) / tileSize.height + 1;
+    // edge tiles are clipped by the level size
+    const cv::Rect lastTileRect = scene->getLevelTileRect(0, tilesX - 1, tilesY - 1);
+    EXPECT_EQ(lastTileRect.br(), cv::Point(levelSize.width, levelSize.height));
+    EXPECT_THROW(scene->getLevelTileRect(0, tilesX, 0), slideio::RuntimeError);
+
+    const cv::Rect tileRect = scene->getLevelTileRect(0, 2, 3);
+    EXPECT_EQ(tileRect, cv::Rect(2 * tileSize.width, 3 * tileSize.height, tileSize.width, tileSize.height));
+    cv::Mat tileRaster;
+    scene->readLevelTile(0, 2, 3, {}, 0, 0, tileRaster);
+    cv::Mat blockRaster;
+    scene->readBlock(tileRect, blockRaster);
+    TestTools::compareRasters(tileRaster, blockRaster);
+
+    cv::Mat channelRaster;
+    scene->readLevelTile(0, 2, 3, { 1 }, 0, 0, channelRaster);
+    ASSERT_EQ(channelRaster.channels(), 1);
+    cv::Mat expectedChannel;
+    cv::extractChannel(tileRaster, expectedChannel, 1);
+    TestTools::compareRasters(channelRaster, expectedChannel);
+
+    const cv::Rect outsideRect(levelSize.width - 10, 0, 20, 20);
+    EXPECT_THROW(scene->readLevelBlock(0, outsideRect, blockRaster), slideio::RuntimeError);
+}
+
+TEST(SVSImageDriver, readBlocks)
+{
+    slideio::SVSImageDriver driver;
+    std::string path = TestTools::getTestImagePath("svs","CMU-1-Small-Region.svs");
+    std::shared_ptr<slideio::CVSlide> slide = driver.openFile(path);
+    ASSERT_TRUE(slide != nullptr);
+    std::shared_ptr<slideio::CVScene> scene = slide->getScene(0);
+    ASSERT_TRUE(scene != nullptr);
+    const std::vector<cv::Rect> blockRects = {
+        { 100, 100, 256, 256 },
+        { 200, 150, 256, 256 },
+        { 1800, 2500, 256, 256 },
+        { 0, 0, 1024, 1024 }
+    };
+    const cv::Size blockSize(128, 128);
+    cv::Mat batch;
+    scene->readBlocks(blockRects, blockSize, { 2, 1 }, batch);
+    ASSERT_EQ(batch.dims, 3);
+    EXPECT_EQ(batch.size[0], 4);
+    EXPECT_EQ(batch.size[1], blockSize.height);
+    EXPECT_EQ(batch.size[2], blockSize.width);
+    EXPECT_EQ(batch.channels(), 2);
+    EXPECT_TRUE(batch.isContinuous());
+    for (int block = 0; block < static_cast<int>(blockRects.size()); ++block) {
+        cv::Mat expected;
+        scene->readResampledBlockChannels(blockRects[block], blockSize, { 2, 1 }, expected);
+        cv::Mat plane(blockSize, batch.type(), batch.ptr(block));
+        TestTools::compareRasters(plane, expected);
+    }
+    const cv::Rect sceneRect = scene->getRect();
+    const std::vector<cv::Rect> outsideRects = { { 100, 100, 256, 256 }, { sceneRect.width - 10, 0, 20, 20 } };
+    EXPECT_THROW(scene->readBlocks(outsideRects, blockSize, {}, batch), slideio::RuntimeError);
+}
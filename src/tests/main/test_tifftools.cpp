@@ -6,6 +6,12 @@
 #include "slideio/imagetools/imagetools.hpp"
 #include "opencv2/imgproc.hpp"
 #include "slideio/imagetools/tiffkeeper.hpp"
+#include "slideio/imagetools/tiffhandlepool.hpp"
+#include "slideio/imagetools/tiffifdparser.hpp"
+#include "slideio/imagetools/libtiff.hpp"
+#include "slideio/core/tools/tempfile.hpp"
+#include "slideio/base/exceptions.hpp"
+#include <fstream>
 
 
 TEST(TiffTools, scanTiffFile)
@@ -63,6 +69,34 @@ TEST(TiffTools, readStripedDir)
 
 }
 
+TEST(TiffTools, readStripedDirRegion)
+{
+    std::string filePathTiff = TestTools::getTestImagePath("svs","CMU-1-Small-Region.svs");
+    libtiff::TIFF* tiff = slideio::TiffTools::openTiffFile(filePathTiff);;
+    ASSERT_TRUE(tiff!=nullptr);
+    slideio::TiffDirectory dir;
+    slideio::TiffTools::scanTiffDirTags(tiff, 2, 0, dir);
+    dir.dataType = slideio::DataType::DT_Byte;
+    cv::Mat dirRaster;
+    slideio::TiffTools::readStripedDir(tiff, dir, dirRaster);
+    const cv::Rect region(dir.width / 4, dir.height / 3, dir.width / 2, dir.height / 2);
+    cv::Mat regionRaster;
+    slideio::TiffTools::readStripedDirRegion(tiff, dir, region, 1, regionRaster);
+    EXPECT_EQ(region.size(), regionRaster.size());
+    EXPECT_EQ(cv::norm(dirRaster(region), regionRaster, cv::NORM_INF), 0);
+    const int rowStep = 5;
+    cv::Mat decimatedRaster;
+    slideio::TiffTools::readStripedDirRegion(tiff, dir, region, rowStep, decimatedRaster);
+    slideio::TiffTools::closeTiffFile(tiff);
+    ASSERT_EQ((region.height + rowStep - 1) / rowStep, decimatedRaster.rows);
+    ASSERT_EQ(region.width, decimatedRaster.cols);
+    for (int row = 0; row < decimatedRaster.rows; ++row) {
+        const int dirRow = region.y + std::min(row * rowStep + rowStep / 2, region.height - 1);
+        const cv::Mat expectedRow = dirRaster(cv::Rect(region.x, dirRow, region.width, 1));
+        ASSERT_EQ(cv::norm(expectedRow, decimatedRaster.row(row), cv::NORM_INF), 0);
+    }
+}
+
 TEST(TiffTools, readTile_jpeg)
 {
     const std::string filePath = 
@@ -205,3 +239,189 @@ TEST(TiffTools, openFileUtf8)
     ASSERT_EQ(dirCount, 1);
 }
 
+
+TEST(TiffTools, handlePool)
+{
+    const std::string filePath = TestTools::getTestImagePath("svs","CMU-1-Small-Region.svs");
+    std::vector<slideio::TiffDirectory> dirs;
+    slideio::TiffTools::scanFile(filePath, dirs);
+    ASSERT_LE(3, (int)dirs.size());
+    slideio::TIFFHandlePool pool(filePath);
+    libtiff::TIFF* firstHandle = nullptr;
+    {
+        auto handle0 = pool.acquire(dirs[0]);
+        auto handle2 = pool.acquire(dirs[2]);
+        ASSERT_TRUE(handle0);
+        ASSERT_TRUE(handle2);
+        EXPECT_NE(handle0->getHandle(), handle2->getHandle());
+        EXPECT_EQ(0, (int)libtiff::TIFFCurrentDirectory(handle0->getHandle()));
+        EXPECT_EQ(2, (int)libtiff::TIFFCurrentDirectory(handle2->getHandle()));
+        firstHandle = handle0->getHandle();
+    }
+    // released handle is reused for the same directory
+    auto handle = pool.acquire(dirs[0]);
+    EXPECT_EQ(firstHandle, handle->getHandle());
+    dirs[0].dataType = slideio::DataType::DT_Byte;
+    cv::Mat pooledTile, tile;
+    slideio::TiffTools::readTile(handle->getHandle(), dirs[0], 5, {}, pooledTile);
+    slideio::TIFFKeeper tiff(slideio::TiffTools::openTiffFile(filePath));
+    slideio::TiffTools::readTile(tiff, dirs[0], 5, {}, tile);
+    ASSERT_EQ(pooledTile.size(), tile.size());
+    EXPECT_EQ(0, std::memcmp(pooledTile.data, tile.data, tile.total() * tile.elemSize()));
+}
+
+TEST(TiffTools, setCurrentDirectoryAfterSubDirectory)
+{
+    const std::string filePath = TestTools::getTestImagePath("svs","CMU-1-Small-Region.svs");
+    std::vector<slideio::TiffDirectory> dirs;
+    slideio::TiffTools::scanFile(filePath, dirs);
+    ASSERT_LE(2, (int)dirs.size());
+    ASSERT_NE(dirs[0].width, dirs[1].width);
+    slideio::TIFFKeeper tiff(slideio::TiffTools::openTiffFile(filePath));
+    libtiff::TIFF* hFile = tiff.getHandle();
+    ASSERT_TRUE(libtiff::TIFFSetDirectory(hFile, 1));
+    // the IFD of the second directory loaded as a sub-directory of the first one
+    slideio::TiffDirectory subDir;
+    subDir.dirIndex = 0;
+    subDir.offset = static_cast<int64_t>(libtiff::TIFFCurrentDirOffset(hFile));
+    slideio::TiffDirectory mainDir;
+    mainDir.dirIndex = 0;
+    mainDir.offset = 0;
+    uint32_t width = 0;
+    slideio::TiffTools::setCurrentDirectory(hFile, mainDir);
+    ASSERT_TRUE(libtiff::TIFFGetField(hFile, TIFFTAG_IMAGEWIDTH, &width));
+    EXPECT_EQ(dirs[0].width, (int)width);
+    slideio::TiffTools::setCurrentDirectory(hFile, subDir);
+    ASSERT_TRUE(libtiff::TIFFGetField(hFile, TIFFTAG_IMAGEWIDTH, &width));
+    EXPECT_EQ(dirs[1].width, (int)width);
+    // the main directory with the same index must be re-loaded
+    slideio::TiffTools::setCurrentDirectory(hFile, mainDir);
+    ASSERT_TRUE(libtiff::TIFFGetField(hFile, TIFFTAG_IMAGEWIDTH, &width));
+    EXPECT_EQ(dirs[0].width, (int)width);
+}
+
+static void compareDirectories(const slideio::TiffDirectory& fast, const slideio::TiffDirectory& reference)
+{
+    EXPECT_EQ(fast.dirIndex, reference.dirIndex);
+    EXPECT_EQ(fast.width, reference.width);
+    EXPECT_EQ(fast.height, reference.height);
+    EXPECT_EQ(fast.tiled, reference.tiled);
+    EXPECT_EQ(fast.tileWidth, reference.tileWidth);
+    EXPECT_EQ(fast.tileHeight, reference.tileHeight);
+    EXPECT_EQ(fast.channels, reference.channels);
+    EXPECT_EQ(fast.bitsPerSample, reference.bitsPerSample);
+    EXPECT_EQ(fast.photometric, reference.photometric);
+    EXPECT_EQ(fast.YCbCrSubsampling[0], reference.YCbCrSubsampling[0]);
+    EXPECT_EQ(fast.YCbCrSubsampling[1], reference.YCbCrSubsampling[1]);
+    EXPECT_EQ(fast.compression, reference.compression);
+    EXPECT_EQ(fast.slideioCompression, reference.slideioCompression);
+    EXPECT_EQ(fast.description, reference.description);
+    EXPECT_DOUBLE_EQ(fast.res.x, reference.res.x);
+    EXPECT_DOUBLE_EQ(fast.res.y, reference.res.y);
+    EXPECT_DOUBLE_EQ(fast.position.x, reference.position.x);
+    EXPECT_DOUBLE_EQ(fast.position.y, reference.position.y);
+    EXPECT_EQ(fast.interleaved, reference.interleaved);
+    EXPECT_EQ(fast.dataType, reference.dataType);
+    EXPECT_EQ(fast.compressionQuality, reference.compressionQuality);
+    if (!fast.tiled) {
+        EXPECT_EQ(fast.rowsPerStrip, reference.rowsPerStrip);
+        EXPECT_EQ(fast.stripSize, reference.stripSize);
+    }
+}
+
+static void compareFastScan(const std::string& filePath)
+{
+    slideio::TiffIFDParser parser(filePath);
+    std::vector<slideio::TiffDirectory> fastDirs;
+    slideio::TiffTools::scanFile(parser, fastDirs);
+    slideio::TIFFKeeper tiff(slideio::TiffTools::openTiffFile(filePath));
+    std::vector<slideio::TiffDirectory> dirs;
+    slideio::TiffTools::scanFile(tiff, dirs);
+    ASSERT_EQ(fastDirs.size(), dirs.size()) << filePath;
+    for (size_t index = 0; index < dirs.size(); ++index) {
+        SCOPED_TRACE(filePath + ", directory " + std::to_string(index));
+        compareDirectories(fastDirs[index], dirs[index]);
+    }
+}
+
+TEST(TiffTools, fastScanMatchesLibtiff)
+{
+    const std::vector<std::pair<std::string, std::string>> images = {
+        {"svs", "JP2K-33003-1.svs"},
+        {"svs", "CMU-1-Small-Region.svs"},
+        {"scn", "Leica-Fluorescence-1.scn"},
+    };
+    for (const auto& image : images) {
+        compareFastScan(TestTools::getTestImagePath(image.first, image.second));
+    }
+    if (TestTools::isFullTestEnabled()) {
+        compareFastScan(TestTools::getFullTestImagePath("pke", "openmicroscopy/PKI_scans/HandEcompressed_Scan1.qptiff"));
+        compareFastScan(TestTools::getFullTestImagePath("pke", "openmicroscopy/PKI_scans/LuCa-7color_Scan1.qptiff"));
+    }
+}
+
+TEST(TiffTools, lazyDescription)
+{
+    std::string filePath = TestTools::getTestImagePath("svs", "JP2K-33003-1.svs");
+    slideio::TiffIFDParser parser(filePath);
+    std::vector<slideio::TiffDirectory> dirs;
+    slideio::TiffTools::scanFile(parser, dirs);
+    ASSERT_EQ(dirs.size(), 6);
+    EXPECT_FALSE(dirs[0].description.isLoaded());
+    const slideio::TiffString description = dirs[0].description;
+    EXPECT_EQ(description.size(), 530);
+    EXPECT_TRUE(dirs[0].description.isLoaded());
+    // short descriptions are read by the scan
+    EXPECT_TRUE(dirs[5].description.isLoaded());
+    EXPECT_EQ(dirs[5].description.size(), 44);
+}
+
+// classic tiff with one ndpi directory: an ascii value at offset 64 with the given high word of the offset
+static void writeNDPIFile(const std::string& filePath, const std::string& text, uint32_t highWord)
+{
+    auto put = [](std::vector<uint8_t>& data, uint64_t value, int size) {
+        for (int index = 0; index < size; ++index) {
+            data.push_back(static_cast<uint8_t>(value >> (8 * index)));
+        }
+    };
+    const uint32_t valueOffset = 64;
+    std::vector<uint8_t> data = {'I', 'I'};
+    put(data, 42, 2);
+    put(data, 8, 4);
+    put(data, 1, 2);
+    put(data, 270, 2);
+    put(data, 2, 2);
+    put(data, text.size() + 1, 4);
+    put(data, valueOffset, 4);
+    // 64-bit offset of the next directory and the high words of the entry offsets
+    put(data, 0, 8);
+    put(data, highWord, 4);
+    data.resize(valueOffset, 0);
+    data.insert(data.end(), text.begin(), text.end());
+    data.push_back(0);
+    std::ofstream stream(filePath, std::ios::binary);
+    stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+TEST(TiffIFDParser, ndpiHighWords)
+{
+    const std::string text(300, 'a');
+    slideio::TempFile file("ndpi");
+    const std::string filePath = file.getPath().string();
+    writeNDPIFile(filePath, text, 0);
+    {
+        slideio::TiffIFDParser parser(filePath, true);
+        ASSERT_EQ(parser.getNumberOfDirectories(), 1);
+        std::string description;
+        ASSERT_TRUE(parser.getString(parser.getDirectory(0), 270, description));
+        EXPECT_EQ(description, text);
+        slideio::TiffString lazyDescription;
+        ASSERT_TRUE(parser.getLazyString(parser.getDirectory(0), 270, lazyDescription));
+        EXPECT_FALSE(lazyDescription.isLoaded());
+        EXPECT_EQ(lazyDescription.str(), text);
+    }
+    // the high word moves the value beyond the end of the file: the parser must fail and
+    // let the caller fall back to libtiff
+    writeNDPIFile(filePath, text, 1);
+    EXPECT_THROW(slideio::TiffIFDParser(filePath, true), slideio::RuntimeError);
+}
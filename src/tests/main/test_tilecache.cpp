@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+
+#include "slideio/core/tools/tilecache.hpp"
+#include "slideio/core/tools/tilecomposer.hpp"
+#include "tests/testlib/testtiler.hpp"
+
+using namespace slideio;
+
+class CountingTiler : public TestTiler
+{
+public:
+    CountingTiler(int tileWidth, int tileHeight, int tilesX, int tilesY) :
+        TestTiler(tileWidth, tileHeight, tilesX, tilesY, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255)) {}
+    bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
+        void* userData) override {
+        m_reads++;
+        return TestTiler::readTile(tileIndex, channelIndices, tileRaster, userData);
+    }
+    bool getTileCacheKey(void* userData, TileCacheKey& key) override {
+        key.filePath = "counting-tiler";
+        return true;
+    }
+    int m_reads = 0;
+};
+
+class TileCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override {
+        TileCache::instance().clear();
+        TileCache::instance().resetStatistics();
+    }
+    void TearDown() override {
+        TileCache::instance().setMaxSize(0);
+        TileCache::instance().clear();
+        TileCache::instance().resetStatistics();
+    }
+};
+
+TEST_F(TileCacheTest, lruEviction)
+{
+    TileCache& cache = TileCache::instance();
+    const cv::Mat tile(10, 10, CV_8UC1, cv::Scalar(7));
+    cache.setMaxSize(3 * tile.total());
+    TileCacheKey key;
+    key.filePath = "file";
+    for (int tileIndex = 0; tileIndex < 3; ++tileIndex) {
+        key.tileIndex = tileIndex;
+        cache.put(key, tile);
+    }
+    EXPECT_EQ(cache.getTileCount(), 3);
+    EXPECT_EQ(cache.getSize(), 3 * tile.total());
+    // touch tile 0: tile 1 becomes the least recently used one
+    cv::Mat cached;
+    key.tileIndex = 0;
+    EXPECT_TRUE(cache.get(key, cached));
+    key.tileIndex = 3;
+    cache.put(key, tile);
+    EXPECT_EQ(cache.getTileCount(), 3);
+    key.tileIndex = 1;
+    EXPECT_FALSE(cache.get(key, cached));
+    key.tileIndex = 0;
+    EXPECT_TRUE(cache.get(key, cached));
+    EXPECT_EQ(cv::countNonZero(cached != tile), 0);
+    EXPECT_EQ(cache.getHits(), 2);
+    EXPECT_EQ(cache.getMisses(), 1);
+    // different channel set is a different tile
+    key.channelIndices = { 1 };
+    EXPECT_FALSE(cache.get(key, cached));
+    cache.setMaxSize(tile.total());
+    EXPECT_EQ(cache.getTileCount(), 1);
+    cache.setMaxSize(0);
+    EXPECT_EQ(cache.getTileCount(), 0);
+    EXPECT_FALSE(cache.isEnabled());
+}
+
+TEST_F(TileCacheTest, composeRect)
+{
+    const int tileWidth(100), tileHeight(80), tilesX(5), tilesY(4);
+    CountingTiler tiler(tileWidth, tileHeight, tilesX, tilesY);
+    const cv::Rect blockRect(0, 0, tileWidth * tilesX, tileHeight * tilesY);
+    const cv::Size blockSize(blockRect.width / 2, blockRect.height / 2);
+    const std::vector<int> channelIndices;
+    cv::Mat uncached, first, second;
+    TileComposer::composeRect(&tiler, channelIndices, blockRect, blockSize, uncached);
+    EXPECT_EQ(tiler.m_reads, tilesX * tilesY);
+
+    TileCache::instance().setMaxSize(64 * 1024 * 1024);
+    tiler.m_reads = 0;
+    TileComposer::composeRect(&tiler, channelIndices, blockRect, blockSize, first);
+    EXPECT_EQ(tiler.m_reads, tilesX * tilesY);
+    TileComposer::composeRect(&tiler, channelIndices, blockRect, blockSize, second);
+    EXPECT_EQ(tiler.m_reads, tilesX * tilesY);
+    EXPECT_EQ(TileCache::instance().getHits(), tilesX * tilesY);
+    EXPECT_EQ(cv::norm(uncached, first, cv::NORM_INF), 0);
+    EXPECT_EQ(cv::norm(first, second, cv::NORM_INF), 0);
+}
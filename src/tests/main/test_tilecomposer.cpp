@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 #include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
 
 #include "tests/testlib/testtiler.hpp"
+#include "slideio/core/tools/tileindex.hpp"
+#include <atomic>
+#include <set>
 
 TEST(TileComposer, composeRect)
 {
@@ -34,4 +38,272 @@ TEST(TileComposer, composeRect)
     EXPECT_TRUE(whiteStddev==cv::Scalar(0, 0, 0));
     EXPECT_TRUE(blackStddev==cv::Scalar(0, 0, 0));
     
-}
\ No newline at end of file
+}
+
+TEST(TileComposer, composeRectParallel)
+{
+    const int tileWidth(64), tileHeight(48), tilesX(17), tilesY(13);
+    cv::Scalar white(255, 255, 255), black(0, 0, 0);
+    TestTiler sequentialTiler(tileWidth, tileHeight, tilesX, tilesY, black, white);
+    TestTiler parallelTiler(tileWidth, tileHeight, tilesX, tilesY, black, white);
+    parallelTiler.m_concurrentReads = true;
+    const std::vector<int> channelIndices = { 2, 0 };
+    const cv::Rect blockRect(37, 21, tilesX * tileWidth - 80, tilesY * tileHeight - 50);
+    for (const cv::Size& blockSize : { blockRect.size(), cv::Size(blockRect.width / 3, blockRect.height / 3) }) {
+        cv::Mat sequential, parallel;
+        slideio::TileComposer::composeRect(&sequentialTiler, channelIndices, blockRect, blockSize, sequential);
+        slideio::TileComposer::composeRect(&parallelTiler, channelIndices, blockRect, blockSize, parallel);
+        ASSERT_EQ(sequential.size(), parallel.size());
+        ASSERT_EQ(sequential.type(), parallel.type());
+        EXPECT_EQ(cv::norm(sequential, parallel, cv::NORM_INF), 0);
+    }
+}
+
+TEST(TileComposer, composeRectIdentityScale)
+{
+    // tiles spanning the block width are decoded directly into the block
+    const int tileWidth(64), tileHeight(48), tilesX(1), tilesY(9);
+    cv::Scalar white(255, 255, 255), black(0, 0, 0);
+    for (const bool concurrentReads : { false, true }) {
+        TestTiler tiler(tileWidth, tileHeight, tilesX, tilesY, black, white);
+        tiler.m_concurrentReads = concurrentReads;
+        const std::vector<int> channelIndices;
+        const cv::Rect blockRect(0, 0, tileWidth, tilesY * tileHeight);
+        cv::Mat block;
+        slideio::TileComposer::composeRect(&tiler, channelIndices, blockRect, blockRect.size(), block);
+        ASSERT_EQ(block.size(), blockRect.size());
+        for (int tileY = 0; tileY < tilesY; ++tileY) {
+            cv::Mat tile(block, cv::Rect(0, tileY * tileHeight, tileWidth, tileHeight));
+            cv::Scalar mean, stddev;
+            cv::meanStdDev(tile, mean, stddev);
+            EXPECT_EQ(mean, (tileY % 2) ? black : white);
+            EXPECT_EQ(stddev, cv::Scalar(0, 0, 0));
+        }
+        // partially covered tiles are composed through a tile raster
+        const cv::Rect partRect(0, tileHeight / 2, tileWidth, tileHeight * 2);
+        cv::Mat part;
+        slideio::TileComposer::composeRect(&tiler, channelIndices, partRect, partRect.size(), part);
+        cv::Mat expected(block, partRect);
+        EXPECT_EQ(cv::norm(part, expected, cv::NORM_INF), 0);
+    }
+}
+
+TEST(TileComposer, composeRectStridedOutput)
+{
+    const int tileWidth(64), tileHeight(48), tilesX(7), tilesY(5);
+    cv::Scalar white(255, 255, 255), black(0, 0, 0);
+    TestTiler copyTiler(tileWidth, tileHeight, tilesX, tilesY, black, white);
+    const std::vector<int> channelIndices = { 1, 2 };
+    const cv::Rect blockRect(tileWidth / 2, tileHeight / 3, tileWidth * 5, tileHeight * 4);
+    cv::Mat expected;
+    slideio::TileComposer::composeRect(&copyTiler, channelIndices, blockRect, blockRect.size(), expected);
+    for (const bool concurrentReads : { false, true }) {
+        TestTiler tiler(tileWidth, tileHeight, tilesX, tilesY, black, white);
+        tiler.m_stridedOutput = true;
+        tiler.m_concurrentReads = concurrentReads;
+        cv::Mat block;
+        slideio::TileComposer::composeRect(&tiler, channelIndices, blockRect, blockRect.size(), block);
+        ASSERT_EQ(block.size(), expected.size());
+        ASSERT_EQ(block.type(), expected.type());
+        EXPECT_EQ(cv::norm(block, expected, cv::NORM_INF), 0);
+    }
+}
+
+TEST(TileComposer, getGridTilesInRect)
+{
+    const int tileWidth(100), tileHeight(200), tilesX(6), tilesY(3);
+    cv::Scalar white(255, 255, 255), black(0, 0, 0);
+    TestTiler testTiler(tileWidth, tileHeight, tilesX, tilesY, black, white);
+    const cv::Size imageSize(tilesX * tileWidth - 30, tilesY * tileHeight - 50);
+    const std::vector<cv::Rect> rects = {
+        { 0, 0, imageSize.width, imageSize.height },
+        { 50, 100, 1, 1 },
+        { 99, 199, 2, 2 },
+        { 150, 250, 220, 300 },
+        { -20, -20, 40, 40 },
+        { 1000, 1000, 10, 10 }
+    };
+    for (const auto& rect : rects) {
+        std::vector<int> linear, grid;
+        testTiler.getTilesInRect(rect, linear, nullptr);
+        slideio::TileComposer::getGridTilesInRect(rect, imageSize, { tileWidth, tileHeight }, grid);
+        EXPECT_EQ(linear, grid);
+    }
+    std::vector<int> tiles;
+    slideio::TileComposer::getGridTilesInRect({ 150, 250, 100, 100 }, imageSize, { tileWidth, tileHeight }, tiles);
+    EXPECT_EQ(tiles, std::vector<int>({ 7, 8 }));
+}
+
+TEST(TileComposer, tileIndex)
+{
+    // irregular mosaic: overlapping tiles of different sizes
+    std::vector<cv::Rect> tileRects;
+    for (int row = 0; row < 10; ++row) {
+        for (int col = 0; col < 12; ++col) {
+            tileRects.emplace_back(col * 90 - 15, row * 70 + (col % 3) * 5, 100 + (row % 2) * 40, 80);
+        }
+    }
+    slideio::TileIndex index;
+    for (int tileIndex = 0; tileIndex < static_cast<int>(tileRects.size()); ++tileIndex) {
+        index.addTile(tileIndex, tileRects[tileIndex]);
+    }
+    const std::vector<cv::Rect> rects = {
+        { 0, 0, 1, 1 },
+        { -15, 0, 30, 30 },
+        { 300, 200, 250, 170 },
+        { 0, 0, 2000, 2000 },
+        { 5000, 5000, 10, 10 }
+    };
+    for (const auto& rect : rects) {
+        std::vector<int> expected;
+        for (int tileIndex = 0; tileIndex < static_cast<int>(tileRects.size()); ++tileIndex) {
+            if ((tileRects[tileIndex] & rect).area() > 0) {
+                expected.push_back(tileIndex);
+            }
+        }
+        std::vector<int> found;
+        index.findTiles(rect, found);
+        EXPECT_EQ(expected, found);
+    }
+}
+
+class CountingTestTiler : public TestTiler
+{
+public:
+    CountingTestTiler(int tileWidth, int tileHeight, int tilesX, int tilesY) :
+        TestTiler(tileWidth, tileHeight, tilesX, tilesY, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255)) {}
+    bool readTile(int tileIndex, const std::vector<int>& channelIndices, cv::OutputArray tileRaster,
+        void* userData) override {
+        m_reads++;
+        return TestTiler::readTile(tileIndex, channelIndices, tileRaster, userData);
+    }
+    std::atomic<int> m_reads{0};
+};
+
+TEST(TileComposer, composeRects)
+{
+    const int tileWidth(64), tileHeight(48), tilesX(9), tilesY(7);
+    CountingTestTiler tiler(tileWidth, tileHeight, tilesX, tilesY);
+    tiler.m_concurrentReads = true;
+    const std::vector<int> channelIndices = { 2, 0 };
+    // overlapping blocks sharing tiles
+    const std::vector<cv::Rect> blockRects = {
+        { 10, 10, 100, 80 },
+        { 50, 30, 100, 80 },
+        { 300, 200, 100, 80 },
+        { 10, 10, 100, 80 },
+        { 200, 100, 120, 90 }
+    };
+    std::set<int> uniqueTiles;
+    for (const auto& rect : blockRects) {
+        std::vector<int> tiles;
+        tiler.getTilesInRect(rect, tiles, nullptr);
+        uniqueTiles.insert(tiles.begin(), tiles.end());
+    }
+    for (const cv::Size& blockSize : { cv::Size(100, 80), cv::Size(40, 30) }) {
+        std::vector<cv::Mat> blockRasters;
+        tiler.m_reads = 0;
+        slideio::TileComposer::composeRects(&tiler, channelIndices, blockRects, blockSize, blockRasters);
+        EXPECT_EQ(tiler.m_reads, static_cast<int>(uniqueTiles.size()));
+        ASSERT_EQ(blockRasters.size(), blockRects.size());
+        for (size_t block = 0; block < blockRects.size(); ++block) {
+            cv::Mat expected;
+            slideio::TileComposer::composeRect(&tiler, channelIndices, blockRects[block], blockSize, expected);
+            ASSERT_EQ(blockRasters[block].size(), expected.size());
+            ASSERT_EQ(blockRasters[block].type(), expected.type());
+            EXPECT_EQ(cv::norm(blockRasters[block], expected, cv::NORM_INF), 0);
+        }
+    }
+}
+
+class ReducingTestTiler : public TestTiler
+{
+public:
+    ReducingTestTiler(int tileWidth, int tileHeight, int tilesX, int tilesY) :
+        TestTiler(tileWidth, tileHeight, tilesX, tilesY, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255)) {}
+    bool supportsReducedReads(void* userData) override {
+        return true;
+    }
+    bool readReducedTile(int tileIndex, const std::vector<int>& channelIndices, int reduction,
+        cv::OutputArray tileRaster, void* userData) override {
+        m_reduction = reduction;
+        cv::Mat tile;
+        TestTiler::readTile(tileIndex, channelIndices, tile, userData);
+        cv::resize(tile, tileRaster, cv::Size((tile.cols + reduction - 1) / reduction,
+            (tile.rows + reduction - 1) / reduction), 0, 0, cv::INTER_AREA);
+        return true;
+    }
+    std::atomic<int> m_reduction{1};
+};
+
+TEST(TileComposer, composeRectReducedTiles)
+{
+    const int tileWidth(64), tileHeight(48), tilesX(9), tilesY(7);
+    TestTiler fullTiler(tileWidth, tileHeight, tilesX, tilesY, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255));
+    ReducingTestTiler tiler(tileWidth, tileHeight, tilesX, tilesY);
+    const std::vector<int> channelIndices;
+    const cv::Rect blockRect(0, 0, tilesX * tileWidth, tilesY * tileHeight);
+    struct Expectation
+    {
+        cv::Size blockSize;
+        int reduction;
+    };
+    const std::vector<Expectation> expectations = {
+        { blockRect.size(), 1 },
+        { { blockRect.width * 2 / 3, blockRect.height * 2 / 3 }, 1 },
+        { { blockRect.width / 2, blockRect.height / 2 }, 2 },
+        { { blockRect.width / 4, blockRect.height / 4 }, 4 },
+        { { blockRect.width / 16, blockRect.height / 16 }, 8 }
+    };
+    for (const auto& expectation : expectations) {
+        tiler.m_reduction = 1;
+        cv::Mat expected, reduced;
+        slideio::TileComposer::composeRect(&fullTiler, channelIndices, blockRect, expectation.blockSize, expected);
+        slideio::TileComposer::composeRect(&tiler, channelIndices, blockRect, expectation.blockSize, reduced);
+        EXPECT_EQ(tiler.m_reduction, expectation.reduction);
+        ASSERT_EQ(reduced.size(), expected.size());
+        EXPECT_EQ(cv::norm(reduced, expected, cv::NORM_INF), 0);
+    }
+}
+
+class RegionTestTiler : public TestTiler
+{
+public:
+    RegionTestTiler(int tileWidth, int tileHeight, int tilesX, int tilesY) :
+        TestTiler(tileWidth, tileHeight, tilesX, tilesY, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255)) {}
+    bool supportsRegionReads(void* userData) override {
+        return true;
+    }
+    bool readTileRegion(int tileIndex, const std::vector<int>& channelIndices, const cv::Rect& region,
+        int reduction, cv::OutputArray tileRaster, void* userData) override {
+        m_regionReads++;
+        return TestTiler::readTileRegion(tileIndex, channelIndices, region, reduction, tileRaster, userData);
+    }
+    std::atomic<int> m_regionReads{0};
+};
+
+TEST(TileComposer, composeRectTileRegions)
+{
+    const int tileWidth(64), tileHeight(48), tilesX(9), tilesY(7);
+    TestTiler fullTiler(tileWidth, tileHeight, tilesX, tilesY, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255));
+    RegionTestTiler tiler(tileWidth, tileHeight, tilesX, tilesY);
+    const std::vector<int> channelIndices = { 2, 0 };
+    // 3x3 tiles: the border tiles are cut by the block
+    const cv::Rect blockRect(tileWidth + 10, tileHeight + 20, tileWidth * 2, tileHeight * 2);
+    for (const cv::Size& blockSize : { blockRect.size(), cv::Size(blockRect.width / 2, blockRect.height / 2) }) {
+        tiler.m_regionReads = 0;
+        cv::Mat expected, composed;
+        slideio::TileComposer::composeRect(&fullTiler, channelIndices, blockRect, blockSize, expected);
+        slideio::TileComposer::composeRect(&tiler, channelIndices, blockRect, blockSize, composed);
+        EXPECT_EQ(tiler.m_regionReads, 8);
+        ASSERT_EQ(composed.size(), expected.size());
+        ASSERT_EQ(composed.type(), expected.type());
+        if (blockSize == blockRect.size()) {
+            EXPECT_EQ(cv::norm(composed, expected, cv::NORM_INF), 0);
+        }
+        else {
+            // the parts are scaled separately: only the borders of tiles may differ
+            EXPECT_LT(cv::norm(composed, expected, cv::NORM_L1) / composed.total(), 16);
+        }
+    }
+}
@@ -324,6 +324,37 @@ TEST(NDPIImageDriver, readResampledTiled)
     TestTools::compareRasters(testRaster, blockRaster);
 }
 
+TEST(NDPIImageDriver, readBlocksTiled)
+{
+    if (!TestTools::isFullTestEnabled())
+    {
+        GTEST_SKIP() << "Skip private test because full dataset is not enabled";
+    }
+    std::string filePath = TestTools::getFullTestImagePath("hamamatsu", "DM0014 - 2020-04-02 10.25.21.ndpi");
+    slideio::NDPIImageDriver driver;
+    std::shared_ptr<slideio::CVSlide> slide = driver.openFile(filePath);
+    ASSERT_TRUE(slide);
+    std::shared_ptr<slideio::CVScene> scene = slide->getScene(0);
+    ASSERT_TRUE(scene.get() != nullptr);
+    const std::vector<cv::Rect> blockRects = {
+        { 30000, 15000, 512, 512 },
+        { 30256, 15256, 512, 512 },
+        { 10000, 5000, 4096, 4096 },
+        { 0, 0, 69888, 34944 }
+    };
+    const cv::Size blockSize(256, 256);
+    cv::Mat batch;
+    scene->readBlocks(blockRects, blockSize, {}, batch);
+    ASSERT_EQ(batch.dims, 3);
+    EXPECT_EQ(batch.size[0], 4);
+    for (int block = 0; block < static_cast<int>(blockRects.size()); ++block) {
+        cv::Mat expected;
+        scene->readResampledBlock(blockRects[block], blockSize, expected);
+        cv::Mat plane(blockSize, batch.type(), batch.ptr(block));
+        TestTools::compareRasters(plane, expected);
+    }
+}
+
 TEST(NDPIImageDriver, readResampledTiledRoi)
 {
     if (!TestTools::isFullTestEnabled())
@@ -498,3 +529,54 @@ TEST(NDPIImageDriver, zoomLevels)
 
     }
 }
+
+TEST(NDPIImageDriver, levelCache)
+{
+    if (!TestTools::isFullTestEnabled())
+    {
+        GTEST_SKIP() << "Skip private test because full dataset is not enabled";
+    }
+    const std::string filePath = TestTools::getFullTestImagePath("hamamatsu", "openslide/CMU-1.ndpi");
+    slideio::NDPIImageDriver driver;
+    std::shared_ptr<slideio::CVSlide> slide = driver.openFile(filePath);
+    ASSERT_TRUE(slide);
+    std::shared_ptr<slideio::NDPIScene> scene = std::static_pointer_cast<slideio::NDPIScene>(slide->getScene(0));
+    const cv::Rect rect = scene->getRect();
+    // the smallest single stripe level that fits the per-level threshold
+    const slideio::NDPITiffDirectory* dir = nullptr;
+    cv::Size blockSize;
+    for (int levelIndex = scene->getNumZoomLevels() - 1; levelIndex >= 0 && !dir; --levelIndex) {
+        const cv::Size levelSize = scene->getZoomLevelInfo(levelIndex)->getSize();
+        const slideio::NDPITiffDirectory& levelDir = scene->findZoomDirectory(rect, levelSize);
+        if (levelDir.getType() == slideio::NDPITiffDirectory::Type::SingleStripe
+            && static_cast<size_t>(levelDir.width) * levelDir.height * levelDir.channels <= scene->getMaxCachedLevelSize()) {
+            dir = &levelDir;
+            blockSize = levelSize;
+        }
+    }
+    ASSERT_TRUE(dir != nullptr);
+    ASSERT_EQ(dir->getType(), slideio::NDPITiffDirectory::Type::SingleStripe);
+
+    scene->setLevelCacheLimit(0);
+    cv::Mat expectedRaster;
+    scene->readResampledBlock(rect, blockSize, expectedRaster);
+    EXPECT_EQ(scene->getLevelCacheSize(), 0);
+
+    scene->setLevelCacheLimit(256 * 1024 * 1024);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        cv::Mat blockRaster;
+        scene->readResampledBlock(rect, blockSize, blockRaster);
+        TestTools::compareRasters(expectedRaster, blockRaster);
+    }
+    EXPECT_EQ(scene->getLevelCacheSize(), static_cast<size_t>(dir->width) * dir->height * dir->channels);
+    // levels above the per-level threshold are read by the region decoder
+    scene->setLevelCacheLimit(0);
+    scene->setLevelCacheLimit(256 * 1024 * 1024);
+    scene->setMaxCachedLevelSize(static_cast<size_t>(dir->width) * dir->height * dir->channels - 1);
+    cv::Mat blockRaster;
+    scene->readResampledBlock(rect, blockSize, blockRaster);
+    TestTools::compareRasters(expectedRaster, blockRaster);
+    EXPECT_EQ(scene->getLevelCacheSize(), 0);
+    scene->setLevelCacheLimit(0);
+    EXPECT_EQ(scene->getLevelCacheSize(), 0);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "slideio/drivers/ndpi/ndpiindex.hpp"
+#include "slideio/drivers/ndpi/ndpifile.hpp"
+#include "slideio/core/tools/tempfile.hpp"
+#include "slideio/base/exceptions.hpp"
+#include "tests/testlib/testtools.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+static slideio::NDPITiffDirectory makeDirectory(int index)
+{
+    slideio::NDPITiffDirectory dir;
+    dir.dirIndex = index;
+    dir.offset = 1000 * index;
+    dir.width = 11520;
+    dir.height = 9984;
+    dir.tiled = false;
+    dir.tileWidth = 1024;
+    dir.tileHeight = 8;
+    dir.channels = 3;
+    dir.bitsPerSample = 8;
+    dir.photometric = 6;
+    dir.YCbCrSubsampling[0] = 2;
+    dir.YCbCrSubsampling[1] = 1;
+    dir.compression = 7;
+    dir.slideioCompression = slideio::Compression::Jpeg;
+    dir.description = "description";
+    dir.comments = "comments";
+    dir.res = { 0.45e-6, 0.46e-6 };
+    dir.position = { 1.5, -2.5 };
+    dir.interleaved = true;
+    dir.rowsPerStrip = dir.height;
+    dir.dataType = slideio::DataType::DT_Byte;
+    dir.stripSize = 12345;
+    dir.magnification = 20.;
+    dir.blankLines = 0;
+    dir.mcuStarts = { 500, 700, 950 };
+    dir.jpegHeaderOffset = 300;
+    dir.jpegSOFMarker = 320;
+    dir.jpegHeaderSize = 4;
+    dir.jpegHeader = { 0xFF, 0xD8, 0xFF, 0xDA };
+    dir.rawStripSize = 1000;
+    return dir;
+}
+
+static void compareDirectories(const slideio::NDPITiffDirectory& left, const slideio::NDPITiffDirectory& right)
+{
+    EXPECT_EQ(left.dirIndex, right.dirIndex);
+    EXPECT_EQ(left.offset, right.offset);
+    EXPECT_EQ(left.width, right.width);
+    EXPECT_EQ(left.height, right.height);
+    EXPECT_EQ(left.tiled, right.tiled);
+    EXPECT_EQ(left.tileWidth, right.tileWidth);
+    EXPECT_EQ(left.tileHeight, right.tileHeight);
+    EXPECT_EQ(left.channels, right.channels);
+    EXPECT_EQ(left.photometric, right.photometric);
+    EXPECT_EQ(left.YCbCrSubsampling[1], right.YCbCrSubsampling[1]);
+    EXPECT_EQ(left.slideioCompression, right.slideioCompression);
+    EXPECT_EQ(left.description, right.description);
+    EXPECT_EQ(left.userLabel, right.userLabel);
+    EXPECT_EQ(left.comments, right.comments);
+    EXPECT_EQ(left.res.x, right.res.x);
+    EXPECT_EQ(left.position.y, right.position.y);
+    EXPECT_EQ(left.rowsPerStrip, right.rowsPerStrip);
+    EXPECT_EQ(left.dataType, right.dataType);
+    EXPECT_EQ(left.magnification, right.magnification);
+    EXPECT_EQ(left.mcuStarts, right.mcuStarts);
+    EXPECT_EQ(left.jpegHeaderOffset, right.jpegHeaderOffset);
+    EXPECT_EQ(left.jpegSOFMarker, right.jpegSOFMarker);
+    EXPECT_EQ(left.jpegHeader, right.jpegHeader);
+    EXPECT_EQ(left.rawStripSize, right.rawStripSize);
+    EXPECT_EQ(left.auxImage, right.auxImage);
+    ASSERT_EQ(left.subdirectories.size(), right.subdirectories.size());
+    for (size_t index = 0; index < left.subdirectories.size(); ++index) {
+        compareDirectories(left.subdirectories[index], right.subdirectories[index]);
+    }
+}
+
+TEST(NDPIIndex, writeRead)
+{
+    std::vector<slideio::NDPITiffDirectory> directories = { makeDirectory(0), makeDirectory(1) };
+    directories[1].auxImage = true;
+    directories[1].subdirectories.push_back(makeDirectory(2));
+    slideio::TempFile indexFile("slideio-index");
+    const std::string indexPath = indexFile.getPath().string();
+    slideio::NDPIIndex::Key key;
+    key.fileSize = 123456789012;
+    key.modificationTime = 1700000000;
+    slideio::NDPIIndex::write(indexPath, key, directories);
+
+    std::vector<slideio::NDPITiffDirectory> indexDirectories;
+    ASSERT_TRUE(slideio::NDPIIndex::read(indexPath, key, indexDirectories));
+    ASSERT_EQ(indexDirectories.size(), directories.size());
+    for (size_t index = 0; index < directories.size(); ++index) {
+        compareDirectories(indexDirectories[index], directories[index]);
+    }
+    // the slide is changed
+    slideio::NDPIIndex::Key modifiedKey = key;
+    modifiedKey.modificationTime += 1;
+    EXPECT_FALSE(slideio::NDPIIndex::read(indexPath, modifiedKey, indexDirectories));
+}
+
+TEST(NDPIIndex, damagedIndex)
+{
+    std::vector<slideio::NDPITiffDirectory> directories = { makeDirectory(0) };
+    slideio::TempFile indexFile("slideio-index");
+    const std::string indexPath = indexFile.getPath().string();
+    slideio::NDPIIndex::Key key;
+    slideio::NDPIIndex::write(indexPath, key, directories);
+    const auto size = boost::filesystem::file_size(indexPath);
+    boost::filesystem::resize_file(indexPath, size - 10);
+    std::vector<slideio::NDPITiffDirectory> indexDirectories;
+    EXPECT_THROW(slideio::NDPIIndex::read(indexPath, key, indexDirectories), slideio::RuntimeError);
+    // not an index
+    std::ofstream(indexPath, std::ios::binary | std::ios::trunc) << "some text that is not an index";
+    EXPECT_FALSE(slideio::NDPIIndex::read(indexPath, key, indexDirectories));
+}
+
+TEST(NDPIIndex, indexPath)
+{
+    const std::string slidePath = "/slides/slide.ndpi";
+    slideio::NDPIIndex::setCacheDirectory("");
+    EXPECT_EQ(slideio::NDPIIndex::getIndexPath(slidePath), slidePath + ".slideio-index");
+    slideio::NDPIIndex::setCacheDirectory("/cache");
+    const boost::filesystem::path indexPath(slideio::NDPIIndex::getIndexPath(slidePath));
+    EXPECT_EQ(indexPath.parent_path(), boost::filesystem::path("/cache"));
+    EXPECT_NE(indexPath.filename().string().find("slide.ndpi"), std::string::npos);
+    EXPECT_NE(slideio::NDPIIndex::getIndexPath("/other/slide.ndpi"), indexPath.string());
+    slideio::NDPIIndex::setCacheDirectory("");
+}
+
+TEST(NDPIIndex, reopenFile)
+{
+    if (!TestTools::isFullTestEnabled()) {
+        GTEST_SKIP() << "Skip private test because full dataset is not enabled";
+    }
+    std::string filePath = TestTools::getFullTestImagePath("hamamatsu", "openslide/CMU-1.ndpi");
+    slideio::TempFile cacheDirectory;
+    boost::filesystem::create_directories(cacheDirectory.getPath());
+    slideio::NDPIIndex::setCacheDirectory(cacheDirectory.getPath().string());
+    slideio::NDPIIndex::setEnabled(true);
+    std::vector<slideio::NDPITiffDirectory> scannedDirectories;
+    {
+        slideio::NDPIFile file;
+        file.init(filePath);
+        scannedDirectories = file.directories();
+    }
+    const std::string indexPath = slideio::NDPIIndex::getIndexPath(filePath);
+    EXPECT_TRUE(boost::filesystem::exists(indexPath));
+    slideio::NDPIFile file;
+    file.init(filePath);
+    slideio::NDPIIndex::setEnabled(false);
+    slideio::NDPIIndex::setCacheDirectory("");
+    const std::vector<slideio::NDPITiffDirectory>& directories = file.directories();
+    ASSERT_EQ(directories.size(), scannedDirectories.size());
+    for (size_t index = 0; index < directories.size(); ++index) {
+        compareDirectories(directories[index], scannedDirectories[index]);
+    }
+    boost::filesystem::remove_all(cacheDirectory.getPath());
+}
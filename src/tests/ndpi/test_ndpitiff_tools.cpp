@@ -7,6 +7,7 @@
 #include "slideio/core/tools/cachemanager.hpp"
 #include "slideio/drivers/ndpi/ndpifile.hpp"
 #include "slideio/imagetools/imagetools.hpp"
+#include "slideio/imagetools/tiffifdparser.hpp"
 
 
 TEST(NDPITiffTools, scanFile)
@@ -383,10 +384,10 @@ TEST(NDPITiffTools, readMCUTile)
     ndpi.init(filePath);
     size_t dirCount = ndpi.directories().size();
     const slideio::NDPITiffDirectory& dir = ndpi.directories()[0];
+    // the strip header is read once by the file initialization
+    EXPECT_EQ(dir.jpegHeader.size(), dir.jpegHeaderSize);
     cv::Mat tileRaster;
-    std::unique_ptr<FILE, slideio::Tools::FileDeleter> sfile(slideio::Tools::openFile(ndpi.getFilePath(), "rb"));
-    FILE* file = sfile.get();
-    slideio::NDPITiffTools::readMCUTile(file, dir, 87501, tileRaster);
+    slideio::NDPITiffTools::readMCUTile(ndpi.getFile(), dir, 87501, tileRaster);
     EXPECT_EQ(tileRaster.rows, dir.tileHeight);
     EXPECT_EQ(tileRaster.cols, dir.tileWidth);
     EXPECT_EQ(tileRaster.channels(), 3);
@@ -396,6 +397,47 @@ TEST(NDPITiffTools, readMCUTile)
     TestTools::compareRasters(tileRaster, testRaster);
 }
 
+TEST(NDPITiffTools, readMCUTileReduced)
+{
+    if (!TestTools::isFullTestEnabled())
+    {
+        GTEST_SKIP() << "Skip private test because full dataset is not enabled";
+    }
+    std::string filePath = TestTools::getFullTestImagePath("hamamatsu", "openslide/CMU-1.ndpi");
+    slideio::NDPIFile ndpi;
+    ndpi.init(filePath);
+    const slideio::NDPITiffDirectory& dir = ndpi.directories()[0];
+    cv::Mat tileRaster;
+    slideio::NDPITiffTools::readMCUTile(ndpi.getFile(), dir, 87501, tileRaster);
+    for (int reduction : {2, 4, 8}) {
+        cv::Mat reducedRaster;
+        slideio::NDPITiffTools::readMCUTile(ndpi.getFile(), dir, 87501, reducedRaster, reduction);
+        EXPECT_EQ(reducedRaster.cols, (dir.tileWidth + reduction - 1) / reduction);
+        EXPECT_EQ(reducedRaster.rows, (dir.tileHeight + reduction - 1) / reduction);
+        cv::Mat scaledRaster;
+        cv::resize(tileRaster, scaledRaster, reducedRaster.size(), 0, 0, cv::INTER_AREA);
+        EXPECT_GT(slideio::ImageTools::computeSimilarity2(scaledRaster, reducedRaster), 0.95) << reduction;
+    }
+}
+
+
+TEST(NDPITiffTools, scanRestartMarkers)
+{
+    if (!TestTools::isFullTestEnabled())
+    {
+        GTEST_SKIP() << "Skip private test because full dataset is not enabled";
+    }
+    std::string filePath = TestTools::getFullTestImagePath("hamamatsu", "openslide/CMU-1.ndpi");
+    slideio::NDPIFile ndpi;
+    ndpi.init(filePath);
+    const slideio::NDPITiffDirectory& dir = ndpi.directories()[0];
+    ASSERT_FALSE(dir.mcuStarts.empty());
+    // the markers found in the strip are the ones of the restart marker tag
+    std::vector<uint32_t> mcuStarts;
+    ASSERT_TRUE(slideio::NDPITiffTools::scanRestartMarkers(ndpi.getFile(), dir, mcuStarts));
+    EXPECT_EQ(mcuStarts, dir.mcuStarts);
+}
+
 
 TEST(NDPITiffTools, getDirectoryType) {
 
@@ -438,3 +480,68 @@ TEST(NDPITiffTools, getDirectoryType) {
     dir.rowsPerStrip = 0;
     EXPECT_EQ(dir.getType(), slideio::NDPITiffDirectory::Type::Striped);
 }
+
+static void compareNDPIDirectories(const slideio::NDPITiffDirectory& fast, const slideio::NDPITiffDirectory& reference)
+{
+    EXPECT_EQ(fast.dirIndex, reference.dirIndex);
+    EXPECT_EQ(fast.offset, reference.offset);
+    EXPECT_EQ(fast.width, reference.width);
+    EXPECT_EQ(fast.height, reference.height);
+    EXPECT_EQ(fast.tiled, reference.tiled);
+    EXPECT_EQ(fast.tileWidth, reference.tileWidth);
+    EXPECT_EQ(fast.tileHeight, reference.tileHeight);
+    EXPECT_EQ(fast.channels, reference.channels);
+    EXPECT_EQ(fast.bitsPerSample, reference.bitsPerSample);
+    EXPECT_EQ(fast.photometric, reference.photometric);
+    EXPECT_EQ(fast.compression, reference.compression);
+    EXPECT_EQ(fast.slideioCompression, reference.slideioCompression);
+    EXPECT_EQ(fast.description, reference.description);
+    EXPECT_EQ(fast.userLabel, reference.userLabel);
+    EXPECT_EQ(fast.comments, reference.comments);
+    EXPECT_DOUBLE_EQ(fast.res.x, reference.res.x);
+    EXPECT_DOUBLE_EQ(fast.res.y, reference.res.y);
+    EXPECT_DOUBLE_EQ(fast.position.x, reference.position.x);
+    EXPECT_DOUBLE_EQ(fast.position.y, reference.position.y);
+    EXPECT_EQ(fast.interleaved, reference.interleaved);
+    EXPECT_EQ(fast.rowsPerStrip, reference.rowsPerStrip);
+    EXPECT_EQ(fast.dataType, reference.dataType);
+    EXPECT_DOUBLE_EQ(fast.magnification, reference.magnification);
+    EXPECT_EQ(fast.blankLines, reference.blankLines);
+    // restart marker offsets are stored with the high words: wrong offsets break the tiles
+    EXPECT_EQ(fast.mcuStarts, reference.mcuStarts);
+    ASSERT_EQ(fast.subdirectories.size(), reference.subdirectories.size());
+    for (size_t index = 0; index < fast.subdirectories.size(); ++index) {
+        compareNDPIDirectories(fast.subdirectories[index], reference.subdirectories[index]);
+    }
+}
+
+TEST(NDPITiffTools, fastScanMatchesLibtiff)
+{
+    if (!TestTools::isFullTestEnabled())
+    {
+        GTEST_SKIP() << "Skip private test because full dataset is not enabled";
+    }
+    const std::vector<std::string> images = {
+        TestTools::getFullTestImagePath("hamamatsu", "2017-02-27 15.29.08.ndpi"),
+        TestTools::getFullTestImagePath("hamamatsu", "openslide/CMU-1.ndpi"),
+    };
+    for (const auto& filePath : images) {
+        slideio::TiffIFDParser parser(filePath, true);
+        libtiff::TIFF* tiff = slideio::NDPITiffTools::openTiffFile(filePath);
+        ASSERT_TRUE(tiff != nullptr);
+        std::vector<slideio::NDPITiffDirectory> fastDirs(parser.getNumberOfDirectories());
+        for (int dir = 0; dir < parser.getNumberOfDirectories(); ++dir) {
+            slideio::NDPITiffTools::scanTiffDir(parser, tiff, dir, fastDirs[dir]);
+        }
+        std::vector<slideio::NDPITiffDirectory> dirs(fastDirs.size());
+        for (int dir = 0; dir < static_cast<int>(dirs.size()); ++dir) {
+            dirs[dir].dirIndex = dir;
+            slideio::NDPITiffTools::scanTiffDir(tiff, dir, 0, dirs[dir]);
+        }
+        slideio::NDPITiffTools::closeTiffFile(tiff);
+        for (size_t index = 0; index < dirs.size(); ++index) {
+            SCOPED_TRACE(filePath + ", directory " + std::to_string(index));
+            compareNDPIDirectories(fastDirs[index], dirs[index]);
+        }
+    }
+}
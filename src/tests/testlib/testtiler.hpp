@@ -17,6 +17,11 @@ public:
 		void* userData) override;
     void initializeBlock(const cv::Size& blockSize, const std::vector<int>& channelIndices,
         cv::OutputArray output) override;;
+	bool supportsConcurrentReads(void* userData) override { return m_concurrentReads; }
+	bool supportsStridedOutput(void* userData) override { return m_stridedOutput; }
+
+	bool m_concurrentReads = false;
+	bool m_stridedOutput = false;
 
     int m_tileWidth;
 	int m_tileHeight;